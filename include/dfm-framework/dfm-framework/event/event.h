@@ -57,6 +57,45 @@ private:
     QScopedPointer<EventPrivate> d;
 };
 
+/*!
+ * \brief The TypedSignal class publishes a signal event with a fixed argument list,
+ * the event type is resolved once instead of on every publish, and the handlers whose
+ * parameters match Args are called without boxing the arguments into QVariant.
+ */
+template<class... Args>
+class TypedSignal
+{
+    Q_DISABLE_COPY(TypedSignal)
+
+public:
+    TypedSignal(const QString &space, const QString &topic)
+        : space(space), topic(topic)
+    {
+        Q_ASSERT(topic.startsWith(kSignalStrategePrefix));
+    }
+
+    inline bool publish(const Args &... args) const
+    {
+        return Event::instance()->dispatcher()->publish(type(), args...);
+    }
+
+    inline EventType type() const
+    {
+        // the event may be registered after the signal is created, so an invalid type is resolved again
+        EventType ret { eventType.load(std::memory_order_relaxed) };
+        if (ret == EventTypeScope::kInValid) {
+            ret = EventConverter::convert(space, topic);
+            eventType.store(ret, std::memory_order_relaxed);
+        }
+        return ret;
+    }
+
+private:
+    const QString space;
+    const QString topic;
+    mutable std::atomic<EventType> eventType { EventTypeScope::kInValid };
+};
+
 DPF_END_NAMESPACE
 
 // event instance
@@ -14,23 +14,116 @@
 #include <QSharedPointer>
 #include <QReadWriteLock>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
 DPF_BEGIN_NAMESPACE
 
+/*
+ * Invoke a member function with the arguments kept in a std::tuple of their decayed types,
+ * it is usable only if every parameter is taken by value or by const reference.
+ */
+template<class Func>
+struct TypedInvoker
+{
+    static constexpr bool kSupported = false;
+};
+
+template<class Result, class T, class... Args>
+struct TypedInvoker<Result (T::*)(Args...)>
+{
+    using Func = Result (T::*)(Args...);
+    using Tuple = std::tuple<typename std::decay<Args>::type...>;
+    static constexpr bool kSupported = sizeof...(Args) > 0
+            && ((!std::is_reference<Args>::value
+                 || (std::is_lvalue_reference<Args>::value && std::is_const<typename std::remove_reference<Args>::type>::value))
+                && ...);
+
+    static inline bool invoke(T *obj, Func func, void *args)
+    {
+        return call(obj, func, *static_cast<Tuple *>(args), std::index_sequence_for<Args...>());
+    }
+
+private:
+    template<std::size_t... I>
+    static inline bool call(T *obj, Func func, Tuple &args, std::index_sequence<I...>)
+    {
+        if constexpr (std::is_same<Result, bool>::value) {
+            return (obj->*func)(std::get<I>(args)...);
+        } else {
+            (obj->*func)(std::get<I>(args)...);
+            return false;
+        }
+    }
+};
+
 class EventDispatcher
 {
+    Q_DISABLE_COPY(EventDispatcher)
+
 public:
     using Listener = std::function<QVariant(const QVariantList &)>;
-    using HandlerList = QList<EventHandler<Listener>>;
-    using FilterList = QList<EventHandler<Listener>>;
+    // takes the std::tuple of the arguments, returns whether a filter filtered them
+    using TypedListener = std::function<bool(void *)>;
+
+    struct Handler : EventHandler<Listener>
+    {
+        inline Handler(QObject *obj, void *func, Listener method, const std::type_info *types, TypedListener typedMethod)
+            : EventHandler<Listener>(obj, func, method),
+              argTypes(types),
+              typedHandler(typedMethod)
+        {
+        }
+
+        const std::type_info *argTypes;   // the tuple type of typedHandler, null if there is none
+        TypedListener typedHandler;
+    };
+    using HandlerList = QList<Handler>;
+    using FilterList = QList<Handler>;
+
+    EventDispatcher();
+    ~EventDispatcher();
 
     bool dispatch();
     bool dispatch(const QVariantList &params);
     template<class T, class... Args>
-    inline bool dispatch(T param, Args &&... args)
+    [[gnu::hot]] inline bool dispatch(T param, Args &&... args)
     {
-        QVariantList ret;
-        makeVariantList(&ret, param, std::forward<Args>(args)...);
-        return dispatch(ret);
+        // the arguments are boxed into QVariant only for the handlers whose types differ
+        using Tuple = std::tuple<typename std::decay<T>::type, typename std::decay<Args>::type...>;
+        Tuple params(param, std::forward<Args>(args)...);
+        QVariantList variants;
+        auto boxed = [&params, &variants]() -> const QVariantList & {
+            if (variants.isEmpty()) {
+                std::apply([&variants](const auto &... values) {
+                    makeVariantList(&variants, values...);
+                },
+                           params);
+            }
+            return variants;
+        };
+
+        const std::type_info &types = typeid(Tuple);
+        const std::shared_ptr<const FilterList> filters { std::atomic_load(&filterList) };
+        for (const Handler &h : *filters) {
+            if ((h.argTypes && *h.argTypes == types) ? h.typedHandler(&params) : h.handler(boxed()).toBool())
+                return false;
+        }
+
+        const std::shared_ptr<const HandlerList> handlers { std::atomic_load(&handlerList) };
+        for (const Handler &h : *handlers) {
+            if (h.argTypes && *h.argTypes == types)
+                h.typedHandler(&params);
+            else
+                h.handler(boxed());
+        }
+
+        return true;
     }
 
     QFuture<bool> asyncDispatch();
@@ -54,7 +147,9 @@ public:
             return helper.invoke(args);
         };
 
-        handlerList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func });
+        HandlerList list { *std::atomic_load(&handlerList) };
+        list.push_back(makeHandler(obj, method, func));
+        std::atomic_store(&handlerList, std::make_shared<const HandlerList>(std::move(list)));
     }
 
     template<class T, class Func>
@@ -63,17 +158,17 @@ public:
         static_assert(std::is_base_of<QObject, T>::value, "Template type T must be derived QObject");
         static_assert(!std::is_pointer<T>::value, "Receiver::bind's template type T must not be a pointer type");
 
-        bool ret { true };
-        for (auto handler : handlerList) {
-            if (handler.compare(obj, method)) {
-                if (!handlerList.removeOne(handler)) {
-                    qWarning() << "Cannot remove: " << handler.objectIndex->objectName();
-                    ret = false;
-                }
-            }
-        }
+        HandlerList list { *std::atomic_load(&handlerList) };
+        const int count = list.size();
+        list.erase(std::remove_if(list.begin(), list.end(), [obj, method](Handler &handler) {
+                       return handler.compare(obj, method);
+                   }),
+                   list.end());
+        if (list.size() == count)
+            return false;
 
-        return ret;
+        std::atomic_store(&handlerList, std::make_shared<const HandlerList>(std::move(list)));
+        return true;
     }
 
     template<class T, class Func>
@@ -90,7 +185,10 @@ public:
             EventHelper<decltype(method)> helper = (EventHelper<decltype(method)>(obj, method));
             return helper.invoke(args).toBool();
         };
-        filterList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func });
+
+        FilterList list { *std::atomic_load(&filterList) };
+        list.push_back(makeHandler(obj, method, func));
+        std::atomic_store(&filterList, std::make_shared<const FilterList>(std::move(list)));
     }
 
     template<class T, class Func>
@@ -103,22 +201,42 @@ public:
 #elif __cplusplus > 201103L
         static_assert(std::is_same<bool, ReturnType<decltype(method)>>::value, "Template method's ReturnType must is bool");
 #endif
-        bool ret { true };
-        for (auto handler : filterList) {
-            if (handler.compare(obj, method)) {
-                if (!filterList.removeOne(handler)) {
-                    qWarning() << "Cannot remove: " << handler.objectIndex->objectName();
-                    ret = false;
-                }
-            }
-        }
+        FilterList list { *std::atomic_load(&filterList) };
+        const int count = list.size();
+        list.erase(std::remove_if(list.begin(), list.end(), [obj, method](Handler &handler) {
+                       return handler.compare(obj, method);
+                   }),
+                   list.end());
+        if (list.size() == count)
+            return false;
+
+        std::atomic_store(&filterList, std::make_shared<const FilterList>(std::move(list)));
+        return true;
+    }
 
-        return ret;
+private:
+    template<class T, class Func>
+    static inline Handler makeHandler(T *obj, Func method, Listener listener)
+    {
+        using Invoker = TypedInvoker<Func>;
+        if constexpr (Invoker::kSupported) {
+            auto typed = [obj, method](void *args) -> bool {
+                return Invoker::invoke(obj, method, args);
+            };
+            return Handler(obj, memberFunctionVoidCast(method), listener, &typeid(typename Invoker::Tuple), typed);
+        } else {
+            return Handler(obj, memberFunctionVoidCast(method), listener, nullptr, TypedListener());
+        }
     }
 
+    static bool dispatchTo(const FilterList &filters, const HandlerList &handlers, const QVariantList &params);
+
 private:
-    HandlerList handlerList {};
-    FilterList filterList {};
+    // the lists are replaced as a whole under the write lock of EventDispatcherManager,
+    // so that dispatching reads them without a lock. a replaced list is freed when the
+    // last dispatching thread drops it.
+    std::shared_ptr<const HandlerList> handlerList;
+    std::shared_ptr<const FilterList> filterList;
 };
 
 class EventDispatcherManager
@@ -126,6 +244,9 @@ class EventDispatcherManager
 public:
     using GlobalFilter = std::function<bool(EventType type, const QVariantList &)>;
 
+    EventDispatcherManager();
+    ~EventDispatcherManager();
+
     template<class T, class Func>
     inline bool subscribe(const QString &space, const QString &topic, T *obj, Func method)
     {
@@ -146,13 +267,7 @@ public:
         }
 
         QWriteLocker lk(&rwLock);
-        if (dispatcherMap.contains(type)) {
-            dispatcherMap[type]->append(obj, method);
-        } else {
-            DispatcherPtr dispatcher { new EventDispatcher };
-            dispatcher->append(obj, method);
-            dispatcherMap.insert(type, dispatcher);
-        }
+        ensureDispatcher(type)->append(obj, method);
         return true;
     }
 
@@ -170,8 +285,8 @@ public:
             return false;
 
         QWriteLocker lk(&rwLock);
-        if (dispatcherMap.contains(type))
-            return dispatcherMap[type]->remove(obj, std::move(method));
+        if (auto dispatcher = findDispatcher(type))
+            return dispatcher->remove(obj, std::move(method));
 
         return false;
     }
@@ -186,20 +301,15 @@ public:
     template<class T, class... Args>
     [[gnu::hot]] inline bool publish(EventType type, T param, Args &&... args)
     {
-        if (!globalFilterMap.isEmpty()) {
+        if (hasGlobalFilter.load(std::memory_order_acquire)) {
             QVariantList ret;
             makeVariantList(&ret, param, std::forward<Args>(args)...);
             if (globalFiltered(type, ret))
                 return false;
         }
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher = dispatcherMap.value(type);
-            lk.unlock();
-            if (dispatcher)
-                return dispatcher->dispatch(param, std::forward<Args>(args)...);
-        }
+        if (auto dispatcher = findDispatcher(type))
+            return dispatcher->dispatch(param, std::forward<Args>(args)...);
         return false;
     }
 
@@ -211,16 +321,11 @@ public:
 
     inline bool publish(EventType type)
     {
-        if (!globalFilterMap.isEmpty() && globalFiltered(type, QVariantList()))
+        if (hasGlobalFilter.load(std::memory_order_acquire) && globalFiltered(type, QVariantList()))
             return false;
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher = dispatcherMap.value(type);
-            lk.unlock();
-            if (dispatcher)
-                return dispatcher->dispatch();
-        }
+        if (auto dispatcher = findDispatcher(type))
+            return dispatcher->dispatch();
         return false;
     }
 
@@ -234,20 +339,15 @@ public:
     template<class T, class... Args>
     inline QFuture<bool> asyncPublish(EventType type, T param, Args &&... args)
     {
-        if (!globalFilterMap.isEmpty()) {
+        if (hasGlobalFilter.load(std::memory_order_acquire)) {
             QVariantList ret;
             makeVariantList(&ret, param, std::forward<Args>(args)...);
             if (globalFiltered(type, ret))
                 return QFuture<bool>();
         }
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher { dispatcherMap[type] };
-            Q_ASSERT(dispatcher);
-            lk.unlock();
+        if (auto dispatcher = findDispatcher(type))
             return dispatcher->asyncDispatch(param, std::forward<Args>(args)...);
-        }
         return QFuture<bool>();
     }
 
@@ -259,16 +359,11 @@ public:
 
     inline QFuture<bool> asyncPublish(EventType type)
     {
-        if (!globalFilterMap.isEmpty() && globalFiltered(type, QVariantList()))
+        if (hasGlobalFilter.load(std::memory_order_acquire) && globalFiltered(type, QVariantList()))
             return QFuture<bool>();
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher { dispatcherMap[type] };
-            Q_ASSERT(dispatcher);
-            lk.unlock();
+        if (auto dispatcher = findDispatcher(type))
             return dispatcher->asyncDispatch();
-        }
         return QFuture<bool>();
     }
 
@@ -296,13 +391,7 @@ public:
         }
 
         QWriteLocker lk(&rwLock);
-        if (dispatcherMap.contains(type)) {
-            dispatcherMap[type]->appendFilter(obj, method);
-        } else {
-            DispatcherPtr dispatcher { new EventDispatcher };
-            dispatcher->appendFilter(obj, method);
-            dispatcherMap.insert(type, dispatcher);
-        }
+        ensureDispatcher(type)->appendFilter(obj, method);
         return true;
     }
 
@@ -320,8 +409,8 @@ public:
             return false;
 
         QWriteLocker lk(&rwLock);
-        if (dispatcherMap.contains(type))
-            return dispatcherMap[type]->removeFilter(obj, std::move(method));
+        if (auto dispatcher = findDispatcher(type))
+            return dispatcher->removeFilter(obj, std::move(method));
 
         return false;
     }
@@ -331,13 +420,31 @@ protected:
     bool unsubscribe(EventType type);
 
 private:
-    using DispatcherPtr = QSharedPointer<EventDispatcher>;
-    using EventDispatcherMap = QMap<EventType, DispatcherPtr>;
+    using DispatcherPtr = std::shared_ptr<EventDispatcher>;
+    using DispatcherSlot = DispatcherPtr;   // read and written by std::atomic_load and std::atomic_store
     using GlobalEventFilterMap = QMap<QObject *, GlobalFilter>;
 
+    static constexpr int kPageSize { 256 };
+    static constexpr int kPageCount { (EventTypeScope::kCustomTop + 1) / kPageSize };
+
+    // the dispatchers are looked up by the event type in pages that are never
+    // freed, so publishing does not take a lock. a dispatcher removed meanwhile is
+    // freed when the publishing thread drops it.
+    inline DispatcherPtr findDispatcher(EventType type) const
+    {
+        if (Q_UNLIKELY(!isValidEventType(type)))
+            return nullptr;
+
+        const DispatcherSlot *page = pages[type / kPageSize].load(std::memory_order_acquire);
+        return page ? std::atomic_load(&page[type % kPageSize]) : nullptr;
+    }
+    EventDispatcher *ensureDispatcher(EventType type);
+
 private:
-    EventDispatcherMap dispatcherMap;
+    std::atomic<DispatcherSlot *> pages[kPageCount] {};
+    std::vector<std::unique_ptr<DispatcherSlot[]>> pageStorage;
     GlobalEventFilterMap globalFilterMap;
+    std::atomic_bool hasGlobalFilter { false };
     QReadWriteLock rwLock;
 };
 
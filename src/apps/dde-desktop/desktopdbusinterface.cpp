@@ -4,6 +4,8 @@
 
 #include "desktopdbusinterface.h"
 
+#include <dfm-base/base/schemefactory.h>
+
 #include <QDBusInterface>
 #include <QDBusPendingCall>
 
@@ -37,3 +39,8 @@ void DesktopDBusInterface::ShowScreensaverChooser(const QString &screen)
                        "org.deepin.dde.desktop.wallpapersettings");
     ifs.asyncCall("ShowScreensaverChooser", screen);
 }
+
+QVariantMap DesktopDBusInterface::InfoCacheStatistics()
+{
+    return DFMBASE_NAMESPACE::InfoCacheController::instance().statistics();
+}
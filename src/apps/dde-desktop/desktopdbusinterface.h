@@ -9,6 +9,7 @@
 
 #include <QDBusContext>
 #include <QObject>
+#include <QVariantMap>
 
 namespace dde_desktop {
 
@@ -28,6 +29,9 @@ public slots:
     void Refresh(bool silent = true);
     void ShowWallpaperChooser(const QString &screen = "");
     void ShowScreensaverChooser(const QString &screen = "");
+
+    // debug: statistics of the file info cache
+    QVariantMap InfoCacheStatistics();
 };
 
 }
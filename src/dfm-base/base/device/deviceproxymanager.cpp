@@ -5,6 +5,7 @@
 #include "deviceproxymanager.h"
 #include "devicemanager.h"
 #include "deviceutils.h"
+#include "mounttopology.h"
 #include "private/deviceproxymanager_p.h"
 
 #include "dfm-base/dbusservice/dbus_interface/devicemanagerdbus_interface.h"
@@ -348,10 +349,12 @@ void DeviceProxyManagerPrivate::addMounts(const QString &id, const QString &mpt)
         externalMounts.insert(id, p);
     }
     allMounts.insert(id, p);
+    MountTopology::instance()->invalidate();
 }
 
 void DeviceProxyManagerPrivate::removeMounts(const QString &id)
 {
     externalMounts.remove(id);
     allMounts.remove(id);
+    MountTopology::instance()->invalidate();
 }
@@ -11,6 +11,7 @@
 #include "dfm-base/utils/finallyutil.h"
 #include "dfm-base/utils/universalutils.h"
 #include "dfm-base/base/device/deviceproxymanager.h"
+#include "dfm-base/base/device/mounttopology.h"
 #include "dfm-base/dbusservice/global_server_defines.h"
 
 #include <QVector>
@@ -212,14 +213,12 @@ bool DeviceUtils::isWorkingOpticalDiscId(const QString &id)
 
 bool DeviceUtils::isSamba(const QUrl &url)
 {
-    static const QString smbMatch { "(^/run/user/\\d+/gvfs/smb|^/root/\\.gvfs/smb|^/media/[\\s\\S]*/smbmounts)" };   // TODO(xust) /media/$USER/smbmounts might be changed in the future.}
-    return hasMatch(url.path(), smbMatch);
+    return MountTopology::instance()->isSamba(url.path());
 }
 
 bool DeviceUtils::isFtp(const QUrl &url)
 {
-    static const QString smbMatch { "(^/run/user/\\d+/gvfs/s?ftp|^/root/\\.gvfs/s?ftp)" };
-    return hasMatch(url.path(), smbMatch);
+    return MountTopology::instance()->isFtp(url.path());
 }
 
 bool DeviceUtils::isExternalBlock(const QUrl &url)
@@ -435,52 +434,12 @@ QStringList DeviceUtils::encryptedDisks()
 
 bool DeviceUtils::isSubpathOfDlnfs(const QString &path)
 {
-    return findDlnfsPath(path, [](const QString &target, const QString &compare) {
-        return target.startsWith(compare);
-    });
+    return MountTopology::instance()->isSubpathOfDlnfs(path);
 }
 
 bool DeviceUtils::isMountPointOfDlnfs(const QString &path)
 {
-    return findDlnfsPath(path, [](const QString &target, const QString &compare) {
-        return target == compare;
-    });
-}
-
-bool DeviceUtils::findDlnfsPath(const QString &target, Compare func)
-{
-    Q_ASSERT(func);
-    libmnt_table *tab { mnt_new_table() };
-    libmnt_iter *iter = mnt_new_iter(MNT_ITER_BACKWARD);
-
-    FinallyUtil finally([=] {
-        if (tab) mnt_free_table(tab);
-        if (iter) mnt_free_iter(iter);
-    });
-    Q_UNUSED(finally);
-
-    auto unifyPath = [](const QString &path) {
-        return path.endsWith("/") ? path : path + "/";
-    };
-
-    int ret = mnt_table_parse_mtab(tab, nullptr);
-    if (ret != 0) {
-        qWarning() << "device: cannot parse mtab" << ret;
-        return false;
-    }
-
-    libmnt_fs *fs = nullptr;
-    while (mnt_table_next_fs(tab, iter, &fs) == 0) {
-        if (!fs)
-            continue;
-        if (strcmp("dlnfs", mnt_fs_get_source(fs)) == 0) {
-            QString mpt = unifyPath(mnt_fs_get_target(fs));
-            if (func(unifyPath(target), mpt))
-                return true;
-        }
-    }
-
-    return false;
+    return MountTopology::instance()->isMountPointOfDlnfs(path);
 }
 
 bool DeviceUtils::hasMatch(const QString &txt, const QString &rex)
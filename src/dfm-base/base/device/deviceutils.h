@@ -64,8 +64,6 @@ public:
 
 private:
     static bool hasMatch(const QString &txt, const QString &rex);
-    using Compare = std::function<bool(const QString &, const QString &)>;
-    static bool findDlnfsPath(const QString &target, Compare func);
 };
 
 }
@@ -0,0 +1,331 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mounttopology.h"
+
+#include <dfm-io/dfmio_utils.h>
+
+#include <QUrl>
+#include <QDebug>
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+using namespace dfmbase;
+
+static constexpr char kMountInfoPath[] { "/proc/self/mountinfo" };
+// mounts which are not made by DeviceManager are found by polling mountinfo at this interval
+static constexpr qint64 kCheckInterval { 1000 };
+
+namespace {
+
+QString unescape(const QByteArray &field)
+{
+    // the space, tab, newline and backslash are escaped as octal in mountinfo
+    if (!field.contains('\\'))
+        return QString::fromLocal8Bit(field);
+
+    QByteArray ret;
+    ret.reserve(field.size());
+    for (int i = 0; i < field.size(); ++i) {
+        if (field.at(i) == '\\' && i + 3 < field.size()) {
+            bool ok = false;
+            const int ch = field.mid(i + 1, 3).toInt(&ok, 8);
+            if (ok) {
+                ret.append(static_cast<char>(ch));
+                i += 3;
+                continue;
+            }
+        }
+        ret.append(field.at(i));
+    }
+    return QString::fromLocal8Bit(ret);
+}
+
+bool isNetworkFs(const QString &fsType)
+{
+    static const QStringList kNetworkFs { "cifs", "smb3", "smbfs", "nfs", "nfs4", "sshfs", "fuse.sshfs",
+                                          "fuse.curlftpfs", "ceph", "glusterfs", "9p" };
+    return kNetworkFs.contains(fsType);
+}
+
+// TODO(xust) /media/$USER/smbmounts might be changed in the future.
+bool isSmbMountsPath(const QString &path)
+{
+    return path.startsWith("/media/") && path.indexOf("/smbmounts", 7) >= 0;
+}
+
+QStringRef firstComponent(const QStringRef &rest)
+{
+    const int index = rest.indexOf('/');
+    return index < 0 ? rest : rest.left(index);
+}
+
+}   // namespace
+
+MountTopology *MountTopology::instance()
+{
+    static MountTopology ins;
+    return &ins;
+}
+
+MountTopology::Mount MountTopology::mountOf(const QString &path)
+{
+    ensureFresh();
+    QReadLocker locker(&lock);
+    const Match &match = find(path);
+    return match.mount ? *match.mount : Mount();
+}
+
+bool MountTopology::isGvfs(const QString &path)
+{
+    if (isSmbMountsPath(path))
+        return true;
+
+    ensureFresh();
+    QReadLocker locker(&lock);
+    const Match &match = find(path);
+    return match.mount && match.mount->flags.testFlag(kGvfs) && !match.rest.isEmpty();
+}
+
+bool MountTopology::isSamba(const QString &path)
+{
+    if (isSmbMountsPath(path))
+        return true;
+
+    ensureFresh();
+    QReadLocker locker(&lock);
+    const Match &match = find(path);
+    return match.mount && match.mount->flags.testFlag(kGvfs)
+            && firstComponent(match.rest).startsWith("smb");
+}
+
+bool MountTopology::isFtp(const QString &path)
+{
+    ensureFresh();
+    QReadLocker locker(&lock);
+    const Match &match = find(path);
+    if (!match.mount || !match.mount->flags.testFlag(kGvfs))
+        return false;
+
+    const QStringRef &backend = firstComponent(match.rest);
+    return backend.startsWith("ftp") || backend.startsWith("sftp");
+}
+
+bool MountTopology::isMtp(const QString &path)
+{
+    ensureFresh();
+    QReadLocker locker(&lock);
+    const Match &match = find(path);
+    return match.mount && match.mount->flags.testFlag(kGvfs)
+            && firstComponent(match.rest).startsWith("mtp:host");
+}
+
+bool MountTopology::isGphoto(const QString &path)
+{
+    ensureFresh();
+    QReadLocker locker(&lock);
+    const Match &match = find(path);
+    return match.mount && match.mount->flags.testFlag(kGvfs)
+            && firstComponent(match.rest).startsWith("gphoto2:host");
+}
+
+bool MountTopology::isRemovable(const QString &path)
+{
+    ensureFresh();
+    QReadLocker locker(&lock);
+    const Match &match = find(path);
+    return match.mount && match.mount->flags.testFlag(kRemovable);
+}
+
+bool MountTopology::isOptical(const QString &path)
+{
+    ensureFresh();
+    QReadLocker locker(&lock);
+    const Match &match = find(path);
+    return match.mount && match.mount->flags.testFlag(kOptical);
+}
+
+bool MountTopology::isSubpathOfDlnfs(const QString &path)
+{
+    ensureFresh();
+    QReadLocker locker(&lock);
+    return find(path).underDlnfs;
+}
+
+bool MountTopology::isMountPointOfDlnfs(const QString &path)
+{
+    ensureFresh();
+    QReadLocker locker(&lock);
+    return find(path).dlnfsMountPoint;
+}
+
+void MountTopology::invalidate()
+{
+    dirty = true;
+}
+
+MountTopology::MountTopology()
+{
+    mountInfoFd = open(kMountInfoPath, O_RDONLY | O_CLOEXEC);
+    if (mountInfoFd < 0)
+        qWarning() << "mount topology: cannot open" << kMountInfoPath << strerror(errno);
+}
+
+MountTopology::~MountTopology()
+{
+    if (mountInfoFd >= 0)
+        close(mountInfoFd);
+}
+
+void MountTopology::ensureFresh()
+{
+    if (!dirty) {
+        const qint64 now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count();
+        if (now - lastCheckTime.load() < kCheckInterval)
+            return;
+        lastCheckTime = now;
+        if (!mountsChanged())
+            return;
+        dirty = true;
+    }
+
+    QWriteLocker locker(&lock);
+    if (!dirty)
+        return;
+    // cleared before rebuilding, so that a change during the rebuild is not lost
+    dirty = false;
+    rebuild();
+}
+
+bool MountTopology::mountsChanged()
+{
+    if (mountInfoFd < 0)
+        return false;
+
+    // the kernel marks mountinfo with POLLPRI | POLLERR until it is read again after a change
+    struct pollfd fds { mountInfoFd, POLLPRI, 0 };
+    return poll(&fds, 1, 0) > 0 && (fds.revents & (POLLPRI | POLLERR));
+}
+
+void MountTopology::rebuild()
+{
+    rootNode = Node();
+    mounts.clear();
+
+    QByteArray content;
+    if (mountInfoFd >= 0) {
+        char buffer[16384];
+        off_t offset = 0;
+        ssize_t size = 0;
+        while ((size = pread(mountInfoFd, buffer, sizeof(buffer), offset)) > 0) {
+            content.append(buffer, static_cast<int>(size));
+            offset += size;
+        }
+    }
+
+    // 36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+    for (const QByteArray &line : content.split('\n')) {
+        const QList<QByteArray> &fields = line.split(' ');
+        const int separator = fields.indexOf("-", 6);
+        if (fields.size() < 5 || separator < 0 || separator + 2 >= fields.size())
+            continue;
+
+        Mount mount;
+        mount.root = unescape(fields.at(3));
+        mount.mountPoint = unescape(fields.at(4));
+        mount.fsType = QString::fromLatin1(fields.at(separator + 1));
+        mount.source = unescape(fields.at(separator + 2));
+
+        if (mount.fsType == "fuse.gvfsd-fuse")
+            mount.flags |= kGvfs;
+        if (isNetworkFs(mount.fsType))
+            mount.flags |= kNetwork;
+        if (mount.source == "dlnfs")
+            mount.flags |= kDlnfs;
+        if (mount.source.startsWith("/dev/sr"))
+            mount.flags |= kOptical;
+        if (mount.root != "/")
+            mount.flags |= kBind;
+        // resolved once per mount, it used to be resolved for every file
+        if ((mount.source.startsWith("/dev/") || mount.flags.testFlag(kDlnfs))
+            && DFMIO::DFMUtils::fileIsRemovable(QUrl::fromLocalFile(mount.mountPoint)))
+            mount.flags |= kRemovable;
+
+        insert(mount);
+    }
+}
+
+void MountTopology::insert(const Mount &mount)
+{
+    Node *node = &rootNode;
+    for (const QStringRef &name : mount.mountPoint.splitRef('/', QString::SkipEmptyParts)) {
+        auto it = std::lower_bound(node->children.begin(), node->children.end(), name,
+                                   [](const Node &child, const QStringRef &name) {
+                                       return name.compare(child.name) > 0;
+                                   });
+        if (it == node->children.end() || name.compare(it->name) != 0)
+            it = node->children.insert(it, Node { name.toString(), {}, -1, false });
+        node = &*it;
+    }
+
+    // the later one overmounts the former one at the same point
+    mounts.append(mount);
+    node->mount = mounts.size() - 1;
+    node->dlnfs = node->dlnfs || mount.flags.testFlag(kDlnfs);
+}
+
+MountTopology::Match MountTopology::find(const QString &path) const
+{
+    Match match;
+    const Node *node = &rootNode;
+    int restPos = 0;
+    if (node->mount >= 0)
+        match.mount = &mounts.at(node->mount);
+    match.underDlnfs = node->dlnfs;
+
+    int pos = 0;
+    bool consumed = true;
+    while (pos < path.size()) {
+        if (path.at(pos) == '/') {
+            ++pos;
+            continue;
+        }
+
+        int end = path.indexOf('/', pos);
+        if (end < 0)
+            end = path.size();
+        const QStringRef &name = path.midRef(pos, end - pos);
+        auto it = std::lower_bound(node->children.cbegin(), node->children.cend(), name,
+                                   [](const Node &child, const QStringRef &name) {
+                                       return name.compare(child.name) > 0;
+                                   });
+        if (it == node->children.cend() || name.compare(it->name) != 0) {
+            consumed = false;
+            break;
+        }
+
+        node = &*it;
+        pos = end;
+        match.underDlnfs = match.underDlnfs || node->dlnfs;
+        if (node->mount >= 0) {
+            match.mount = &mounts.at(node->mount);
+            restPos = end;
+        }
+    }
+
+    while (restPos < path.size() && path.at(restPos) == '/')
+        ++restPos;
+    match.rest = path.midRef(restPos);
+    match.dlnfsMountPoint = consumed && node->dlnfs;
+    return match;
+}
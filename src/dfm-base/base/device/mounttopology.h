@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MOUNTTOPOLOGY_H
+#define MOUNTTOPOLOGY_H
+
+#include "dfm-base/dfm_base_global.h"
+
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <vector>
+
+namespace dfmbase {
+
+/*!
+ * \brief The MountTopology class indexes /proc/self/mountinfo in a trie keyed by the
+ * components of the mount points, the attributes of a mount are resolved once when it
+ * is parsed, so classifying a path is a walk down the trie instead of a regex or a
+ * device lookup. The index is rebuilt lazily after the mounts changed.
+ */
+class MountTopology
+{
+    Q_DISABLE_COPY(MountTopology)
+
+public:
+    enum MountFlag : quint16 {
+        kNone = 0,
+        kGvfs = 1 << 0,   // the gvfsd-fuse mount, the backends are the dirs under it
+        kNetwork = 1 << 1,
+        kRemovable = 1 << 2,
+        kOptical = 1 << 3,
+        kDlnfs = 1 << 4,
+        kBind = 1 << 5,   // the root of the mount is not the root of its filesystem
+    };
+    Q_DECLARE_FLAGS(MountFlags, MountFlag)
+
+    struct Mount
+    {
+        QString mountPoint;
+        QString root;
+        QString fsType;
+        QString source;
+        MountFlags flags { kNone };
+    };
+
+    static MountTopology *instance();
+
+    Mount mountOf(const QString &path);
+
+    bool isGvfs(const QString &path);
+    bool isSamba(const QString &path);
+    bool isFtp(const QString &path);
+    bool isMtp(const QString &path);
+    bool isGphoto(const QString &path);
+    bool isRemovable(const QString &path);
+    bool isOptical(const QString &path);
+    bool isSubpathOfDlnfs(const QString &path);
+    bool isMountPointOfDlnfs(const QString &path);
+
+    void invalidate();
+
+private:
+    struct Node
+    {
+        QString name;
+        std::vector<Node> children;   // sorted by name
+        int mount { -1 };
+        bool dlnfs { false };   // a dlnfs is mounted here, maybe overmounted
+    };
+
+    struct Match
+    {
+        const Mount *mount { nullptr };
+        QStringRef rest;   // the path under the mount point
+        bool underDlnfs { false };
+        bool dlnfsMountPoint { false };
+    };
+
+    MountTopology();
+    ~MountTopology();
+
+    void ensureFresh();
+    bool mountsChanged();
+    void rebuild();
+    void insert(const Mount &mount);
+    Match find(const QString &path) const;
+
+private:
+    QReadWriteLock lock;
+    Node rootNode;
+    QVector<Mount> mounts;
+    int mountInfoFd { -1 };
+    std::atomic_bool dirty { true };
+    std::atomic<qint64> lastCheckTime { 0 };
+};
+
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(dfmbase::MountTopology::MountFlags)
+
+#endif   // MOUNTTOPOLOGY_H
@@ -14,6 +14,8 @@
 #include <QDebug>
 #include <QStorageInfo>
 #include <QtConcurrent>
+#include <QDateTime>
+#include <QFile>
 
 #include <dfm-mount/dmount.h>
 #include <dfm-burn/dopticaldiscinfo.h>
@@ -47,20 +49,77 @@ void DeviceWatcher::stopPollingUsage()
     disconnect(&d->pollingTimer);
 }
 
+/*!
+ * \brief DeviceWatcherPrivate::queryUsage
+ * start a probe for every mounted device in the thread pools, a block device which is not
+ * written since its last probe is skipped, and a device whose probe timed out is skipped
+ * for more pollings each time. the changes are notified together in flushUsages.
+ */
 void DeviceWatcherPrivate::queryUsage()
 {
-    QtConcurrent::run([this] {
-        queryUsage(DeviceType::kBlockDevice, allBlockInfos);
-        queryUsage(DeviceType::kProtocolDevice, allProtocolInfos);
-    });
+    if (pendingProbes > 0)
+        return;
+
+    const qint64 now { QDateTime::currentMSecsSinceEpoch() };
+    const auto &writes { readSectorsWritten() };
+    queryUsage(DeviceType::kBlockDevice, allBlockInfos, writes, now);
+    queryUsage(DeviceType::kProtocolDevice, allProtocolInfos, {}, now);
+    for (auto iter = probes.begin(); iter != probes.end();) {
+        if (!iter->running && !allBlockInfos.contains(iter.key()) && !allProtocolInfos.contains(iter.key()))
+            iter = probes.erase(iter);
+        else
+            ++iter;
+    }
+
+    if (pendingProbes > 0)
+        probeTimer.start(kProbeTimeout);
+    else
+        flushUsages();
 }
 
-void DeviceWatcherPrivate::queryUsage(DeviceType type, const QHash<QString, QVariantMap> &datas)
+void DeviceWatcherPrivate::queryUsage(DeviceType type, const QHash<QString, QVariantMap> &datas,
+                                      const QHash<QString, quint64> &writes, qint64 now)
 {
-    for (const auto &item : datas) {
-        auto id = item.value(DeviceProperty::kId).toString();
-        auto mpt = item.value(DeviceProperty::kMountPoint).toString();
-        queryUsage(id, mpt, type, true);
+    for (auto iter = datas.cbegin(); iter != datas.cend(); ++iter) {
+        const QString &id { iter.key() };
+        const QVariantMap &info { iter.value() };
+        if (info.value(DeviceProperty::kMountPoint).toString().isEmpty()) {
+            probes.remove(id);
+            continue;
+        }
+
+        UsageProbe &probe { probes[id] };
+        if (probe.running || now < probe.nextTime)
+            continue;
+
+        if (type == DeviceType::kBlockDevice && !info.value(DeviceProperty::kOpticalDrive).toBool()) {
+            // the free space of a local disk only changes when it is written
+            const QString &dev { info.value(DeviceProperty::kDevice).toString().section('/', -1) };
+            auto written = writes.constFind(dev);
+            if (written != writes.cend()) {
+                if (probe.probed && probe.sectorsWritten == written.value())
+                    continue;
+                probe.sectorsWritten = written.value();
+            }
+        }
+
+        probe.running = true;
+        probe.timedOut = false;
+        ++pendingProbes;
+        QtConcurrent::run(type == DeviceType::kProtocolDevice ? &protocolPool : &blockPool, [this, id, info, type] {
+            const Usage &usage { probeUsage(id, info, type) };
+            QMetaObject::invokeMethod(q, [this, usage] { onUsageQueried(usage); }, Qt::QueuedConnection);
+        });
+    }
+
+    if (type == DeviceType::kProtocolDevice) {
+        // a device is not probed again while its probe is running, even a timed out one, so a
+        // thread for each running probe never leaves a probe waiting for a hung one. the block
+        // probes are counted too, the removed devices may still be running
+        int running { 0 };
+        for (const UsageProbe &probe : qAsConst(probes))
+            running += probe.running ? 1 : 0;
+        protocolPool.setMaxThreadCount(qMax(1, running));
     }
 }
 
@@ -69,55 +128,158 @@ void DeviceWatcherPrivate::queryUsage(const QString &id, const QString &mpt, Dev
     if (mpt.isEmpty())
         return;
 
-    using namespace GlobalServerDefines;
-    if (type == DeviceType::kBlockDevice) {
-        if (!allBlockInfos.contains(id))
-            return;
+    QVariantMap info;
+    if (type == DeviceType::kBlockDevice)
+        info = allBlockInfos.value(id);
+    else if (type == DeviceType::kProtocolDevice)
+        info = allProtocolInfos.value(id);
+    if (info.isEmpty())
+        return;
+
+    info[DeviceProperty::kMountPoint] = mpt;
+    updateUsage(probeUsage(id, info, type), notifyIfChanged);
+}
+
+void DeviceWatcherPrivate::onUsageQueried(const Usage &usage)
+{
+    queriedUsages.append(usage);
+
+    auto iter = probes.find(usage.id);
+    if (iter == probes.end() || !iter->running)
+        return;
+
+    iter->running = false;
+    iter->probed = true;
+    if (iter->timedOut) {
+        // it is notified with the next polling
+        qInfo() << "the usage of" << usage.id << "is queried after it timed out";
+        return;
+    }
+
+    iter->failures = 0;
+    if (--pendingProbes == 0) {
+        probeTimer.stop();
+        flushUsages();
+    }
+}
+
+void DeviceWatcherPrivate::onProbesTimeout()
+{
+    const qint64 now { QDateTime::currentMSecsSinceEpoch() };
+    for (auto iter = probes.begin(); iter != probes.end(); ++iter) {
+        if (!iter->running || iter->timedOut)
+            continue;
+
+        iter->timedOut = true;
+        iter->failures = qMin(iter->failures + 1, kMaxBackoff);
+        iter->nextTime = now + kPollingInterval * ((1 << iter->failures) - 1);
+        qWarning() << "query usage timed out:" << iter.key() << "failures:" << iter->failures;
+    }
+
+    pendingProbes = 0;
+    flushUsages();
+}
+
+void DeviceWatcherPrivate::flushUsages()
+{
+    const QList<Usage> usages { std::move(queriedUsages) };
+    queriedUsages.clear();
+    for (const Usage &usage : usages)
+        updateUsage(usage, true);
+}
+
+bool DeviceWatcherPrivate::updateUsage(const Usage &usage, bool notifyIfChanged)
+{
+    if (usage.type == DeviceType::kBlockDevice) {
+        auto iter = allBlockInfos.find(usage.id);
+        if (iter == allBlockInfos.end() || usage.free == iter->value(DeviceProperty::kSizeFree))
+            return false;
+
+        const quint64 total { iter->value(DeviceProperty::kSizeTotal).toULongLong() };
+        {
+            QMutexLocker lk(&blkMtx);
+            (*iter)[DeviceProperty::kSizeFree] = usage.free;
+            (*iter)[DeviceProperty::kSizeUsed] = total - usage.free;
+        }
+        if (notifyIfChanged)
+            emit DevMngIns->devSizeChanged(usage.id, total, usage.free);
+        return true;
+    }
 
-        const auto &info = allBlockInfos.value(id);
-        QVariantMap data { { DeviceProperty::kDevice, info.value(DeviceProperty::kDevice) } };
-        quint64 bytesAvai;
+    if (usage.type == DeviceType::kProtocolDevice) {
+        auto iter = allProtocolInfos.find(usage.id);
+        if (iter == allProtocolInfos.end())
+            return false;
+        if (usage.free == iter->value(DeviceProperty::kSizeFree)
+            && usage.used == iter->value(DeviceProperty::kSizeUsed)
+            && usage.total == iter->value(DeviceProperty::kSizeTotal))
+            return false;
+
+        const quint64 total { iter->value(DeviceProperty::kSizeTotal).toULongLong() };
+        {
+            QMutexLocker lk(&protoMtx);
+            (*iter)[DeviceProperty::kSizeFree] = usage.free;
+            (*iter)[DeviceProperty::kSizeUsed] = usage.used;
+            (*iter)[DeviceProperty::kSizeTotal] = usage.total;
+        }
+        if (notifyIfChanged)
+            emit DevMngIns->devSizeChanged(usage.id, total, usage.free);
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ * \brief DeviceWatcherPrivate::probeUsage
+ * query the usage of a device, it may block for a long time on a hung network mount,
+ * so it only works on the copy of the device info.
+ */
+DeviceWatcherPrivate::Usage DeviceWatcherPrivate::probeUsage(const QString &id, const QVariantMap &info, DeviceType type)
+{
+    Usage usage { id, type };
+    if (type == DeviceType::kBlockDevice) {
+        usage.total = info.value(DeviceProperty::kSizeTotal).toULongLong();
         if (info.value(DeviceProperty::kOpticalDrive).toBool()) {
+            QVariantMap data { { DeviceProperty::kDevice, info.value(DeviceProperty::kDevice) } };
             DeviceHelper::readOpticalInfo(data);
-            bytesAvai = data[DeviceProperty::kSizeTotal].toULongLong() - data[DeviceProperty::kSizeUsed].toULongLong();
+            usage.free = data[DeviceProperty::kSizeTotal].toULongLong() - data[DeviceProperty::kSizeUsed].toULongLong();
         } else {
-            QStorageInfo si(mpt);
-            bytesAvai = si.bytesAvailable();
-        }
-
-        if (bytesAvai != info.value(DeviceProperty::kSizeFree)) {
-            auto &rinfo = allBlockInfos[id];
-            {
-                QMutexLocker lk(&blkMtx);
-                rinfo[DeviceProperty::kSizeFree] = bytesAvai;
-                rinfo[DeviceProperty::kSizeUsed] = rinfo[DeviceProperty::kSizeTotal].toULongLong() - bytesAvai;
-            }
-            if (notifyIfChanged)
-                emit DevMngIns->devSizeChanged(id, info.value(DeviceProperty::kSizeTotal).toULongLong(), bytesAvai);
+            QStorageInfo si(info.value(DeviceProperty::kMountPoint).toString());
+            usage.free = static_cast<quint64>(si.bytesAvailable());
         }
+        usage.used = usage.total - usage.free;
     } else if (type == DeviceType::kProtocolDevice) {
-        if (!allProtocolInfos.contains(id))
-            return;
-
-        const auto &info = allProtocolInfos.value(id);
         auto dev = DeviceHelper::createProtocolDevice(id);
-        quint64 avai = dev->sizeFree();
-        quint64 used = dev->sizeUsage();
-        quint64 total = dev->sizeTotal();
-        if (avai != info.value(DeviceProperty::kSizeFree)
-            || used != info.value(DeviceProperty::kSizeUsed)
-            || total != info.value(DeviceProperty::kSizeTotal)) {
-            auto &rinfo = allProtocolInfos[id];
-            {
-                QMutexLocker lk(&protoMtx);
-                rinfo[DeviceProperty::kSizeFree] = avai;
-                rinfo[DeviceProperty::kSizeUsed] = used;
-                rinfo[DeviceProperty::kSizeTotal] = total;
-            }
-            if (notifyIfChanged)
-                emit DevMngIns->devSizeChanged(id, info.value(DeviceProperty::kSizeTotal).toULongLong(), avai);
+        if (dev) {
+            usage.free = dev->sizeFree();
+            usage.used = dev->sizeUsage();
+            usage.total = dev->sizeTotal();
         }
     }
+    return usage;
+}
+
+/*!
+ * \brief DeviceWatcherPrivate::readSectorsWritten
+ * \return the sectors written of the block devices by their names in /proc/diskstats
+ */
+QHash<QString, quint64> DeviceWatcherPrivate::readSectorsWritten()
+{
+    QHash<QString, quint64> writes;
+    QFile file("/proc/diskstats");
+    if (!file.open(QIODevice::ReadOnly))
+        return writes;
+
+    //   8       1 sda1 1024 0 81920 300 512 0 40960 200 0 400 500 ...
+    // the 10th field is the sectors written
+    for (const QByteArray &line : file.readAll().split('\n')) {
+        const QList<QByteArray> &fields { line.simplified().split(' ') };
+        if (fields.size() < 10)
+            continue;
+        writes.insert(QString::fromLatin1(fields.at(2)), fields.at(9).toULongLong());
+    }
+    return writes;
 }
 
 void DeviceWatcher::initDevDatas()
@@ -428,4 +590,8 @@ QStringList DeviceWatcher::getSiblings(const QString &id)
 DeviceWatcherPrivate::DeviceWatcherPrivate(DeviceWatcher *qq)
     : q(qq)
 {
+    probeTimer.setSingleShot(true);
+    QObject::connect(&probeTimer, &QTimer::timeout, q, [this] { onProbesTimeout(); });
+    blockPool.setMaxThreadCount(4);
+    protocolPool.setMaxThreadCount(1);
 }
@@ -10,6 +10,7 @@
 #include <QTimer>
 #include <QMutex>
 #include <QHash>
+#include <QThreadPool>
 #include <qt5/QtCore/qobjectdefs.h>
 
 #include <dfm-mount/base/dmount_global.h>
@@ -25,15 +26,54 @@ public:
     explicit DeviceWatcherPrivate(DeviceWatcher *qq);
 
 private:
+    struct Usage
+    {
+        QString id;
+        DFMMOUNT::DeviceType type;
+        quint64 total { 0 };
+        quint64 used { 0 };
+        quint64 free { 0 };
+    };
+
+    // the state of polling the usage of a device
+    struct UsageProbe
+    {
+        bool running { false };
+        bool timedOut { false };
+        bool probed { false };
+        int failures { 0 };   // the count of the successive timeouts
+        qint64 nextTime { 0 };   // the device is not probed before it if it timed out
+        quint64 sectorsWritten { 0 };
+    };
+
     void queryUsage();
-    void queryUsage(DFMMOUNT::DeviceType type, const QHash<QString, QVariantMap> &datas);
+    void queryUsage(DFMMOUNT::DeviceType type, const QHash<QString, QVariantMap> &datas,
+                    const QHash<QString, quint64> &writes, qint64 now);
     void queryUsage(const QString &id, const QString &mpt, DFMMOUNT::DeviceType type, bool notifyIfChanged);
+    void onUsageQueried(const Usage &usage);
+    void onProbesTimeout();
+    void flushUsages();
+    bool updateUsage(const Usage &usage, bool notifyIfChanged);
+
+    static Usage probeUsage(const QString &id, const QVariantMap &info, DFMMOUNT::DeviceType type);
+    static QHash<QString, quint64> readSectorsWritten();
 
 private:
     DeviceWatcher *q { nullptr };
 
     QTimer pollingTimer;
     const int kPollingInterval = 10000;
+    // the usages queried in a polling are notified together when all probes finished or timed out
+    QTimer probeTimer;
+    const int kProbeTimeout = 3000;
+    const int kMaxBackoff = 5;   // a timed out device is skipped for up to 2^5 - 1 pollings
+    // the local disks are probed in a pool of their own, and every protocol device has a thread
+    // of its own, so a hung network mount never delays the others
+    QThreadPool blockPool;
+    QThreadPool protocolPool;
+    QHash<QString, UsageProbe> probes;
+    QList<Usage> queriedUsages;
+    int pendingProbes { 0 };
 
     QMutex blkMtx;
     QMutex protoMtx;
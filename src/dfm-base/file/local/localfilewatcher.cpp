@@ -102,6 +102,11 @@ void LocalFileWatcher::notifyFileAdded(const QUrl &url)
     emit subfileCreated(url);
 }
 
+void LocalFileWatcher::notifyFilesAdded(const QList<QUrl> &urls)
+{
+    emit subfilesCreated(urls);
+}
+
 void LocalFileWatcher::notifyFileChanged(const QUrl &url)
 {
     emit fileAttributeChanged(url);
@@ -23,6 +23,7 @@ public:
     ~LocalFileWatcher() override;
 
     virtual void notifyFileAdded(const QUrl &url) override;
+    virtual void notifyFilesAdded(const QList<QUrl> &urls) override;
     virtual void notifyFileChanged(const QUrl &url) override;
     virtual void notifyFileDeleted(const QUrl &url) override;
 
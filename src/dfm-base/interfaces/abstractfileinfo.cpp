@@ -334,6 +334,30 @@ QString dfmbase::AbstractFileInfo::displayOf(const DisPlayInfoType type) const
     }
 }
 
+/*!
+ * \brief 获取显示信息的排序键，文件显示名称的排序键会和显示名称一起缓存，
+ * 排序时比较排序键，不用每次都对两个字符串重新做排序规则的计算
+ * \param DisplayInfoType
+ */
+SortKey dfmbase::AbstractFileInfo::sortKeyOf(const DisplayInfoType type) const
+{
+    CALL_PROXY(sortKeyOf(type));
+    const QString &text = displayOf(type);
+    if (type != DisPlayInfoType::kFileDisplayName)
+        return SortKey(text);
+
+    {
+        QReadLocker lk(&dptr->sortKeyLock);
+        if (dptr->displayNameSortKey.isValid() && dptr->displayNameSortKey.text() == text)
+            return dptr->displayNameSortKey;
+    }
+
+    SortKey key(text);
+    QWriteLocker lk(&dptr->sortKeyLock);
+    dptr->displayNameSortKey = key;
+    return key;
+}
+
 /*!
  * \brief 获取文件url，默认是文件的url，此接口不会实现异步，全部使用Qurl去
  * 处理或者字符串处理，这都比较快
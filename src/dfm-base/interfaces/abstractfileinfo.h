@@ -8,6 +8,7 @@
 #include "dfm-base/base/urlroute.h"
 #include "dfm-base/dfm_base_global.h"
 #include "dfm-base/mimetype/mimedatabase.h"
+#include "dfm-base/utils/sortkey.h"
 
 #include <dfm-io/core/dfileinfo.h>
 
@@ -257,6 +258,7 @@ public:
     virtual QVariant customAttribute(const char *key, const DFMIO::DFileInfo::DFileAttributeType type);
     virtual QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> mediaInfoAttributes(DFMIO::DFileInfo::MediaType type, QList<DFMIO::DFileInfo::AttributeExtendID> ids) const;
     virtual void setExtendedAttributes(const FileExtendedInfoType &key, const QVariant &value);
+    SortKey sortKeyOf(const DisplayInfoType type) const;
 
 protected:
     explicit AbstractFileInfo(const QUrl &url);
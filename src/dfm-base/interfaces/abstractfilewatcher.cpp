@@ -167,6 +167,12 @@ void AbstractFileWatcher::notifyFileAdded(const QUrl &url)
     Q_UNUSED(url);
 }
 
+void AbstractFileWatcher::notifyFilesAdded(const QList<QUrl> &urls)
+{
+    for (const auto &url : urls)
+        notifyFileAdded(url);
+}
+
 void AbstractFileWatcher::notifyFileChanged(const QUrl &url)
 {
     Q_UNUSED(url);
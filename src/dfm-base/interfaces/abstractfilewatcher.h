@@ -42,6 +42,7 @@ public:
     static QStringList getMonitorFiles();
 
     virtual void notifyFileAdded(const QUrl &url);
+    virtual void notifyFilesAdded(const QList<QUrl> &urls);
     virtual void notifyFileChanged(const QUrl &url);
     virtual void notifyFileDeleted(const QUrl &url);
 
@@ -64,6 +65,13 @@ Q_SIGNALS:
      * \param const QUrl &url 当前监视目录下的子文件的url
      */
     void subfileCreated(const QUrl &url);
+    /*!
+     * \brief subfilesCreated 当前监视目录下的一批子文件创建信号，由notifyFilesAdded发送，
+     * 用于无法监视的网络挂载下手动通知的文件，这些文件不再逐个发送subfileCreated
+     *
+     * \param const QList<QUrl> &urls 当前监视目录下的子文件的url
+     */
+    void subfilesCreated(const QList<QUrl> &urls);
     /*!
      * \brief fileRename 当前监视目录文件重命名时发送此信号
      *
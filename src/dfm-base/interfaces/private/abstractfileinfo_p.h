@@ -14,6 +14,7 @@
 #include <dfm-io/core/dfileinfo.h>
 
 #include <QPointer>
+#include <QReadWriteLock>
 
 USING_IO_NAMESPACE
 namespace dfmbase {
@@ -31,6 +32,8 @@ public:
     AbstractFileInfoPointer proxy { nullptr };
     QMap<ExtInfoType, QVariant> extendOtherCache;
     QString pinyinName;
+    SortKey displayNameSortKey;   // 显示名称的排序键，显示名称变化后重新计算
+    QReadWriteLock sortKeyLock;
     QMap<DFMIO::DFileInfo::AttributeID, QVariant> cacheAttributes;
 
 private:
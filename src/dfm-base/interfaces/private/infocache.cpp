@@ -6,6 +6,8 @@
 #include "interfaces/private/infocache_p.h"
 #include "base/schemefactory.h"
 #include "dfm-base/utils/decorator/decoratorfile.h"
+#include "dfm-base/base/device/mounttopology.h"
+#include "dfm-base/base/configs/dconfig/dconfigmanager.h"
 
 #include <dfm-io/core/dfileinfo.h>
 
@@ -13,20 +15,166 @@
 
 // cache file total count
 static constexpr int kCacheFileinfoCount = 20000;
+// cache file total bytes, the cost of one info is estimated by kCacheInfoBaseCost
+static constexpr qint64 kCacheFileinfoBytes = (64 * 1024 * 1024);
+static constexpr qint64 kCacheInfoBaseCost = 2048;
+// the budgets in dconfig, the size is in MB and the scheme budgets are a map of scheme to count
+static constexpr char kCacheCountKey[] { "dfm.infocache.max.count" };
+static constexpr char kCacheSizeKey[] { "dfm.infocache.max.size" };
+static constexpr char kCacheSchemeCountKey[] { "dfm.infocache.scheme.count" };
 // rotation training time
 static constexpr int kRotationTrainingTime = (60 * 1000);
 // remove cache time limit
 static constexpr int kCacheRemoveTime = (60 * (60 * 1000));
 
 namespace dfmbase {
+void CacheShard::pushFront(CacheNode *node)
+{
+    node->prev = nullptr;
+    node->next = head;
+    if (head)
+        head->prev = node;
+    head = node;
+    if (!tail)
+        tail = node;
+}
+
+void CacheShard::unlink(CacheNode *node)
+{
+    if (node->prev)
+        node->prev->next = node->next;
+    else
+        head = node->next;
+
+    if (node->next)
+        node->next->prev = node->prev;
+    else
+        tail = node->prev;
+
+    node->prev = nullptr;
+    node->next = nullptr;
+}
+
+void CacheShard::touch(CacheNode *node)
+{
+    if (head == node)
+        return;
+    unlink(node);
+    pushFront(node);
+}
+
+CacheNode *CacheShard::take(const QUrl &url)
+{
+    CacheNode *node = nodes.take(url);
+    if (!node)
+        return nullptr;
+
+    unlink(node);
+    bytes -= node->cost;
+    if (--schemeCount[node->scheme] <= 0)
+        schemeCount.remove(node->scheme);
+    if (--budgetCount[node->budgetScheme] <= 0)
+        budgetCount.remove(node->budgetScheme);
+    return node;
+}
+
+void CacheShard::clear()
+{
+    qDeleteAll(nodes);
+    nodes.clear();
+    schemeCount.clear();
+    budgetCount.clear();
+    head = nullptr;
+    tail = nullptr;
+    bytes = 0;
+}
+
 InfoCachePrivate::InfoCachePrivate(InfoCache *qq)
-    : q(qq)
+    : q(qq), maxEntries(kCacheFileinfoCount), maxBytes(kCacheFileinfoBytes)
 {
+    clock.start();
 }
 
 InfoCachePrivate::~InfoCachePrivate()
 {
     cacheWorkerStoped = true;
+    for (auto &shard : shards) {
+        QMutexLocker lk(&shard.lock);
+        shard.clear();
+    }
+}
+
+CacheShard &InfoCachePrivate::shard(const QUrl &url)
+{
+    return shards[qHash(url) % kCacheShardCount];
+}
+
+/*!
+ * \brief budgetScheme 计算预算使用的协议，缓存的都是本地路径，gvfs挂载下的按其后端协议，
+ * 如 /run/user/1000/gvfs/smb-share:server=host,share=dir 为smb-share，cifs等网络挂载为其文件系统类型
+ */
+QString InfoCachePrivate::budgetScheme(const QUrl &url)
+{
+    if (!url.isLocalFile())
+        return url.scheme();
+
+    const QString &path = url.path();
+    const MountTopology::Mount &mount = MountTopology::instance()->mountOf(path);
+    if (mount.flags.testFlag(MountTopology::kGvfs)) {
+        const QString &backend = path.mid(mount.mountPoint.length()).section('/', 1, 1);
+        if (!backend.isEmpty())
+            return backend.section(':', 0, 0);
+    } else if (mount.flags.testFlag(MountTopology::kNetwork)) {
+        return mount.fsType == "cifs" ? QStringLiteral("smb") : mount.fsType;
+    }
+
+    return url.scheme();
+}
+
+int InfoCachePrivate::schemeBudget(const QString &scheme)
+{
+    QReadLocker lk(&schemeBudgetLock);
+    return schemeBudgets.value(scheme, -1);
+}
+
+/*!
+ * \brief evict 移除分片中最久未使用的节点，直到满足分片的数量、大小和scheme的预算，调用时需要持有分片的锁
+ */
+void InfoCachePrivate::evict(CacheShard &shard, const QString &scheme, QMap<QUrl, AbstractFileInfoPointer> *evicted)
+{
+    const int shardEntries = qMax(1, maxEntries.load() / kCacheShardCount);
+    const qint64 shardBytes = qMax(kCacheInfoBaseCost, maxBytes.load() / kCacheShardCount);
+    while (shard.tail && shard.tail != shard.head
+           && (shard.nodes.size() > shardEntries || shard.bytes > shardBytes)) {
+        removeNode(shard, shard.tail, evicted);
+        evictionCount.ref();
+    }
+
+    const int budget = schemeBudget(scheme);
+    if (budget < 0)
+        return;
+
+    const int shardSchemeEntries = qMax(1, budget / kCacheShardCount);
+    CacheNode *node = shard.tail;
+    while (node && node != shard.head && shard.budgetCount.value(scheme) > shardSchemeEntries) {
+        CacheNode *prev = node->prev;
+        if (node->budgetScheme == scheme) {
+            removeNode(shard, node, evicted);
+            evictionCount.ref();
+        }
+        node = prev;
+    }
+}
+
+void InfoCachePrivate::removeNode(CacheShard &shard, CacheNode *node, QMap<QUrl, AbstractFileInfoPointer> *removed)
+{
+    CacheNode *taken = shard.take(node->url);
+    if (!taken)
+        return;
+
+    if (removed && taken->info)
+        removed->insert(taken->url, taken->info);
+    delete taken;
 }
 
 InfoCache::InfoCache(QObject *parent)
@@ -105,6 +253,7 @@ void InfoCache::setCacheDisbale(const QString &scheme, bool disable)
 {
     if (!d->disableCahceSchemes.contains(scheme) && disable) {
         d->disableCahceSchemes.push_backByLock(scheme);
+        removeSchemeCaches(scheme);
         return;
     }
     if (d->disableCahceSchemes.contains(scheme) && !disable) {
@@ -112,6 +261,74 @@ void InfoCache::setCacheDisbale(const QString &scheme, bool disable)
         return;
     }
 }
+/*!
+ * \brief setCacheBudget 设置缓存的最大数量和最大内存，超出后移除最久未使用的fileinfo
+ *
+ * \param int 最大的缓存数量
+ *
+ * \param qint64 最大的缓存内存（估算值）
+ *
+ * \return
+ */
+void InfoCache::setCacheBudget(const int maxEntries, const qint64 maxBytes)
+{
+    Q_D(InfoCache);
+    if (maxEntries > 0)
+        d->maxEntries.store(maxEntries);
+    if (maxBytes > 0)
+        d->maxBytes.store(maxBytes);
+}
+/*!
+ * \brief setSchemeBudget 设置scheme的最大缓存数量，小于0表示不单独限制，
+ * 被setCacheDisbale禁用的scheme不会缓存。gvfs和网络挂载下的文件按其后端协议计算，见budgetScheme
+ *
+ * \param QString 文件的scheme，或gvfs的后端协议如smb-share、mtp，或网络挂载的文件系统类型
+ *
+ * \param int 最大的缓存数量
+ *
+ * \return
+ */
+void InfoCache::setSchemeBudget(const QString &scheme, const int maxEntries)
+{
+    Q_D(InfoCache);
+    QWriteLocker lk(&d->schemeBudgetLock);
+    if (maxEntries < 0)
+        d->schemeBudgets.remove(scheme);
+    else
+        d->schemeBudgets.insert(scheme, maxEntries);
+}
+/*!
+ * \brief statistics 缓存的统计数据，用于调试
+ *
+ * \return 命中、未命中、淘汰、超时移除的次数和当前的缓存数量、内存
+ */
+QVariantMap InfoCache::statistics()
+{
+    Q_D(InfoCache);
+    qint64 entries = 0;
+    qint64 bytes = 0;
+    QVariantMap schemes;
+    for (auto &shard : d->shards) {
+        QMutexLocker lk(&shard.lock);
+        entries += shard.nodes.size();
+        bytes += shard.bytes;
+        for (auto it = shard.budgetCount.cbegin(); it != shard.budgetCount.cend(); ++it)
+            schemes.insert(it.key(), schemes.value(it.key()).toInt() + it.value());
+    }
+
+    QVariantMap map;
+    map.insert("hit", d->hitCount.load());
+    map.insert("miss", d->missCount.load());
+    map.insert("eviction", d->evictionCount.load());
+    map.insert("expired", d->expiredCount.load());
+    map.insert("entries", entries);
+    map.insert("bytes", bytes);
+    map.insert("maxEntries", d->maxEntries.load());
+    map.insert("maxBytes", d->maxBytes.load());
+    map.insert("shards", kCacheShardCount);
+    map.insert("schemes", schemes);
+    return map;
+}
 /*!
  * \brief cacheInfo 缓存fileinfo
  *
@@ -124,10 +341,38 @@ void InfoCache::setCacheDisbale(const QString &scheme, bool disable)
 void InfoCache::cacheInfo(const QUrl url, const AbstractFileInfoPointer info)
 {
     Q_D(InfoCache);
-    if (!info || d->cacheWorkerStoped)
+    if (!info || d->cacheWorkerStoped || cacheDisable(url.scheme()))
         return;
 
-    if (!info->hasProxy()) {
+    bool isNew = false;
+    QMap<QUrl, AbstractFileInfoPointer> evicted;
+    {
+        CacheShard &shard = d->shard(url);
+        QMutexLocker lk(&shard.lock);
+        CacheNode *node = shard.nodes.value(url);
+        if (node) {
+            node->info = info;
+            node->lastAccess = d->clock.elapsed();
+            shard.touch(node);
+        } else {
+            isNew = true;
+            node = new CacheNode;
+            node->url = url;
+            node->scheme = url.scheme();
+            node->budgetScheme = d->budgetScheme(url);
+            node->info = info;
+            node->cost = kCacheInfoBaseCost + url.path().size() * static_cast<qint64>(sizeof(QChar));
+            node->lastAccess = d->clock.elapsed();
+            shard.nodes.insert(url, node);
+            shard.schemeCount[node->scheme]++;
+            shard.budgetCount[node->budgetScheme]++;
+            shard.bytes += node->cost;
+            shard.pushFront(node);
+            d->evict(shard, node->budgetScheme, &evicted);
+        }
+    }
+
+    if (isNew && !info->hasProxy()) {
         //获取监视器，监听当前的file的改变
         QSharedPointer<AbstractFileWatcher> watcher { nullptr };
         watcher = WatcherFactory::create<AbstractFileWatcher>(UrlRoute::urlParent(url));
@@ -143,40 +388,9 @@ void InfoCache::cacheInfo(const QUrl url, const AbstractFileInfoPointer info)
         }
     }
 
-    // 插入到主和副的所有缓存中
-    d->status = kCacheCopy;
-    {
-        QWriteLocker wlk(&d->mianLock);
-        d->mainCache.insert(url, info);
-    }
-    d->status = kCacheMain;
-    {
-        QWriteLocker wlk(&d->copyLock);
-        d->copyCache.insert(url, info);
-    }
-    // 使用线程处理加入时间序列问题
-    emit cacheUpdateInfoTime(url);
-}
-/*!
- * \brief insertSortTime 处理当前文件的移除时间
- *
- * \param qint64 文件info的当前时间
- *
- * \param QString 文件的url
- *
- * \return
- */
-void InfoCache::updateSortTimeWorker(const QUrl url)
-{
-    Q_D(InfoCache);
-    if (d->cacheWorkerStoped)
-        return;
-    auto time = QDateTime::currentMSecsSinceEpoch();
-    auto key = QString::number(time) + QString("-") + url.toString();
-    if (d->urlTimeSortMap.contains(url))
-        d->timeToUrlMap.remove(d->urlTimeSortMap.value(url));
-    d->timeToUrlMap.insert(key, url);
-    d->urlTimeSortMap.insert(url, key);
+    // 断开被淘汰的fileinfo的监视器
+    if (!evicted.isEmpty())
+        emit cacheDisconnectWatcher(evicted);
 }
 
 void InfoCache::stop()
@@ -189,8 +403,6 @@ void InfoCache::stop()
  *
  * \param QStringList key需要移除的缓存的key
  *
- * \param std::atomic_bool isStop判断当前是否是退出当前处理
- *
  * \return
  */
 void InfoCache::removeCaches(const QList<QUrl> urls)
@@ -199,33 +411,45 @@ void InfoCache::removeCaches(const QList<QUrl> urls)
     if (d->cacheWorkerStoped || urls.size() <= 0)
         return;
 
-    // 读取主缓存，插入到
-    d->status = kCacheCopy;
     QMap<QUrl, AbstractFileInfoPointer> infos;
-    {
-        QWriteLocker wlk(&d->mianLock);
-        for (const auto &url : urls) {
-            auto info = d->mainCache.take(url);
-            if (info)
-                infos.insert(url, d->mainCache.take(url));
-        }
+    for (const auto &url : urls) {
+        CacheShard &shard = d->shard(url);
+        QMutexLocker lk(&shard.lock);
+        CacheNode *node = shard.nodes.value(url);
+        if (node)
+            d->removeNode(shard, node, &infos);
     }
     if (d->cacheWorkerStoped)
         return;
     // 断开监视器监视
     if (infos.size() > 0)
         emit cacheDisconnectWatcher(infos);
-    // 移除时间队列
-    emit cacheRemoveInfosTime(urls);
-
-    // 设置读取主缓存和插入到主缓存中
-    d->status = kCacheMain;
-    {
-        QWriteLocker wlk(&d->copyLock);
-        for (const auto &url : urls) {
-            d->copyCache.remove(url);
+}
+/*!
+ * \brief removeSchemeCaches 移除scheme的所有缓存
+ *
+ * \param QString 文件的scheme
+ *
+ * \return
+ */
+void InfoCache::removeSchemeCaches(const QString &scheme)
+{
+    Q_D(InfoCache);
+    QMap<QUrl, AbstractFileInfoPointer> infos;
+    for (auto &shard : d->shards) {
+        QMutexLocker lk(&shard.lock);
+        if (!shard.schemeCount.contains(scheme))
+            continue;
+        CacheNode *node = shard.head;
+        while (node) {
+            CacheNode *next = node->next;
+            if (node->scheme == scheme)
+                d->removeNode(shard, node, &infos);
+            node = next;
         }
     }
+    if (infos.size() > 0 && !d->cacheWorkerStoped)
+        emit cacheDisconnectWatcher(infos);
 }
 /*!
  * \brief getCacheInfo 获取文件
@@ -237,22 +461,19 @@ void InfoCache::removeCaches(const QList<QUrl> urls)
 AbstractFileInfoPointer InfoCache::getCacheInfo(const QUrl &url)
 {
     Q_D(InfoCache);
-    // 要异步线程重置计时器 todo 开辟一个可控制的线程来处理时间排序的问题
-    // 读取副缓存和临时缓存返回
-    AbstractFileInfoPointer info(nullptr);
-    if (d->status == kCacheMain) {   // 可以读取主缓存返回
-        QReadLocker wlk(&d->mianLock);
-        info = d->mainCache.value(url);
-    } else {
-        QReadLocker wlk(&d->copyLock);
-        info = d->copyCache.value(url);
+    CacheShard &shard = d->shard(url);
+    QMutexLocker lk(&shard.lock);
+    CacheNode *node = shard.nodes.value(url);
+    if (!node) {
+        d->missCount.ref();
+        return nullptr;
     }
-    // 异步线程或者信号更新时间
-    // 使用线程处理加入时间序列问题
-    if (info)
-        emit cacheUpdateInfoTime(url);
 
-    return info;
+    // 访问时移动到LRU链表头，不再通过信号到线程中更新时间
+    d->hitCount.ref();
+    node->lastAccess = d->clock.elapsed();
+    shard.touch(node);
+    return node->info;
 }
 /*!
  * \brief refreshFileInfo 刷新缓存fileinfo
@@ -268,43 +489,31 @@ void InfoCache::refreshFileInfo(const QUrl &url)
         info->refresh();
 }
 /*!
- * \brief timeRemoveCache 定时检查哪些fileinfo要移除
+ * \brief timeRemoveCache 定时检查哪些fileinfo要移除，从每个分片的LRU链表尾部移除超时未访问的fileinfo
  *
  * \return
  */
 void InfoCache::timeRemoveCache()
 {
     Q_D(InfoCache);
-    // 取出哪些url的时间超出了u
-    qint64 delCount = d->urlTimeSortMap.size() < kCacheFileinfoCount ? 0 : d->urlTimeSortMap.size() - kCacheFileinfoCount;
-    QList<QUrl> delList;
-    foreach (const auto time, d->timeToUrlMap.uniqueKeys()) {
+    const qint64 expiredTime = d->clock.elapsed() - kCacheRemoveTime;
+    if (expiredTime <= 0)
+        return;
+
+    QMap<QUrl, AbstractFileInfoPointer> infos;
+    for (auto &shard : d->shards) {
         if (d->cacheWorkerStoped)
             return;
 
-        if (time < QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch() - kCacheRemoveTime)) {
-            delList.append(d->timeToUrlMap.values(time));
-            continue;
+        QMutexLocker lk(&shard.lock);
+        while (shard.tail && shard.tail->lastAccess < expiredTime) {
+            d->removeNode(shard, shard.tail, &infos);
+            d->expiredCount.ref();
         }
-
-        if (delList.size() >= delCount) {
-            break;
-        }
-
-        delList.append(d->timeToUrlMap.values(time));
     }
-    // 发送异步消息 告诉移除线程创建移除线程移除，考虑是否是使用线程一直还是使用临时线程（使用临时线程）
-    if (delList.size() > 0 && !d->cacheWorkerStoped)
-        emit cacheRemoveCaches(delList);
-}
 
-void InfoCache::removeInfosTimeWorker(const QList<QUrl> urls)
-{
-    for (auto url : urls) {
-        if (d->urlTimeSortMap.contains(url)) {
-            d->timeToUrlMap.remove(d->urlTimeSortMap.take(url));
-        }
-    }
+    if (infos.size() > 0 && !d->cacheWorkerStoped)
+        emit cacheDisconnectWatcher(infos);
 }
 
 void InfoCache::fileAttributeChanged(const QUrl url)
@@ -334,24 +543,12 @@ void CacheWorker::removeCaches(const QList<QUrl> urls)
     InfoCache::instance().removeCaches(urls);
 }
 
-void CacheWorker::updateInfoTime(const QUrl url)
-{
-    Q_ASSERT(qApp->thread() != QThread::currentThread());
-    InfoCache::instance().updateSortTimeWorker(url);
-}
-
 void CacheWorker::dealRemoveInfo()
 {
     Q_ASSERT(qApp->thread() != QThread::currentThread());
     InfoCache::instance().timeRemoveCache();
 }
 
-void CacheWorker::removeInfosTime(const QList<QUrl> urls)
-{
-    Q_ASSERT(qApp->thread() != QThread::currentThread());
-    InfoCache::instance().removeInfosTimeWorker(urls);
-}
-
 void CacheWorker::disconnectWatcher(const QMap<QUrl, AbstractFileInfoPointer> infos)
 {
     Q_ASSERT(qApp->thread() != QThread::currentThread());
@@ -382,6 +579,21 @@ void InfoCacheController::setCacheDisbale(const QString &scheme, bool disable)
     return InfoCache::instance().setCacheDisbale(scheme, disable);
 }
 
+void InfoCacheController::setCacheBudget(const int maxEntries, const qint64 maxBytes)
+{
+    InfoCache::instance().setCacheBudget(maxEntries, maxBytes);
+}
+
+void InfoCacheController::setSchemeBudget(const QString &scheme, const int maxEntries)
+{
+    InfoCache::instance().setSchemeBudget(scheme, maxEntries);
+}
+
+QVariantMap InfoCacheController::statistics()
+{
+    return InfoCache::instance().statistics();
+}
+
 AbstractFileInfoPointer InfoCacheController::getCacheInfo(const QUrl &url)
 {
     return InfoCache::instance().getCacheInfo(url);
@@ -393,15 +605,35 @@ InfoCacheController::InfoCacheController(QObject *parent)
     init();
 }
 
+/*!
+ * \brief loadBudget 从dconfig读取缓存的总预算和scheme的预算，网络和gvfs挂载下的文件信息
+ * 很少重复访问，按其后端协议单独限制数量，避免挤掉本地文件的缓存
+ */
+void InfoCacheController::loadBudget()
+{
+    const int maxEntries = DConfigManager::instance()->value(kDefaultCfgPath, kCacheCountKey, kCacheFileinfoCount).toInt();
+    const qint64 maxBytes = DConfigManager::instance()->value(kDefaultCfgPath, kCacheSizeKey, kCacheFileinfoBytes / (1024 * 1024)).toLongLong();
+    setCacheBudget(maxEntries, maxBytes * 1024 * 1024);
+
+    const QVariantMap &schemes = DConfigManager::instance()->value(kDefaultCfgPath, kCacheSchemeCountKey).toMap();
+    for (auto it = schemes.cbegin(); it != schemes.cend(); ++it) {
+        bool ok = false;
+        const int count = it.value().toInt(&ok);
+        if (ok)
+            setSchemeBudget(it.key(), count);
+    }
+}
+
 void InfoCacheController::init()
 {
     removeTimer->moveToThread(qApp->thread());
     connect(removeTimer.data(), &QTimer::timeout, worker.data(), &CacheWorker::dealRemoveInfo, Qt::QueuedConnection);
     connect(this, &InfoCacheController::cacheFileInfo, worker.data(), &CacheWorker::cacheInfo, Qt::QueuedConnection);
     connect(&InfoCache::instance(), &InfoCache::cacheRemoveCaches, worker.data(), &CacheWorker::removeCaches, Qt::QueuedConnection);
-    connect(&InfoCache::instance(), &InfoCache::cacheRemoveInfosTime, worker.data(), &CacheWorker::removeInfosTime, Qt::QueuedConnection);
     connect(&InfoCache::instance(), &InfoCache::cacheDisconnectWatcher, worker.data(), &CacheWorker::disconnectWatcher, Qt::QueuedConnection);
 
+    loadBudget();
+
     worker->moveToThread(thread.data());
     thread->start();
     removeTimer->setInterval(kRotationTrainingTime);
@@ -30,9 +30,7 @@ public:
 public Q_SLOTS:
     void cacheInfo(const QUrl url, const AbstractFileInfoPointer info);
     void removeCaches(const QList<QUrl> urls);
-    void updateInfoTime(const QUrl url);
     void dealRemoveInfo();
-    void removeInfosTime(const QList<QUrl> urls);
     void disconnectWatcher(const QMap<QUrl, AbstractFileInfoPointer> infos);
 
 private:
@@ -55,22 +53,22 @@ public:
 Q_SIGNALS:
     void cacheRemoveCaches(const QList<QUrl> &key);
     void cacheDisconnectWatcher(const QMap<QUrl, AbstractFileInfoPointer> infos);
-    void cacheUpdateInfoTime(const QUrl url);
-    void cacheRemoveInfosTime(const QList<QUrl> urls);
 
 private:
     explicit InfoCache(QObject *parent = nullptr);
     static InfoCache &instance();
     bool cacheDisable(const QString &scheme);
     void setCacheDisbale(const QString &scheme, bool disable = true);
+    void setCacheBudget(const int maxEntries, const qint64 maxBytes);
+    void setSchemeBudget(const QString &scheme, const int maxEntries);
+    QVariantMap statistics();
     AbstractFileInfoPointer getCacheInfo(const QUrl &url);
     void stop();
     void cacheInfo(const QUrl url, const AbstractFileInfoPointer info);
     void disconnectWatcher(const QMap<QUrl, AbstractFileInfoPointer> infos);
     void removeCaches(const QList<QUrl> urls);
-    void updateSortTimeWorker(const QUrl url);
+    void removeSchemeCaches(const QString &scheme);
     void timeRemoveCache();
-    void removeInfosTimeWorker(const QList<QUrl> urls);
 
 private Q_SLOTS:
     void fileAttributeChanged(const QUrl url);
@@ -90,6 +88,9 @@ public:
     static InfoCacheController &instance();
     bool cacheDisable(const QString &scheme);
     void setCacheDisbale(const QString &scheme, bool disable = true);
+    void setCacheBudget(const int maxEntries, const qint64 maxBytes);
+    void setSchemeBudget(const QString &scheme, const int maxEntries);
+    QVariantMap statistics();
     AbstractFileInfoPointer getCacheInfo(const QUrl &url);
 Q_SIGNALS:
     void cacheFileInfo(const QUrl url, const AbstractFileInfoPointer info);
@@ -97,6 +98,7 @@ Q_SIGNALS:
 private:
     explicit InfoCacheController(QObject *parent = nullptr);
     void init();
+    void loadBudget();
 };
 }
 
@@ -11,12 +11,43 @@
 #include <QMutex>
 #include <QTimer>
 #include <QMap>
+#include <QElapsedTimer>
 
 namespace dfmbase {
-enum CacheInfoStatus : uint8_t {
-    kCacheMain = 0,   // 1.正常状态 插入(同时插入主和副缓存hash)， 读取主缓存hash， 删除主缓存hash
-    kCacheCopy,
+// 缓存分片的数量，按url的hash分配到各个分片，每个分片一把锁
+inline constexpr int kCacheShardCount { 16 };
+
+// 缓存节点，同时挂在分片的hash和LRU双向链表上
+struct CacheNode
+{
+    QUrl url;
+    QString scheme;
+    QString budgetScheme;   // 预算按文件实际所在的协议计算，gvfs和网络挂载下的本地路径按其后端协议
+    AbstractFileInfoPointer info { nullptr };
+    qint64 cost { 0 };
+    qint64 lastAccess { 0 };
+    CacheNode *prev { nullptr };
+    CacheNode *next { nullptr };
 };
+
+// 缓存分片，链表头是最近使用的节点，链表尾是最久未使用的节点
+struct CacheShard
+{
+    QMutex lock;
+    QHash<QUrl, CacheNode *> nodes;
+    QHash<QString, int> schemeCount;
+    QHash<QString, int> budgetCount;
+    CacheNode *head { nullptr };
+    CacheNode *tail { nullptr };
+    qint64 bytes { 0 };
+
+    void pushFront(CacheNode *node);
+    void unlink(CacheNode *node);
+    void touch(CacheNode *node);
+    CacheNode *take(const QUrl &url);
+    void clear();
+};
+
 class InfoCachePrivate
 {
     friend class InfoCache;
@@ -24,21 +55,32 @@ class InfoCachePrivate
     InfoCache *const q;
     DThreadList<QString> disableCahceSchemes;
 
-    QAtomicInt status { kCacheMain };   // 当前状态缓存的状态
-    QHash<QUrl, AbstractFileInfoPointer> mainCache;   // 主信息缓存
-    QHash<QUrl, AbstractFileInfoPointer> copyCache;   // 副信息缓存
-    QReadWriteLock mianLock;
-    QReadWriteLock copyLock;
+    CacheShard shards[kCacheShardCount];
+    QElapsedTimer clock;   // 节点访问时间的时钟，用于超时移除
 
-    // 时间排序url,利用map的有序性，来处理时间到了要移除的url
-    QMap<QUrl, QString> urlTimeSortMap;
-    QMap<QString, QUrl> timeToUrlMap;
+    // 缓存预算，总的预算平均分到每个分片
+    QAtomicInt maxEntries;
+    QAtomicInteger<qint64> maxBytes;
+    QHash<QString, int> schemeBudgets;   // scheme的最大缓存数量
+    QReadWriteLock schemeBudgetLock;
+
+    // 统计计数
+    QAtomicInteger<quint64> hitCount { 0 };
+    QAtomicInteger<quint64> missCount { 0 };
+    QAtomicInteger<quint64> evictionCount { 0 };
+    QAtomicInteger<quint64> expiredCount { 0 };
 
     std::atomic_bool cacheWorkerStoped { false };
 
 public:
     explicit InfoCachePrivate(InfoCache *qq);
     virtual ~InfoCachePrivate();
+
+    CacheShard &shard(const QUrl &url);
+    static QString budgetScheme(const QUrl &url);
+    int schemeBudget(const QString &scheme);
+    void evict(CacheShard &shard, const QString &scheme, QMap<QUrl, AbstractFileInfoPointer> *evicted);
+    void removeNode(CacheShard &shard, CacheNode *node, QMap<QUrl, AbstractFileInfoPointer> *removed);
 };
 }
 
@@ -0,0 +1,361 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dirlistingcache.h"
+#include "dfm-base/base/standardpaths.h"
+#include "dfm-base/base/configs/dconfig/dconfigmanager.h"
+#include "dfm-base/file/local/localfileinfo.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+#include <QVector>
+#include <QStorageInfo>
+#include <QDebug>
+
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+using namespace dfmbase;
+
+namespace {
+inline constexpr char kSnapshotEnableKey[] { "dfm.dirsnapshot.enable" };
+inline constexpr char kSnapshotDisabledFsKey[] { "dfm.dirsnapshot.disabled.fstypes" };
+
+static constexpr quint32 kSnapshotMagic { 0x50534644 };   // "DFSP"
+static constexpr quint32 kSnapshotVersion { 1 };
+// smaller directories are enumerated fast enough without a snapshot
+static constexpr int kSnapshotMinCount { 200 };
+// size limit of all the snapshot files, the least recently used are removed first
+static constexpr qint64 kSnapshotMaxBytes { 64 * 1024 * 1024 };
+
+// file layout: SnapshotHeader | SnapshotEntry[count] | dir path | names, all in host byte order
+struct SnapshotHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint64 dev;
+    quint64 inode;
+    qint64 mtimeSec;
+    qint64 mtimeNsec;
+    qint64 ctimeSec;
+    qint64 ctimeNsec;
+    quint32 filters;
+    quint32 pathSize;
+    quint32 count;
+    quint32 namesSize;
+};
+
+struct SnapshotEntry
+{
+    qint64 size;
+    qint64 mtime;
+    quint32 nameOffset;
+    quint32 nameSize;
+    quint32 mode;
+    quint8 type;
+    quint8 reserved[3];
+};
+
+QString localDirPath(const QUrl &dirUrl)
+{
+    QString path = dirUrl.path();
+    while (path.size() > 1 && path.endsWith('/'))
+        path.chop(1);
+    return path;
+}
+
+bool parseSnapshot(const uchar *data, qint64 size, const QString &dirPath, const QDir::Filters filters,
+                   const DirListingCache::DirStamp &stamp, QList<DirListingCache::Entry> *entries)
+{
+    SnapshotHeader header;
+    if (size < static_cast<qint64>(sizeof(header)))
+        return false;
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != kSnapshotMagic || header.version != kSnapshotVersion)
+        return false;
+
+    if (header.dev != stamp.dev || header.inode != stamp.inode
+        || header.mtimeSec != stamp.mtimeSec || header.mtimeNsec != stamp.mtimeNsec
+        || header.ctimeSec != stamp.ctimeSec || header.ctimeNsec != stamp.ctimeNsec
+        || header.filters != static_cast<quint32>(filters))
+        return false;
+
+    const qint64 entriesSize = static_cast<qint64>(header.count) * static_cast<qint64>(sizeof(SnapshotEntry));
+    if (static_cast<qint64>(sizeof(header)) + entriesSize + header.pathSize + header.namesSize != size)
+        return false;
+
+    const uchar *entryData = data + sizeof(header);
+    const char *pathData = reinterpret_cast<const char *>(entryData + entriesSize);
+    const char *names = pathData + header.pathSize;
+    if (QString::fromUtf8(pathData, static_cast<int>(header.pathSize)) != dirPath)
+        return false;
+
+    entries->reserve(static_cast<int>(header.count));
+    for (quint32 i = 0; i < header.count; ++i) {
+        SnapshotEntry item;
+        memcpy(&item, entryData + i * sizeof(SnapshotEntry), sizeof(item));
+        if (static_cast<quint64>(item.nameOffset) + item.nameSize > header.namesSize)
+            return false;
+
+        DirListingCache::Entry entry;
+        entry.name = QString::fromUtf8(names + item.nameOffset, static_cast<int>(item.nameSize));
+        entry.type = item.type;
+        entry.mode = item.mode;
+        entry.size = item.size;
+        entry.mtime = item.mtime;
+        entries->append(entry);
+    }
+
+    return true;
+}
+
+qint64 modifiedTime(const AbstractFileInfoPointer &info)
+{
+    return info->timeOf(TimeInfoType::kLastModified).value<QDateTime>().toMSecsSinceEpoch();
+}
+
+quint8 entryType(const AbstractFileInfoPointer &info)
+{
+    if (info->isAttributes(OptInfoType::kIsSymLink))
+        return DT_LNK;
+    if (info->isAttributes(OptInfoType::kIsDir))
+        return DT_DIR;
+    return DT_REG;
+}
+}
+
+DirListingCache::DirListingCache()
+{
+}
+
+DirListingCache *DirListingCache::instance()
+{
+    static DirListingCache ins;
+    return &ins;
+}
+
+/*!
+ * \brief isEnabled the snapshot is used only for local directories, and can be
+ * turned off entirely or for some file system types by dconfig
+ */
+bool DirListingCache::isEnabled(const QUrl &dirUrl) const
+{
+    if (!dirUrl.isLocalFile())
+        return false;
+
+    if (!DConfigManager::instance()->value(kDefaultCfgPath, kSnapshotEnableKey, true).toBool())
+        return false;
+
+    const QStringList &disabledTypes = DConfigManager::instance()->value(kDefaultCfgPath, kSnapshotDisabledFsKey).toStringList();
+    if (disabledTypes.isEmpty())
+        return true;
+
+    const QString &fsType = QString::fromLatin1(QStorageInfo(localDirPath(dirUrl)).fileSystemType());
+    return !disabledTypes.contains(fsType);
+}
+
+bool DirListingCache::dirStamp(const QString &dirPath, DirListingCache::DirStamp *stamp)
+{
+    struct stat st;
+    if (!stamp || ::stat(dirPath.toLocal8Bit().constData(), &st) != 0 || !S_ISDIR(st.st_mode))
+        return false;
+
+    stamp->dev = static_cast<quint64>(st.st_dev);
+    stamp->inode = static_cast<quint64>(st.st_ino);
+    stamp->mtimeSec = st.st_mtim.tv_sec;
+    stamp->mtimeNsec = st.st_mtim.tv_nsec;
+    stamp->ctimeSec = st.st_ctim.tv_sec;
+    stamp->ctimeNsec = st.st_ctim.tv_nsec;
+    return true;
+}
+
+/*!
+ * \brief load the snapshot of dirUrl, it is empty if there is no snapshot or the
+ * directory has been changed since it was written. The caller checks isEnabled.
+ */
+QList<DirListingCache::Entry> DirListingCache::load(const QUrl &dirUrl, const QDir::Filters filters)
+{
+    const QString &dirPath = localDirPath(dirUrl);
+    DirStamp stamp;
+    if (!dirStamp(dirPath, &stamp))
+        return {};
+
+    const QString &path = snapshotPath(dirPath);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    const qint64 size = file.size();
+    uchar *data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data)
+        return {};
+
+    QList<Entry> entries;
+    const bool valid = parseSnapshot(data, size, dirPath, filters, stamp, &entries);
+    file.unmap(data);
+    file.close();
+
+    if (!valid) {
+        QFile::remove(path);
+        return {};
+    }
+
+    // the mtime of snapshot file is the last used time for eviction
+    ::utimensat(AT_FDCWD, path.toLocal8Bit().constData(), nullptr, 0);
+    return entries;
+}
+
+/*!
+ * \brief loadChildren the infos of the snapshot children, the attributes kept in the
+ * snapshot are cached in them, so they can be shown and sorted without querying the file
+ */
+QList<AbstractFileInfoPointer> DirListingCache::loadChildren(const QUrl &dirUrl, const QDir::Filters filters)
+{
+    const QList<Entry> &entries = load(dirUrl, filters);
+    if (entries.isEmpty())
+        return {};
+
+    QString dirPath = localDirPath(dirUrl);
+    if (!dirPath.endsWith('/'))
+        dirPath.append('/');
+
+    QList<AbstractFileInfoPointer> infos;
+    infos.reserve(entries.count());
+    for (const auto &entry : entries) {
+        const QString &filePath = dirPath + entry.name;
+        const QFile::Permissions permissions(entry.mode);
+        AbstractFileInfoPointer info(new LocalFileInfo(QUrl::fromLocalFile(filePath)));
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardName, entry.name);
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardDisplayName, entry.name);
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardFilePath, filePath);
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardParentPath, localDirPath(dirUrl));
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardIsHidden, entry.name.startsWith('.'));
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardIsSymlink, entry.type == DT_LNK);
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardIsDir, entry.type == DT_DIR);
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardIsFile, entry.type == DT_REG);
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardSize, entry.size);
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kTimeModified, entry.mtime / 1000);
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kTimeModifiedUsec, entry.mtime % 1000 * 1000);
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kAccessCanRead, permissions.testFlag(QFile::ReadUser));
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kAccessCanWrite, permissions.testFlag(QFile::WriteUser));
+        info->cacheAttribute(DFMIO::DFileInfo::AttributeID::kAccessCanExecute, permissions.testFlag(QFile::ExeUser));
+        infos.append(info);
+    }
+    return infos;
+}
+
+// whether the attributes kept in the snapshot are unchanged
+bool DirListingCache::isSameEntry(const AbstractFileInfoPointer &cached, const AbstractFileInfoPointer &info)
+{
+    return cached->size() == info->size() && modifiedTime(cached) == modifiedTime(info)
+            && entryType(cached) == entryType(info);
+}
+
+/*!
+ * \brief save the children enumerated from dirUrl, stamp must be taken before the
+ * enumeration, so the snapshot is invalid if the directory is changed meanwhile.
+ */
+void DirListingCache::save(const QUrl &dirUrl, const QDir::Filters filters, const DirStamp &stamp,
+                           const QList<AbstractFileInfoPointer> &children)
+{
+    const QString &dirPath = localDirPath(dirUrl);
+    if (children.count() < kSnapshotMinCount) {
+        remove(dirUrl);
+        return;
+    }
+
+    QByteArray names;
+    QVector<SnapshotEntry> entries;
+    entries.reserve(children.count());
+    for (const auto &info : children) {
+        if (!info)
+            continue;
+
+        const QByteArray &name = info->nameOf(NameInfoType::kFileName).toUtf8();
+        SnapshotEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.nameOffset = static_cast<quint32>(names.size());
+        entry.nameSize = static_cast<quint32>(name.size());
+        entry.type = entryType(info);
+        entry.mode = static_cast<quint32>(info->permissions());
+        entry.size = info->size();
+        entry.mtime = modifiedTime(info);
+        names.append(name);
+        entries.append(entry);
+    }
+
+    const QByteArray &pathData = dirPath.toUtf8();
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.dev = stamp.dev;
+    header.inode = stamp.inode;
+    header.mtimeSec = stamp.mtimeSec;
+    header.mtimeNsec = stamp.mtimeNsec;
+    header.ctimeSec = stamp.ctimeSec;
+    header.ctimeNsec = stamp.ctimeNsec;
+    header.filters = static_cast<quint32>(filters);
+    header.pathSize = static_cast<quint32>(pathData.size());
+    header.count = static_cast<quint32>(entries.size());
+    header.namesSize = static_cast<quint32>(names.size());
+
+    QMutexLocker lk(&mutex);
+    if (!QDir().mkpath(cacheDir()))
+        return;
+
+    QSaveFile file(snapshotPath(dirPath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "open dir snapshot failed: " << file.fileName() << file.errorString();
+        return;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.constData()), entries.size() * static_cast<int>(sizeof(SnapshotEntry)));
+    file.write(pathData);
+    file.write(names);
+    if (!file.commit()) {
+        qWarning() << "write dir snapshot failed: " << file.fileName() << file.errorString();
+        return;
+    }
+
+    evict();
+}
+
+void DirListingCache::remove(const QUrl &dirUrl)
+{
+    const QString &path = snapshotPath(localDirPath(dirUrl));
+    if (QFile::exists(path))
+        QFile::remove(path);
+}
+
+QString DirListingCache::cacheDir() const
+{
+    return StandardPaths::location(StandardPaths::kCachePath) + "/dirsnapshot";
+}
+
+QString DirListingCache::snapshotPath(const QString &dirPath) const
+{
+    const QByteArray &hash = QCryptographicHash::hash(dirPath.toUtf8(), QCryptographicHash::Md5).toHex();
+    return cacheDir() + "/" + QString::fromLatin1(hash) + ".snapshot";
+}
+
+// called with mutex locked
+void DirListingCache::evict()
+{
+    // sorted by the last used time, the most recent first
+    const QFileInfoList &files = QDir(cacheDir()).entryInfoList(QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const auto &file : files) {
+        total += file.size();
+        if (total > kSnapshotMaxBytes)
+            QFile::remove(file.absoluteFilePath());
+    }
+}
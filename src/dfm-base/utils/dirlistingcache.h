@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DIRLISTINGCACHE_H
+#define DIRLISTINGCACHE_H
+
+#include "dfm-base/dfm_base_global.h"
+#include "dfm-base/interfaces/abstractfileinfo.h"
+
+#include <QDir>
+#include <QMutex>
+#include <QUrl>
+
+namespace dfmbase {
+
+/*!
+ * \brief The DirListingCache class keeps a persistent snapshot of large local directories
+ * under the user cache dir, so that reopening them can show the children at once while
+ * the real enumeration runs. A snapshot is used only if the inode, mtime and ctime of
+ * the directory are unchanged since it was written.
+ */
+class DirListingCache
+{
+    Q_DISABLE_COPY(DirListingCache)
+
+public:
+    struct DirStamp
+    {
+        quint64 dev { 0 };
+        quint64 inode { 0 };
+        qint64 mtimeSec { 0 };
+        qint64 mtimeNsec { 0 };
+        qint64 ctimeSec { 0 };
+        qint64 ctimeNsec { 0 };
+    };
+
+    struct Entry
+    {
+        QString name;
+        quint8 type { 0 };   // DT_* of dirent
+        quint32 mode { 0 };
+        qint64 size { 0 };
+        qint64 mtime { 0 };
+    };
+
+    static DirListingCache *instance();
+
+    bool isEnabled(const QUrl &dirUrl) const;
+    static bool dirStamp(const QString &dirPath, DirStamp *stamp);
+
+    QList<Entry> load(const QUrl &dirUrl, const QDir::Filters filters);
+    QList<AbstractFileInfoPointer> loadChildren(const QUrl &dirUrl, const QDir::Filters filters);
+    static bool isSameEntry(const AbstractFileInfoPointer &cached, const AbstractFileInfoPointer &info);
+    void save(const QUrl &dirUrl, const QDir::Filters filters, const DirStamp &stamp,
+              const QList<AbstractFileInfoPointer> &children);
+    void remove(const QUrl &dirUrl);
+
+private:
+    DirListingCache();
+    QString cacheDir() const;
+    QString snapshotPath(const QString &dirPath) const;
+    void evict();
+
+private:
+    QMutex mutex;
+};
+
+}
+
+#endif   // DIRLISTINGCACHE_H
@@ -6,10 +6,15 @@
 
 #include <QGuiApplication>
 #include <QTimer>
+#include <QtConcurrent>
 
 DFMBASE_USE_NAMESPACE
+
+// the statistics of a lane are logged each time it finishes this count of requests
+static constexpr quint64 kStatisticsInterval { 1000 };
+
 FileInfoHelper::FileInfoHelper(QObject *parent)
-    : QObject(parent), thread(new QThread), worker(new FileInfoAsycWorker)
+    : QObject(parent), worker(new FileInfoAsycWorker)
 {
     init();
 }
@@ -18,22 +23,26 @@ void FileInfoHelper::init()
 {
     // connect quit app to stop
     connect(qApp, &QGuiApplication::aboutToQuit, this, &FileInfoHelper::aboutToQuit);
-    // connect thumb
 
-    // connect file info async worker
-    connect(this, &FileInfoHelper::fileCount, worker.data(), &FileInfoAsycWorker::fileConutAsync, Qt::QueuedConnection);
+    // the worker is called on the threads of the pool, its signals are queued to the main thread
     connect(worker.data(), &FileInfoAsycWorker::fileConutAsyncFinish, this, &FileInfoHelper::fileCountFinished, Qt::QueuedConnection);
-    connect(this, &FileInfoHelper::fileMimeType, worker.data(), &FileInfoAsycWorker::fileMimeType, Qt::QueuedConnection);
-    connect(this, &FileInfoHelper::fileInfoRefresh, worker.data(), &FileInfoAsycWorker::fileRefresh, Qt::QueuedConnection);
     connect(worker.data(), &FileInfoAsycWorker::fileMimeTypeFinished, this, &FileInfoHelper::fileMimeTypeFinished, Qt::QueuedConnection);
-    connect(this, &FileInfoHelper::fileThumb, worker.data(), &FileInfoAsycWorker::fileThumb, Qt::QueuedConnection);
     connect(worker.data(), &FileInfoAsycWorker::createThumbnailFinished,
             this, &FileInfoHelper::createThumbnailFinished, Qt::QueuedConnection);
     connect(worker.data(), &FileInfoAsycWorker::createThumbnailFailed,
             this, &FileInfoHelper::createThumbnailFailed, Qt::QueuedConnection);
 
-    worker->moveToThread(thread.data());
-    thread->start();
+    // the mime database and the thumbnail provider keep caches which are not thread safe,
+    // so only the child counts run concurrently in their lane
+    lanes[kCountLane].limit = 2;
+    lanes[kMimeTypeLane].limit = 1;
+    lanes[kThumbLane].limit = 1;
+    lanes[kRefreshLane].limit = 1;
+
+    int threads = 0;
+    for (const Lane &lane : lanes)
+        threads += lane.limit;
+    pool.setMaxThreadCount(threads);
 }
 
 QSharedPointer<FileInfoHelperUeserData> FileInfoHelper::fileCountAsync(QUrl &url)
@@ -41,7 +50,9 @@ QSharedPointer<FileInfoHelperUeserData> FileInfoHelper::fileCountAsync(QUrl &url
     if (stoped)
         return nullptr;
     QSharedPointer<FileInfoHelperUeserData> data(new FileInfoHelperUeserData);
-    emit fileCount(url, data);
+    post(kCountLane, url.toString(), data, [this, url](const QSharedPointer<FileInfoHelperUeserData> &data) {
+        worker->fileConutAsync(url, data);
+    });
     return data;
 }
 
@@ -50,7 +61,10 @@ QSharedPointer<FileInfoHelperUeserData> FileInfoHelper::fileMimeTypeAsync(const
     if (stoped)
         return nullptr;
     QSharedPointer<FileInfoHelperUeserData> data(new FileInfoHelperUeserData);
-    emit fileMimeType(url, mode, inod, isGvfs, data);
+    const QString &key { QString::number(mode) + url.toString() };
+    post(kMimeTypeLane, key, data, [this, url, mode, inod, isGvfs](const QSharedPointer<FileInfoHelperUeserData> &data) {
+        worker->fileMimeType(url, mode, inod, isGvfs, data);
+    });
     return data;
 }
 
@@ -61,10 +75,18 @@ QSharedPointer<FileInfoHelperUeserData> FileInfoHelper::fileThumbAsync(const QUr
     static constexpr uint16_t kRequestThumbnailDealy { 500 };
     QSharedPointer<FileInfoHelperUeserData> data(new FileInfoHelperUeserData);
     QUrl thumbUrl(url);
-    QTimer::singleShot(kRequestThumbnailDealy, [thumbUrl, size, data]() {
-        if (FileInfoHelper::instance().stoped)
+    QWeakPointer<FileInfoHelperUeserData> owner(data);
+    QTimer::singleShot(kRequestThumbnailDealy, [thumbUrl, size, owner]() {
+        FileInfoHelper &helper { FileInfoHelper::instance() };
+        const auto &data { owner.toStrongRef() };
+        // the owner is gone during the delay
+        if (helper.stoped || !data)
             return;
-        emit FileInfoHelper::instance().fileThumb(thumbUrl, size, data);
+
+        const QString &key { QString::number(size) + thumbUrl.toString() };
+        helper.post(kThumbLane, key, data, [&helper, thumbUrl, size](const QSharedPointer<FileInfoHelperUeserData> &data) {
+            helper.worker->fileThumb(thumbUrl, size, data);
+        });
     });
 
     return data;
@@ -75,7 +97,11 @@ void FileInfoHelper::fileRefreshAsync(const QUrl &url, const QSharedPointer<dfmi
     if (stoped)
         return;
 
-    emit fileInfoRefresh(url, dfileInfo);
+    // only the refreshes of the same DFileInfo are merged, the others own their own state
+    const QString &key { QString::number(reinterpret_cast<quintptr>(dfileInfo.data()), 16) + url.toString() };
+    post(kRefreshLane, key, nullptr, [this, url, dfileInfo](const QSharedPointer<FileInfoHelperUeserData> &) {
+        worker->fileRefresh(url, dfileInfo);
+    });
 }
 
 FileInfoHelper::~FileInfoHelper()
@@ -89,10 +115,127 @@ FileInfoHelper &FileInfoHelper::instance()
     return helper;
 }
 
+/*!
+ * \brief FileInfoHelper::post queue a request to its lane
+ * \param key a request with the key of a queued one shares its result instead of running again, a running
+ * one may have read the file already, so it is not shared
+ * \param owner the request is dropped if all its owners are released, it always runs if it is null
+ */
+void FileInfoHelper::post(RequestLane laneIndex, const QString &key, const QSharedPointer<FileInfoHelperUeserData> &owner, Work work)
+{
+    Lane &lane { lanes[laneIndex] };
+    {
+        QMutexLocker locker(&lane.mutex);
+        auto iter = lane.inFlight.find(key);
+        if (iter != lane.inFlight.end()) {
+            ++lane.shared;
+            if (owner)
+                iter.value()->owners.append(owner);
+            return;
+        }
+
+        RequestPointer request(new Request);
+        request->key = key;
+        request->owned = !owner.isNull();
+        if (owner)
+            request->owners.append(owner);
+        request->work = std::move(work);
+        request->timer.start();
+        lane.inFlight.insert(key, request);
+        lane.queue.append(request);
+        lane.maxDepth = qMax(lane.maxDepth, lane.queue.size());
+    }
+
+    schedule(laneIndex);
+}
+
+void FileInfoHelper::schedule(RequestLane laneIndex)
+{
+    Lane &lane { lanes[laneIndex] };
+    QMutexLocker locker(&lane.mutex);
+    while (lane.running < lane.limit && !lane.queue.isEmpty()) {
+        // the newest one first, it belongs to the rows in view
+        RequestPointer request { lane.queue.takeLast() };
+        // the later requests of the key run again
+        lane.inFlight.remove(request->key);
+        ++lane.running;
+        QtConcurrent::run(&pool, [this, laneIndex, request] { run(laneIndex, request); });
+    }
+}
+
+void FileInfoHelper::run(RequestLane laneIndex, const RequestPointer &request)
+{
+    Lane &lane { lanes[laneIndex] };
+    QSharedPointer<FileInfoHelperUeserData> owner;
+    bool canceled { stoped };
+    {
+        QMutexLocker locker(&lane.mutex);
+        for (const auto &weak : request->owners) {
+            owner = weak.toStrongRef();
+            if (owner)
+                break;
+        }
+        canceled = canceled || (request->owned && !owner);
+        lane.waitTime += request->timer.restart();
+        if (canceled) {
+            // nobody waits for it any more
+            ++lane.canceled;
+        }
+    }
+
+    if (!canceled)
+        request->work(owner);
+
+    bool logging { false };
+    {
+        QMutexLocker locker(&lane.mutex);
+        if (!canceled) {
+            lane.runTime += request->timer.elapsed();
+            logging = (++lane.finished % kStatisticsInterval) == 0;
+
+            // the others who shared the request while it was queued
+            for (const auto &weak : request->owners) {
+                const auto &other { weak.toStrongRef() };
+                if (!other || other == owner || !owner)
+                    continue;
+                other->data = owner->data;
+                other->finish = owner->finish.load();
+            }
+        }
+        --lane.running;
+    }
+
+    if (logging)
+        logStatistics(laneIndex);
+    if (!stoped)
+        schedule(laneIndex);
+}
+
+void FileInfoHelper::logStatistics(RequestLane laneIndex)
+{
+    static constexpr const char *kLaneNames[kLaneCount] { "count", "mimetype", "thumbnail", "refresh" };
+    Lane &lane { lanes[laneIndex] };
+    QMutexLocker locker(&lane.mutex);
+    qInfo() << "file info lane" << kLaneNames[laneIndex]
+            << "finished:" << lane.finished << "canceled:" << lane.canceled << "shared:" << lane.shared
+            << "depth:" << lane.queue.size() << "max depth:" << lane.maxDepth
+            << "average wait:" << (lane.finished + lane.canceled ? lane.waitTime / static_cast<qint64>(lane.finished + lane.canceled) : 0) << "ms"
+            << "average run:" << (lane.finished ? lane.runTime / static_cast<qint64>(lane.finished) : 0) << "ms";
+}
+
 void FileInfoHelper::aboutToQuit()
 {
-    stoped = true;
-    thread->quit();
+    if (stoped.exchange(true))
+        return;
+
     worker->stopWorker();
-    thread->wait();
+    for (Lane &lane : lanes) {
+        QMutexLocker locker(&lane.mutex);
+        lane.queue.clear();
+        lane.inFlight.clear();
+    }
+    pool.waitForDone();
+
+    for (int i = 0; i < kLaneCount; ++i)
+        logStatistics(static_cast<RequestLane>(i));
 }
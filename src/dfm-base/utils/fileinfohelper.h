@@ -13,10 +13,23 @@
 
 #include <QObject>
 #include <QThread>
+#include <QThreadPool>
+#include <QHash>
 #include <QVariant>
 #include <QMimeDatabase>
+#include <QMutex>
+#include <QElapsedTimer>
+
+#include <functional>
 
 namespace dfmbase {
+/*!
+ * \brief The FileInfoHelper class runs the async requests of the file infos. each kind of
+ * request has its own lane with its own concurrency, so a slow thumbnail does not delay the
+ * mime types and the child counts. in a lane the newest request runs first, a request for
+ * the same file as a queued one shares its result, and a request whose owners
+ * released their FileInfoHelperUeserData is dropped before it runs.
+ */
 class FileInfoHelper : public QObject
 {
     Q_OBJECT
@@ -30,9 +43,50 @@ public:
     void fileRefreshAsync(const QUrl &url, const QSharedPointer<dfmio::DFileInfo> dfileInfo);
 
 private:
+    enum RequestLane : int {
+        kCountLane,
+        kMimeTypeLane,
+        kThumbLane,
+        kRefreshLane,
+        kLaneCount
+    };
+
+    using Work = std::function<void(const QSharedPointer<FileInfoHelperUeserData> &)>;
+    struct Request
+    {
+        QString key;
+        bool owned { true };   // a request without owner always runs
+        QList<QWeakPointer<FileInfoHelperUeserData>> owners;
+        Work work;
+        QElapsedTimer timer;
+    };
+    using RequestPointer = QSharedPointer<Request>;
+
+    struct Lane
+    {
+        QMutex mutex;
+        QList<RequestPointer> queue;
+        QHash<QString, RequestPointer> inFlight;   // the queued requests by key
+        int running { 0 };
+        int limit { 1 };
+
+        // statistics, guarded by mutex
+        int maxDepth { 0 };
+        quint64 finished { 0 };
+        quint64 canceled { 0 };
+        quint64 shared { 0 };
+        qint64 waitTime { 0 };
+        qint64 runTime { 0 };
+    };
+
     explicit FileInfoHelper(QObject *parent = nullptr);
     void init();
 
+    void post(RequestLane lane, const QString &key, const QSharedPointer<FileInfoHelperUeserData> &owner, Work work);
+    void schedule(RequestLane lane);
+    void run(RequestLane lane, const RequestPointer &request);
+    void logStatistics(RequestLane lane);
+
 private:
     // send for other
 Q_SIGNALS:
@@ -41,17 +95,12 @@ Q_SIGNALS:
     void mediaDataFinished(const QUrl &sourceFile, QMap<dfmio::DFileInfo::AttributeExtendID, QVariant> properties);
     void fileCountFinished(const QUrl &url, const int fileCount);
     void fileMimeTypeFinished(const QUrl &url, const QMimeType &type);
-    // shend to fileinfoasyncworker for async get attribute
-    void fileCount(const QUrl &url, const QSharedPointer<FileInfoHelperUeserData> data);
-    void fileMimeType(const QUrl &url, const QMimeDatabase::MatchMode mode, const QString &inod,
-                      const bool isGvfs, const QSharedPointer<FileInfoHelperUeserData> data);
-    void fileThumb(const QUrl &url, ThumbnailProvider::Size size, const QSharedPointer<FileInfoHelperUeserData> data);
-    void fileInfoRefresh(const QUrl &url, QSharedPointer<dfmio::DFileInfo> dfileInfo);
 private Q_SLOTS:
     void aboutToQuit();
 
 private:
-    QSharedPointer<QThread> thread { nullptr };
+    QThreadPool pool;
+    Lane lanes[kLaneCount];
     QSharedPointer<FileInfoAsycWorker> worker { nullptr };
     std::atomic_bool stoped { false };
 };
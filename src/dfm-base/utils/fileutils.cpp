@@ -12,6 +12,7 @@
 #include "dfm-base/utils/finallyutil.h"
 #include "dfm-base/base/device/deviceutils.h"
 #include "dfm-base/base/device/deviceproxymanager.h"
+#include "dfm-base/base/device/mounttopology.h"
 #include "dfm-base/base/schemefactory.h"
 #include "dfm-base/base/application/application.h"
 #include "dfm-base/base/application/settings.h"
@@ -162,12 +163,7 @@ bool FileUtils::isGvfsFile(const QUrl &url)
     if (!url.isValid())
         return false;
 
-    const QString &path = url.toLocalFile();
-    static const QString gvfsMatch { "(^/run/user/\\d+/gvfs/|^/root/.gvfs/|^/media/[\\s\\S]*/smbmounts)" };
-    // TODO(xust) /media/$USER/smbmounts might be changed in the future.
-    QRegularExpression re { gvfsMatch };
-    QRegularExpressionMatch match { re.match(path) };
-    return match.hasMatch();
+    return MountTopology::instance()->isGvfs(url.toLocalFile());
 }
 
 bool FileUtils::isMtpFile(const QUrl &url)
@@ -175,11 +171,7 @@ bool FileUtils::isMtpFile(const QUrl &url)
     if (!url.isValid())
         return false;
 
-    const QString &path = url.toLocalFile();
-    static const QString gvfsMatch { R"(^/run/user/\d+/gvfs/mtp:host|^/root/.gvfs/mtp:host)" };
-    QRegularExpression re { gvfsMatch };
-    QRegularExpressionMatch match { re.match(path) };
-    return match.hasMatch();
+    return MountTopology::instance()->isMtp(url.toLocalFile());
 }
 
 bool FileUtils::isGphotoFile(const QUrl &url)
@@ -187,11 +179,7 @@ bool FileUtils::isGphotoFile(const QUrl &url)
     if (!url.isValid())
         return false;
 
-    const QString &path = url.toLocalFile();
-    static const QString gvfsMatch { R"(^/run/user/\d+/gvfs/gphoto2:host|^/root/.gvfs/gphoto2:host)" };
-    QRegularExpression re { gvfsMatch };
-    QRegularExpressionMatch match { re.match(path) };
-    return match.hasMatch();
+    return MountTopology::instance()->isGphoto(url.toLocalFile());
 }
 
 QString FileUtils::preprocessingFileName(QString name)
@@ -347,7 +335,7 @@ bool FileUtils::isLocalDevice(const QUrl &url)
     if(isGvfsFile(url))
         return false;
 
-    if(DFMIO::DFMUtils::fileIsRemovable(url)) {
+    if (MountTopology::instance()->isRemovable(url.path())) {
         if (DeviceUtils::isSubpathOfDlnfs(url.path())) {
             return !(DevProxyMng->isFileOfExternalBlockMounts(url.path()));
         }
@@ -359,7 +347,7 @@ bool FileUtils::isLocalDevice(const QUrl &url)
 
 bool FileUtils::isCdRomDevice(const QUrl &url)
 {
-    return DFMIO::DFMUtils::devicePathFromUrl(url).startsWith("/dev/sr");
+    return MountTopology::instance()->isOptical(url.path());
 }
 
 bool FileUtils::trashIsEmpty()
@@ -1006,52 +994,65 @@ void FileUtils::notifyFileChangeManual(DFMGLOBAL_NAMESPACE::FileNotifyType type,
     }
 }
 
-bool FileUtils::compareString(const QString &str1, const QString &str2, Qt::SortOrder order)
+/*!
+ * \brief notifyFilesChangeManual notifies the urls grouped by their parent, the
+ * mount type is checked and the watcher is created once for each parent. the added
+ * files of a parent are notified in one batch.
+ */
+void FileUtils::notifyFilesChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType type, const QList<QUrl> &urls)
 {
-    class StrCollator : public QCollator
-    {
-    public:
-        explicit StrCollator(const QLocale &locale = QLocale())
-            : QCollator(locale)
-        {
-            setNumericMode(true);
-            setCaseSensitivity(Qt::CaseInsensitive);
-        }
-    };
+    QMap<QUrl, QList<QUrl>> urlsOfParent;
+    for (const auto &url : urls) {
+        if (!url.isValid())
+            continue;
 
-    thread_local static StrCollator sortCollator;
-    auto startWithSymbol = [](const QString &text) -> bool {
-        if (text.isEmpty())
-            return false;
+        const QUrl &urlParent = DFMIO::DFMUtils::directParentUrl(url);
+        if (urlParent.isValid())
+            urlsOfParent[urlParent].append(url);
+    }
 
-        // Matches strings beginning with letters, numbers, and Chinese
-        static const QRegExp regExp("^[a-zA-Z0-9\u4e00-\u9fa5].*$");
-        return !regExp.exactMatch(text);
-    };
+    for (auto it = urlsOfParent.cbegin(); it != urlsOfParent.cend(); ++it) {
+        if (!DeviceUtils::isSamba(it.key()) && !DeviceUtils::isFtp(it.key()))
+            continue;
 
-    auto startWithHanzi = [](const QString &text) -> bool {
-        if (text.isEmpty())
-            return false;
+        AbstractFileWatcherPointer watcher = WatcherFactory::create<AbstractFileWatcher>(it.key());
+        if (!watcher)
+            continue;
 
-        return text.at(0).script() == QChar::Script_Han;
-    };
+        if (type == DFMGLOBAL_NAMESPACE::FileNotifyType::kFileAdded) {
+            watcher->notifyFilesAdded(it.value());
+            continue;
+        }
 
-    // Other symbols need to be ranked last, and judgment needs to be made before Chinese
-    if (startWithSymbol(str1)) {
-        if (!startWithSymbol(str2))
-            return order == Qt::DescendingOrder;
-    } else if (startWithSymbol(str2))
-        return order != Qt::DescendingOrder;
-
-    if (startWithHanzi(str1)) {
-        if (!startWithHanzi(str2)) {
-            return order == Qt::DescendingOrder;
+        for (const auto &url : it.value()) {
+            switch (type) {
+            case DFMGLOBAL_NAMESPACE::FileNotifyType::kFileDeleted:
+                watcher->notifyFileDeleted(url);
+                break;
+            case DFMBASE_NAMESPACE::Global::FileNotifyType::kFileChanged:
+                watcher->notifyFileChanged(url);
+                break;
+            default:
+                break;
+            }
         }
-    } else if (startWithHanzi(str2)) {
-        return order != Qt::DescendingOrder;
     }
+}
 
-    return ((order == Qt::DescendingOrder) ^ (sortCollator.compare(str1, str2) < 0)) == 0x01;
+bool FileUtils::compareString(const QString &str1, const QString &str2, Qt::SortOrder order)
+{
+    // Other symbols need to be ranked last, and judgment needs to be made before Chinese
+    const quint8 rank1 = SortKey::rank(str1);
+    const quint8 rank2 = SortKey::rank(str2);
+    if (rank1 != rank2)
+        return order == Qt::AscendingOrder ? rank1 < rank2 : rank1 > rank2;
+
+    return ((order == Qt::DescendingOrder) ^ (SortKey::collator().compare(str1, str2) < 0)) == 0x01;
+}
+
+bool FileUtils::compareString(const SortKey &key1, const SortKey &key2, Qt::SortOrder order)
+{
+    return key1.lessThan(key2, order);
 }
 
 QString FileUtils::dateTimeFormat()
@@ -10,6 +10,7 @@
 #include "dfm-base/dfm_base_global.h"
 #include "dfm-base/interfaces/abstractjobhandler.h"
 #include "dfm-base/utils/desktopfile.h"
+#include "dfm-base/utils/sortkey.h"
 
 namespace dfmbase {
 
@@ -70,7 +71,9 @@ public:
     static bool containsCopyingFileUrl(const QUrl &url);
 
     static void notifyFileChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType type, const QUrl &url);
+    static void notifyFilesChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType type, const QList<QUrl> &urls);
     static bool compareString(const QString &str1, const QString &str2, Qt::SortOrder order);
+    static bool compareString(const SortKey &key1, const SortKey &key2, Qt::SortOrder order);
 
     static QString dateTimeFormat();
     static bool setBackGround(const QString &pictureFilePath);
@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sortkey.h"
+
+using namespace dfmbase;
+
+namespace {
+enum PrefixRank : quint8 {
+    kRankNormal = 0x0,
+    kRankHanzi = 0x1,
+    kRankSymbol = 0x2,
+};
+}
+
+SortKey::SortKey(const QString &text)
+    : source(text),
+      prefixRank(rank(text)),
+      collationKey(collator().sortKey(text))
+{
+}
+
+bool SortKey::isValid() const
+{
+    return collationKey.has_value();
+}
+
+QString SortKey::text() const
+{
+    return source;
+}
+
+/*!
+ * \brief compare the keys in ascending order
+ * \return negative, zero or positive like QCollator::compare
+ */
+int SortKey::compare(const SortKey &other) const
+{
+    if (prefixRank != other.prefixRank)
+        return prefixRank < other.prefixRank ? -1 : 1;
+
+    if (!collationKey || !other.collationKey)
+        return collator().compare(source, other.source);
+
+    return collationKey->compare(*other.collationKey);
+}
+
+/*!
+ * \brief same result as FileUtils::compareString(text(), other.text(), order)
+ */
+bool SortKey::lessThan(const SortKey &other, Qt::SortOrder order) const
+{
+    if (prefixRank != other.prefixRank)
+        return order == Qt::AscendingOrder ? prefixRank < other.prefixRank
+                                           : prefixRank > other.prefixRank;
+
+    const int ret = compare(other);
+    return order == Qt::AscendingOrder ? ret < 0 : ret >= 0;
+}
+
+/*!
+ * \brief Names beginning with a symbol are ranked last, names beginning with
+ * Hanzi follow the letters and numbers. The symbol check is made before the
+ * Hanzi one, so the rank orders the same way as the former prefix checks.
+ */
+quint8 SortKey::rank(const QString &text)
+{
+    if (text.isEmpty())
+        return kRankNormal;
+
+    const QChar first = text.at(0);
+    const ushort code = first.unicode();
+    // letters, numbers and Chinese are not symbols
+    const bool isSymbol = !((code >= 'a' && code <= 'z')
+                            || (code >= 'A' && code <= 'Z')
+                            || (code >= '0' && code <= '9')
+                            || (code >= 0x4e00 && code <= 0x9fa5));
+    const bool isHanzi = first.script() == QChar::Script_Han;
+
+    return (isSymbol ? kRankSymbol : kRankNormal) | (isHanzi ? kRankHanzi : kRankNormal);
+}
+
+QCollator &SortKey::collator()
+{
+    class StrCollator : public QCollator
+    {
+    public:
+        explicit StrCollator(const QLocale &locale = QLocale())
+            : QCollator(locale)
+        {
+            setNumericMode(true);
+            setCaseSensitivity(Qt::CaseInsensitive);
+        }
+    };
+
+    thread_local static StrCollator sortCollator;
+    return sortCollator;
+}
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SORTKEY_H
+#define SORTKEY_H
+
+#include "dfm-base/dfm_base_global.h"
+
+#include <QCollator>
+#include <QString>
+
+#include <optional>
+
+namespace dfmbase {
+
+/*!
+ * \brief The SortKey class is the precomputed form of a name for FileUtils::compareString.
+ * The symbol/Hanzi rank and the collation key are computed once, so comparing two
+ * keys needs neither the prefix checks nor a collation pass over both strings.
+ */
+class SortKey
+{
+public:
+    SortKey() = default;
+    explicit SortKey(const QString &text);
+
+    bool isValid() const;
+    QString text() const;
+    int compare(const SortKey &other) const;
+    bool lessThan(const SortKey &other, Qt::SortOrder order) const;
+
+    static quint8 rank(const QString &text);
+    static QCollator &collator();
+
+private:
+    QString source;
+    quint8 prefixRank { 0 };
+    std::optional<QCollatorSortKey> collationKey;
+};
+
+}
+
+#endif   // SORTKEY_H
@@ -4,6 +4,7 @@
 
 #include "thumbnailprovider.h"
 #include "videothumbnailprovider.h"
+#include "thumbnailstore.h"
 #include "dfm-base/mimetype/dmimedatabase.h"
 #include "dfm-base/mimetype/mimetypedisplaymanager.h"
 #include "dfm-base/base/standardpaths.h"
@@ -23,6 +24,7 @@
 #include <QMimeType>
 #include <QPainter>
 #include <QProcess>
+#include <QSaveFile>
 #include <QDebug>
 #include <QtConcurrent>
 
@@ -243,8 +245,17 @@ QPixmap ThumbnailProvider::thumbnailPixmap(const QUrl &fileUrl, Size size) const
         return absoluteFilePath;
     }
 
-    const QString thumbnailName = dataToMd5Hex((QUrl::fromLocalFile(absoluteFilePath).toString(QUrl::FullyEncoded)).toLocal8Bit()) + kFormat;
+    const QByteArray &md5 = QCryptographicHash::hash(QUrl::fromLocalFile(absoluteFilePath).toString(QUrl::FullyEncoded).toLocal8Bit(),
+                                                     QCryptographicHash::Md5);
+    const QString thumbnailName = md5.toHex() + kFormat;
     QString thumbnail = DFMIO::DFMUtils::buildFilePath(d->sizeToFilePath(size).toStdString().c_str(), thumbnailName.toStdString().c_str(), nullptr);
+    const qint64 fileModify = fileInfo->timeOf(TimeInfoType::kLastModifiedSecond).value<qint64>();
+
+    // the store knows a fresh thumbnail without stat, a changed one is checked below
+    QImage image;
+    if (ThumbnailStore::instance()->find(absolutePath, md5, size, fileModify, thumbnail, &image) == ThumbnailStore::kFresh)
+        return QPixmap::fromImage(image);
+
     if (!DecoratorFile(thumbnail).exists()) {
         return QString();
     }
@@ -256,14 +267,16 @@ QPixmap ThumbnailProvider::thumbnailPixmap(const QUrl &fileUrl, Size size) const
     }
     ir.setAutoDetectImageFormat(false);
 
-    const QImage image = ir.read();
-    const qint64 fileModify = fileInfo->timeOf(TimeInfoType::kLastModifiedSecond).value<qint64>();
+    image = ir.read();
     if (!image.isNull() && image.text(QT_STRINGIFY(Thumb::MTime)).toInt() != static_cast<int>(fileModify)) {
         DecoratorFileOperator(thumbnail).deleteFile();
 
         return QPixmap();
     }
 
+    if (!image.isNull())
+        ThumbnailStore::instance()->insert(absolutePath, md5, size, fileModify, image);
+
     return QPixmap::fromImage(image);
 }
 
@@ -345,11 +358,21 @@ QString ThumbnailProvider::createThumbnail(const QUrl &url, ThumbnailProvider::S
     // create path
     QFileInfo(thumbnail).absoluteDir().mkpath(".");
 
-    if (!image->save(thumbnail, Q_NULLPTR, 50)) {
+    if (!d->errorString.isEmpty()) {
+        if (!image->save(thumbnail, Q_NULLPTR, 50))
+            d->errorString = QStringLiteral("Can not save image to ") + thumbnail;
+        return QString();
+    }
+
+    // replaced atomically, the other processes may be reading it
+    QSaveFile file(thumbnail);
+    if (!file.open(QIODevice::WriteOnly) || !image->save(&file, "png", 50) || !file.commit()) {
         d->errorString = QStringLiteral("Can not save image to ") + thumbnail;
     }
 
     if (d->errorString.isEmpty()) {
+        const QByteArray &md5 = QCryptographicHash::hash(fileUrl.toLocal8Bit(), QCryptographicHash::Md5);
+        ThumbnailStore::instance()->insert(DirPath, md5, size, fileModify, *image);
         return thumbnail;
     }
 
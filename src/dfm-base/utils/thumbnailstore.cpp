@@ -0,0 +1,345 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "thumbnailstore.h"
+#include "dfm-base/base/standardpaths.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QDebug>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+using namespace dfmbase;
+
+namespace {
+static constexpr quint32 kIndexMagic { 0x49485446 };   // "FTHI"
+static constexpr quint32 kIndexVersion { 2 };
+static constexpr int kKeySize { 18 };   // md5 | size
+static constexpr char kIndexSuffix[] { ".index" };
+// the indexes of so many dirs are kept in memory with their files open
+static constexpr int kMaxDirs { 16 };
+// the index is rewritten when it has more dead records than this and the live ones
+static constexpr int kMinDeadCount { 256 };
+// size limit of all the index files, the least recently used are removed first
+static constexpr qint64 kStoreMaxBytes { 64 * 1024 * 1024 };
+// size limit of the decoded thumbnails, in KiB
+static constexpr int kMaxImageCost { 64 * 1024 };
+
+// file layout: IndexHeader | IndexRecord..., a later record of the same key replaces
+// the former, all in host byte order
+struct IndexHeader
+{
+    quint32 magic;
+    quint32 version;
+};
+
+struct IndexRecord
+{
+    char key[kKeySize];
+    quint16 reserved;
+    quint32 padding;
+    qint64 mtime;   // mtime of the source file in seconds, -1 if the record is removed
+};
+
+// the index is shared by the processes, it is locked while it is read or written
+class IndexLocker
+{
+public:
+    IndexLocker(QFile *file, int operation)
+        : fd(file->handle())
+    {
+        while (fd >= 0 && ::flock(fd, operation) != 0 && errno == EINTR) { }
+    }
+
+    ~IndexLocker()
+    {
+        if (fd >= 0)
+            ::flock(fd, LOCK_UN);
+    }
+
+private:
+    int fd { -1 };
+};
+}
+
+ThumbnailStore::ThumbnailStore(const QString &storeDir)
+    : storeDir(storeDir),
+      images(kMaxImageCost)
+{
+}
+
+ThumbnailStore::~ThumbnailStore()
+{
+    qDeleteAll(dirs);
+}
+
+ThumbnailStore *ThumbnailStore::instance()
+{
+    static ThumbnailStore ins;
+    return &ins;
+}
+
+/*!
+ * \brief find the thumbnail of a file in dirPath, md5 is the raw md5 of its url and
+ * mtime is its modified time in seconds. thumbnail is the PNG in the thumbnail dir.
+ * A changed file is kUnknown, the caller checks the PNG itself, as it may have been
+ * generated again by another process.
+ */
+ThumbnailStore::State ThumbnailStore::find(const QString &dirPath, const QByteArray &md5, ThumbnailProvider::Size size,
+                                           qint64 mtime, const QString &thumbnail, QImage *image)
+{
+    const QByteArray &key = recordKey(md5, size);
+    QMutexLocker lk(&mutex);
+    if (CachedImage *cached = images.object(key)) {
+        if (cached->mtime == mtime) {
+            *image = cached->image;
+            return kFresh;
+        }
+        images.remove(key);
+    }
+
+    DirIndex *dir = dirIndex(dirPath);
+    if (!dir)
+        return kUnknown;
+
+    auto it = dir->records.constFind(key);
+    if (it == dir->records.constEnd())
+        return kUnknown;
+
+    if (it.value() != mtime) {
+        appendRecord(dir, key, -1);
+        return kUnknown;
+    }
+
+    // decode without the lock
+    lk.unlock();
+    const bool valid = image->load(thumbnail, "png");
+    lk.relock();
+
+    if (!valid) {
+        // the dir may have been dropped from memory meanwhile
+        removeRecord(dirPath, key);
+        return kUnknown;
+    }
+
+    images.insert(key, new CachedImage { *image, mtime }, imageCost(*image));
+    return kFresh;
+}
+
+/*!
+ * \brief insert a thumbnail that has been saved to the thumbnail dir
+ */
+void ThumbnailStore::insert(const QString &dirPath, const QByteArray &md5, ThumbnailProvider::Size size,
+                            qint64 mtime, const QImage &image)
+{
+    const QByteArray &key = recordKey(md5, size);
+    QMutexLocker lk(&mutex);
+    if (!image.isNull())
+        images.insert(key, new CachedImage { image, mtime }, imageCost(image));
+
+    DirIndex *dir = dirIndex(dirPath);
+    if (dir)
+        appendRecord(dir, key, mtime);
+}
+
+void ThumbnailStore::remove(const QString &dirPath, const QByteArray &md5, ThumbnailProvider::Size size)
+{
+    const QByteArray &key = recordKey(md5, size);
+    QMutexLocker lk(&mutex);
+    removeRecord(dirPath, key);
+}
+
+QString ThumbnailStore::defaultStoreDir()
+{
+    return StandardPaths::location(StandardPaths::kCachePath) + "/thumbstore";
+}
+
+QByteArray ThumbnailStore::recordKey(const QByteArray &md5, ThumbnailProvider::Size size)
+{
+    QByteArray key(kKeySize, '\0');
+    memcpy(key.data(), md5.constData(), static_cast<size_t>(qMin(md5.size(), 16)));
+    const quint16 value = size;
+    memcpy(key.data() + 16, &value, sizeof(value));
+    return key;
+}
+
+int ThumbnailStore::imageCost(const QImage &image)
+{
+    return qMax(1, static_cast<int>(image.sizeInBytes() / 1024));
+}
+
+// called with mutex locked
+void ThumbnailStore::removeRecord(const QString &dirPath, const QByteArray &key)
+{
+    images.remove(key);
+
+    DirIndex *dir = dirIndex(dirPath);
+    if (dir && dir->records.contains(key))
+        appendRecord(dir, key, -1);
+}
+
+// called with mutex locked
+ThumbnailStore::DirIndex *ThumbnailStore::dirIndex(const QString &dirPath)
+{
+    if (DirIndex *dir = dirs.value(dirPath)) {
+        dirOrder.removeOne(dirPath);
+        dirOrder.append(dirPath);
+        return dir;
+    }
+
+    if (storeDir.isEmpty() || !QDir().mkpath(storeDir))
+        return nullptr;
+
+    const QByteArray &hash = QCryptographicHash::hash(dirPath.toUtf8(), QCryptographicHash::Md5).toHex();
+    const QString &base = storeDir + "/" + QString::fromLatin1(hash);
+    DirIndex *dir = new DirIndex;
+    dir->index.setFileName(base + kIndexSuffix);
+    if (!loadIndex(dir)) {
+        delete dir;
+        return nullptr;
+    }
+
+    dirs.insert(dirPath, dir);
+    dirOrder.append(dirPath);
+    while (dirOrder.size() > kMaxDirs)
+        delete dirs.take(dirOrder.takeFirst());
+
+    evict();
+    return dir;
+}
+
+bool ThumbnailStore::loadIndex(DirIndex *dir)
+{
+    if (!dir->index.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+        qWarning() << "open thumbnail index failed: " << dir->index.fileName() << dir->index.errorString();
+        return false;
+    }
+
+    QByteArray data;
+    {
+        IndexLocker locker(&dir->index, LOCK_SH);
+        data = dir->index.readAll();
+    }
+
+    if (!readRecords(dir, data)) {
+        if (!data.isEmpty())
+            qInfo() << "discard the invalid thumbnail index: " << dir->index.fileName();
+        if (!rewriteIndex(dir))
+            return false;
+    } else if (dir->deadCount > kMinDeadCount && dir->deadCount > dir->records.size()) {
+        rewriteIndex(dir);
+    }
+
+    // the mtime of the file is the last used time for eviction
+    ::utimensat(AT_FDCWD, dir->index.fileName().toLocal8Bit().constData(), nullptr, 0);
+    return true;
+}
+
+// returns false if data is not a valid index, the records are cleared then
+bool ThumbnailStore::readRecords(DirIndex *dir, const QByteArray &data)
+{
+    dir->records.clear();
+    dir->deadCount = 0;
+
+    IndexHeader header { 0, 0 };
+    if (data.size() >= static_cast<int>(sizeof(header)))
+        memcpy(&header, data.constData(), sizeof(header));
+
+    const qint64 recordsSize = data.size() - static_cast<qint64>(sizeof(header));
+    if (header.magic != kIndexMagic || header.version != kIndexVersion
+        || recordsSize < 0 || recordsSize % static_cast<qint64>(sizeof(IndexRecord)) != 0)
+        return false;
+
+    const char *recordData = data.constData() + sizeof(header);
+    const qint64 count = recordsSize / static_cast<qint64>(sizeof(IndexRecord));
+    dir->records.reserve(static_cast<int>(count));
+    for (qint64 i = 0; i < count; ++i) {
+        IndexRecord item;
+        memcpy(&item, recordData + i * static_cast<qint64>(sizeof(IndexRecord)), sizeof(item));
+        const QByteArray key(item.key, kKeySize);
+        const bool exists = dir->records.remove(key) > 0;
+        if (item.mtime < 0 || exists)
+            ++dir->deadCount;
+        if (item.mtime >= 0)
+            dir->records.insert(key, item.mtime);
+    }
+    return true;
+}
+
+/*!
+ * \brief rewriteIndex writes the live records only. The file is rewritten in place under
+ * the lock, so the other processes keep appending to it, and the records they appended
+ * since it was read are merged first.
+ */
+bool ThumbnailStore::rewriteIndex(DirIndex *dir)
+{
+    IndexLocker locker(&dir->index, LOCK_EX);
+    if (dir->index.seek(0))
+        readRecords(dir, dir->index.readAll());
+
+    QByteArray data;
+    const IndexHeader header { kIndexMagic, kIndexVersion };
+    data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (auto it = dir->records.cbegin(); it != dir->records.cend(); ++it) {
+        IndexRecord item;
+        memset(&item, 0, sizeof(item));
+        memcpy(item.key, it.key().constData(), kKeySize);
+        item.mtime = it.value();
+        data.append(reinterpret_cast<const char *>(&item), sizeof(item));
+    }
+
+    if (!dir->index.resize(0) || !dir->index.seek(0) || dir->index.write(data) != data.size()) {
+        qWarning() << "write thumbnail index failed: " << dir->index.fileName() << dir->index.errorString();
+        return false;
+    }
+
+    dir->deadCount = 0;
+    return true;
+}
+
+void ThumbnailStore::appendRecord(DirIndex *dir, const QByteArray &key, qint64 mtime)
+{
+    if (dir->records.contains(key) || mtime < 0)
+        ++dir->deadCount;
+    if (mtime < 0)
+        dir->records.remove(key);
+    else
+        dir->records.insert(key, mtime);
+
+    IndexRecord item;
+    memset(&item, 0, sizeof(item));
+    memcpy(item.key, key.constData(), kKeySize);
+    item.mtime = mtime;
+
+    IndexLocker locker(&dir->index, LOCK_EX);
+    if (!dir->index.seek(dir->index.size())
+        || dir->index.write(reinterpret_cast<const char *>(&item), sizeof(item)) != sizeof(item))
+        qWarning() << "write thumbnail index failed: " << dir->index.fileName() << dir->index.errorString();
+}
+
+// called with mutex locked
+void ThumbnailStore::evict()
+{
+    QSet<QString> inUse;
+    for (const DirIndex *dir : dirs)
+        inUse.insert(dir->index.fileName());
+
+    // sorted by the last used time, the most recent first. An index is a single file,
+    // a process still holding a removed one only loses the records it appends
+    const QFileInfoList &files = QDir(storeDir).entryInfoList(QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const auto &file : files) {
+        total += file.size();
+        if (!file.fileName().endsWith(kIndexSuffix) || (total > kStoreMaxBytes && !inUse.contains(file.absoluteFilePath())))
+            QFile::remove(file.absoluteFilePath());
+    }
+}
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef THUMBNAILSTORE_H
+#define THUMBNAILSTORE_H
+
+#include "dfm-base/dfm_base_global.h"
+#include "dfm-base/utils/thumbnailprovider.h"
+
+#include <QCache>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QStringList>
+
+namespace dfmbase {
+
+/*!
+ * \brief The ThumbnailStore class sits in front of the freedesktop thumbnail dirs.
+ * It keeps the decoded thumbnails in a LRU bounded by bytes, and for every source dir
+ * an append-only index (md5 and size -> mtime) under the cache dir, so that the
+ * freshness of a thumbnail is known without stat or decoding its PNG.
+ * The index is shared by the processes of the file manager, it is appended and rewritten
+ * with an exclusive flock on it and read with a shared one.
+ */
+class ThumbnailStore
+{
+    Q_DISABLE_COPY(ThumbnailStore)
+
+public:
+    enum State {
+        kUnknown,   // not in the store or changed, check the thumbnail dir
+        kFresh,
+    };
+
+    static ThumbnailStore *instance();
+
+    State find(const QString &dirPath, const QByteArray &md5, ThumbnailProvider::Size size,
+               qint64 mtime, const QString &thumbnail, QImage *image);
+    void insert(const QString &dirPath, const QByteArray &md5, ThumbnailProvider::Size size,
+                qint64 mtime, const QImage &image);
+    void remove(const QString &dirPath, const QByteArray &md5, ThumbnailProvider::Size size);
+
+private:
+    struct DirIndex
+    {
+        QHash<QByteArray, qint64> records;   // the mtime of the source files
+        QFile index;
+        int deadCount { 0 };
+    };
+
+    struct CachedImage
+    {
+        QImage image;
+        qint64 mtime { 0 };
+    };
+
+    explicit ThumbnailStore(const QString &storeDir = defaultStoreDir());
+    ~ThumbnailStore();
+
+    static QString defaultStoreDir();
+    static QByteArray recordKey(const QByteArray &md5, ThumbnailProvider::Size size);
+    static int imageCost(const QImage &image);
+
+    void removeRecord(const QString &dirPath, const QByteArray &key);
+    DirIndex *dirIndex(const QString &dirPath);
+    bool loadIndex(DirIndex *dir);
+    bool readRecords(DirIndex *dir, const QByteArray &data);
+    bool rewriteIndex(DirIndex *dir);
+    void appendRecord(DirIndex *dir, const QByteArray &key, qint64 mtime);
+    void evict();
+
+private:
+    QMutex mutex;
+    QString storeDir;
+    QCache<QByteArray, CachedImage> images;
+    QHash<QString, DirIndex *> dirs;
+    QStringList dirOrder;   // the most recently used is the last
+};
+
+}
+
+#endif   // THUMBNAILSTORE_H
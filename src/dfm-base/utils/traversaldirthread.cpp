@@ -4,14 +4,20 @@
 
 #include "traversaldirthread.h"
 #include "dfm-base/utils/fileutils.h"
+#include "dfm-base/utils/dirlistingcache.h"
 #include "dfm-base/base/schemefactory.h"
 
 #include <QElapsedTimer>
+#include <QHash>
 #include <QDebug>
 
 using namespace dfmbase;
 USING_IO_NAMESPACE
 
+// a batch of children is delivered once a frame or when it is large enough
+static constexpr int kBatchInterval { 16 };
+static constexpr int kBatchMaxCount { 2000 };
+
 TraversalDirThread::TraversalDirThread(const QUrl &url,
                                        const QStringList &nameFilters,
                                        QDir::Filters filters,
@@ -64,6 +70,15 @@ void TraversalDirThread::stopAndDeleteLater()
     }
 }
 
+/*!
+ * \brief setSnapshotEnabled the snapshot of last visit is loaded before the enumeration and
+ * saved after it, only for the traversals that show the directory
+ */
+void TraversalDirThread::setSnapshotEnabled(const bool enabled)
+{
+    snapshotEnabled = enabled;
+}
+
 void TraversalDirThread::setSortAgruments(const Qt::SortOrder order, const Global::ItemRoles sortRole, const bool isMixDirAndFile)
 {
     sortOrder = order;
@@ -96,6 +111,22 @@ void TraversalDirThread::run()
 
     qInfo() << "dir query start, url: " << dirUrl;
 
+    // show the snapshot of last visit while the directory is enumerated
+    DirListingCache::DirStamp stamp;
+    QHash<QUrl, AbstractFileInfoPointer> snapshotChildren;
+    const bool useSnapshot = snapshotEnabled && nameFilters.isEmpty() && DirListingCache::instance()->isEnabled(dirUrl)
+            && DirListingCache::dirStamp(dirUrl.path(), &stamp);
+    if (useSnapshot) {
+        const QList<AbstractFileInfoPointer> &infos = DirListingCache::instance()->loadChildren(dirUrl, filters);
+        if (!infos.isEmpty()) {
+            snapshotChildren.reserve(infos.size());
+            for (const auto &info : infos)
+                snapshotChildren.insert(info->urlOf(UrlInfoType::kUrl), info);
+            emit updateChildrenSnapshot(infos);
+            qInfo() << "dir snapshot loaded, file count: " << infos.size() << " url: " << dirUrl << " elapsed: " << timer.elapsed();
+        }
+    }
+
     dirIterator->cacheBlockIOAttribute();
 
     qInfo() << "cacheBlockIOAttribute finished, url: " << dirUrl << " elapsed: " << timer.elapsed();
@@ -122,6 +153,22 @@ void TraversalDirThread::run()
     if (stopFlag)
         return;
 
+    QList<AbstractFileInfoPointer> batch;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    bool firstBatch = true;
+    auto flushBatch = [&]() {
+        if (batch.isEmpty())
+            return;
+        emit updateChildrenBatch(batch);
+        if (firstBatch) {
+            firstBatch = false;
+            qInfo() << "dir query first batch, file count: " << batch.size() << " url: " << dirUrl << " elapsed: " << timer.elapsed();
+        }
+        batch.clear();
+        batchTimer.restart();
+    };
+
     while (dirIterator->hasNext()) {
         if (stopFlag)
             break;
@@ -137,8 +184,36 @@ void TraversalDirThread::run()
 
         emit updateChild(fileInfo);
         childrenList.append(fileInfo);
+        batch.append(fileInfo);
+        if (batch.size() >= kBatchMaxCount || batchTimer.elapsed() >= kBatchInterval)
+            flushBatch();
     }
+    const bool finished = !stopFlag;
+    if (finished)
+        flushBatch();
     stopFlag = true;
+
+    if (useSnapshot && finished) {
+        // the snapshot is rewritten only if the enumeration differs from it
+        bool changed = snapshotChildren.isEmpty();
+        for (const auto &info : childrenList) {
+            auto it = snapshotChildren.find(info->urlOf(UrlInfoType::kUrl));
+            if (it == snapshotChildren.end()) {
+                changed = true;
+                continue;
+            }
+            if (!changed && !DirListingCache::isSameEntry(it.value(), info))
+                changed = true;
+            snapshotChildren.erase(it);
+        }
+        if (!snapshotChildren.isEmpty()) {
+            changed = true;
+            emit removeChildrenSnapshot(snapshotChildren.keys());
+        }
+        if (changed)
+            DirListingCache::instance()->save(dirUrl, filters, stamp, childrenList);
+    }
+
     emit updateChildren(childrenList);
 
     qInfo() << "dir query end, file count: " << childrenList.size() << " url: " << dirUrl << " elapsed: " << timer.elapsed();
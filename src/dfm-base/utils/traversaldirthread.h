@@ -27,6 +27,7 @@ class TraversalDirThread : public QThread
     QList<AbstractFileInfoPointer> childrenList;   // 当前遍历出来的所有文件
     bool stopFlag = false;
     bool isMixDirAndFile = false;
+    bool snapshotEnabled = false;   // 是否使用上次遍历的快照，只有视图的遍历需要
 
     QStringList nameFilters;
     QDir::Filters filters;
@@ -44,10 +45,17 @@ public:
     void quit();
     void stopAndDeleteLater();
     void setSortAgruments(const Qt::SortOrder order, const dfmbase::Global::ItemRoles sortRole, const bool isMixDirAndFile = false);
+    void setSnapshotEnabled(const bool enabled);
 
 Q_SIGNALS:
     void updateChildren(QList<AbstractFileInfoPointer> children);
     void updateChild(const AbstractFileInfoPointer child);
+    // children found since the last batch, emitted every kBatchInterval ms or kBatchMaxCount files
+    void updateChildrenBatch(QList<AbstractFileInfoPointer> children);
+    // children from the persistent snapshot, emitted before the enumeration starts
+    void updateChildrenSnapshot(QList<AbstractFileInfoPointer> children);
+    // children in the snapshot which the enumeration did not find
+    void removeChildrenSnapshot(QList<QUrl> children);
     void stoped();
 // Special processing If it is a local file, directly read all the simple sorting lists of the file
 Q_SIGNALS:
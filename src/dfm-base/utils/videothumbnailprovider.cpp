@@ -7,9 +7,47 @@
 #include <QImage>
 #include <QProcess>
 #include <QDir>
+#include <QFile>
+#include <QThreadStorage>
 #include <QDebug>
 
+#include <libffmpegthumbnailer/ifilter.h>
+#include <libffmpegthumbnailer/videoframe.h>
+#include <libffmpegthumbnailer/videothumbnailer.h>
+
 namespace dfmbase {
+
+// takes the scaled RGB frame before it is written to the output buffer
+class VideoFrameCapture : public ffmpegthumbnailer::IFilter
+{
+public:
+    void process(ffmpegthumbnailer::VideoFrame &frame) override
+    {
+        image = QImage(frame.frameData.data(), frame.width, frame.height, frame.lineSize, QImage::Format_RGB888).copy();
+    }
+
+    QImage image;
+};
+
+// the thumbnailer of a worker thread, it is reused for the files thumbnailed by the thread
+struct VideoFrameExtractor
+{
+    VideoFrameExtractor()
+        : thumbnailer(0, false, true, 8, false)
+    {
+        thumbnailer.setSeekPercentage(10);
+        thumbnailer.addFilter(&capture);
+    }
+
+    ~VideoFrameExtractor()
+    {
+        thumbnailer.removeFilter(&capture);
+    }
+
+    ffmpegthumbnailer::VideoThumbnailer thumbnailer;
+    VideoFrameCapture capture;
+};
+
 class VideoThumbnailProviderPrivate
 {
 public:
@@ -21,6 +59,9 @@ public:
     }
     ~VideoThumbnailProviderPrivate() = default;
 
+    QImage createByThumbnailer(int size, const QString &path);
+    QImage createByProcess(const QString &size, const QString &path);
+
 public:
     QStringList videoType;
     VideoThumbnailProvider *q;
@@ -45,6 +86,44 @@ bool VideoThumbnailProvider::hasKey(const QString &key) const
 }
 
 QImage VideoThumbnailProvider::createThumbnail(const QString &size, const QString &path)
+{
+    const QImage &image = d->createByThumbnailer(size.toInt(), path);
+    if (!image.isNull())
+        return image;
+
+    // the codecs that the library can not handle
+    return d->createByProcess(size, path);
+}
+
+/*!
+ * \brief seek to the keyframe near 10% of the video and decode one frame scaled to size,
+ * in the calling thread
+ */
+QImage VideoThumbnailProviderPrivate::createByThumbnailer(int size, const QString &path)
+{
+    static QThreadStorage<VideoFrameExtractor *> thumbnailers;
+    if (!thumbnailers.hasLocalData())
+        thumbnailers.setLocalData(new VideoFrameExtractor);
+
+    VideoFrameExtractor *worker = thumbnailers.localData();
+    worker->capture.image = QImage();
+    worker->thumbnailer.setThumbnailSize(size);
+
+    std::vector<uint8_t> buffer;
+    try {
+        worker->thumbnailer.generateThumbnail(QFile::encodeName(path).toStdString(),
+                                              ThumbnailerImageType::Rgb, buffer);
+    } catch (std::exception &e) {
+        qDebug() << "create video thumbnail in process failed:" << path << e.what();
+        return QImage();
+    }
+
+    QImage image;
+    image.swap(worker->capture.image);
+    return image;
+}
+
+QImage VideoThumbnailProviderPrivate::createByProcess(const QString &size, const QString &path)
 {
     QImage image;
     QByteArray output;
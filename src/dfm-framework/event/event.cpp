@@ -10,7 +10,15 @@ class EventPrivate
 public:
     using EventMap = QMap<QString, EventType>;
 
+    struct EventId
+    {
+        EventStratege stratege;
+        EventType type;
+    };
+
     QReadWriteLock rwLock;
+    // all the events by "space:topic", so that an event is resolved in one lookup
+    QHash<QString, EventId> eventIds;
     QMap<EventStratege, EventMap> eventsMap {
         { EventStratege::kSignal, {} },
         { EventStratege::kSlot, {} },
@@ -49,32 +57,40 @@ EventChannelManager *Event::channel()
 void Event::registerEventType(EventStratege stratege, const QString &space, const QString &topic)
 {
     QString key { space + ":" + topic };
+    // plugins may be created on several threads at once
+    QWriteLocker guard(&d->rwLock);
     if (Q_UNLIKELY(d->eventsMap[stratege].contains(key))) {
         qWarning() << "Register repeat event: " << key;
         return;
     }
 
-    QWriteLocker guard(&d->rwLock);
-    d->eventsMap[stratege].insert(key, genCustomEventId());
+    EventType type { genCustomEventId() };
+    d->eventsMap[stratege].insert(key, type);
+    d->eventIds.insert(key, { stratege, type });
 }
 
 EventType Event::eventType(const QString &space, const QString &topic)
 {
-    static const QMap<QString, EventStratege> prefixMap { { kSignalStrategePrefix, EventStratege::kSignal },
-                                                          { kSlotStrategePrefix, EventStratege::kSlot },
-                                                          { kHookStrategePrefix, EventStratege::kHook } };
-    static const QStringList prefixKeys { prefixMap.keys() };
-
-    QStringList splits { topic.split("_") };
-    Q_ASSERT(splits.size() > 0);
-    QString prefix { splits.first().toLower() };
-    if (!prefixKeys.contains(prefix))
+    // the prefix of the topic tells the stratege, e.g. "slot" of "slot_Tab_Add"
+    const int end { topic.indexOf('_') };
+    const QStringRef prefix { end < 0 ? topic.midRef(0) : topic.leftRef(end) };
+    EventStratege stratege;
+    if (prefix.compare(QLatin1String(kSignalStrategePrefix), Qt::CaseInsensitive) == 0)
+        stratege = EventStratege::kSignal;
+    else if (prefix.compare(QLatin1String(kSlotStrategePrefix), Qt::CaseInsensitive) == 0)
+        stratege = EventStratege::kSlot;
+    else if (prefix.compare(QLatin1String(kHookStrategePrefix), Qt::CaseInsensitive) == 0)
+        stratege = EventStratege::kHook;
+    else
         return EventTypeScope::kInValid;
-    EventStratege stratege { prefixMap.value(prefix) };
-    QString key { space + ":" + topic };
+
+    QString key;
+    key.reserve(space.size() + topic.size() + 1);
+    key.append(space).append(':').append(topic);
 
     QReadLocker guard(&d->rwLock);
-    return d->eventsMap[stratege].contains(key) ? d->eventsMap[stratege].value(key) : EventTypeScope::kInValid;
+    auto it = d->eventIds.constFind(key);
+    return (it != d->eventIds.constEnd() && it->stratege == stratege) ? it->type : EventTypeScope::kInValid;
 }
 
 QStringList Event::pluginTopics(const QString &space)
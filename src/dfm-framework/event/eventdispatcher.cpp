@@ -10,6 +10,16 @@
 
 DPF_USE_NAMESPACE
 
+EventDispatcher::EventDispatcher()
+    : handlerList(std::make_shared<const HandlerList>()),
+      filterList(std::make_shared<const FilterList>())
+{
+}
+
+EventDispatcher::~EventDispatcher()
+{
+}
+
 bool EventDispatcher::dispatch()
 {
     return dispatch(QVariantList());
@@ -17,29 +27,45 @@ bool EventDispatcher::dispatch()
 
 bool EventDispatcher::dispatch(const QVariantList &params)
 {
-    if (std::any_of(filterList.begin(), filterList.end(), [params](const EventHandler<Listener> &h) {
+    return dispatchTo(*std::atomic_load(&filterList), *std::atomic_load(&handlerList), params);
+}
+
+QFuture<bool> EventDispatcher::asyncDispatch()
+{
+    return asyncDispatch(QVariantList());
+}
+
+QFuture<bool> EventDispatcher::asyncDispatch(const QVariantList &params)
+{
+    // the lists are held by the task, the dispatcher may be removed before it runs
+    std::shared_ptr<const FilterList> filters { std::atomic_load(&filterList) };
+    std::shared_ptr<const HandlerList> handlers { std::atomic_load(&handlerList) };
+    return QFuture<bool>(QtConcurrent::run([filters, handlers, params]() -> bool {
+        return dispatchTo(*filters, *handlers, params);
+    }));
+}
+
+bool EventDispatcher::dispatchTo(const FilterList &filters, const HandlerList &handlers, const QVariantList &params)
+{
+    if (std::any_of(filters.begin(), filters.end(), [&params](const Handler &h) {
             return h.handler(params).toBool();
         })) {
         return false;
     }
 
-    std::for_each(handlerList.begin(), handlerList.end(), [params](const EventHandler<Listener> &h) {
+    std::for_each(handlers.begin(), handlers.end(), [&params](const Handler &h) {
         h.handler(params);
     });
 
     return true;
 }
 
-QFuture<bool> EventDispatcher::asyncDispatch()
+EventDispatcherManager::EventDispatcherManager()
 {
-    return asyncDispatch(QVariantList());
 }
 
-QFuture<bool> EventDispatcher::asyncDispatch(const QVariantList &params)
+EventDispatcherManager::~EventDispatcherManager()
 {
-    return QFuture<bool>(QtConcurrent::run([this, params]() -> bool {
-        return this->dispatch(params);
-    }));
 }
 
 bool EventDispatcherManager::installGlobalEventFilter(QObject *obj, EventDispatcherManager::GlobalFilter filter)
@@ -47,16 +73,17 @@ bool EventDispatcherManager::installGlobalEventFilter(QObject *obj, EventDispatc
     Q_ASSERT(obj);
 
     QWriteLocker guard(&rwLock);
-    return globalFilterMap.insert(obj, filter) != globalFilterMap.end();
+    bool ret = globalFilterMap.insert(obj, filter) != globalFilterMap.end();
+    hasGlobalFilter = !globalFilterMap.isEmpty();
+    return ret;
 }
 
 bool EventDispatcherManager::removeGlobalEventFilter(QObject *obj)
 {
     QWriteLocker guard(&rwLock);
-    if (globalFilterMap.contains(obj))
-        return globalFilterMap.remove(obj) > 0;
-
-    return false;
+    bool ret = globalFilterMap.remove(obj) > 0;
+    hasGlobalFilter = !globalFilterMap.isEmpty();
+    return ret;
 }
 
 bool EventDispatcherManager::globalFiltered(EventType type, const QVariantList &params)
@@ -85,8 +112,29 @@ bool EventDispatcherManager::unsubscribe(const QString &space, const QString &to
 bool EventDispatcherManager::unsubscribe(EventType type)
 {
     QWriteLocker guard(&rwLock);
-    if (dispatcherMap.contains(type))
-        return dispatcherMap.remove(type) > 0;
+    if (!findDispatcher(type))
+        return false;
 
-    return false;
+    // a publishing thread may still be using the dispatcher, it is freed when that drops it
+    std::atomic_store(&pages[type / kPageSize].load()[type % kPageSize], DispatcherPtr());
+    return true;
+}
+
+EventDispatcher *EventDispatcherManager::ensureDispatcher(EventType type)
+{
+    // called with the write lock held
+    Q_ASSERT(isValidEventType(type));
+    if (auto dispatcher = findDispatcher(type))
+        return dispatcher.get();
+
+    DispatcherSlot *page = pages[type / kPageSize].load();
+    if (!page) {
+        pageStorage.emplace_back(new DispatcherSlot[kPageSize]());
+        page = pageStorage.back().get();
+        pages[type / kPageSize].store(page, std::memory_order_release);
+    }
+
+    DispatcherPtr dispatcher { std::make_shared<EventDispatcher>() };
+    std::atomic_store(&page[type % kPageSize], dispatcher);
+    return dispatcher.get();
 }
@@ -155,6 +155,8 @@ PluginMetaObject::PluginMetaObject(const PluginMetaObject &meta)
     d->depends = meta.depends();
     d->state = pluginState();
     d->plugin = plugin();
+    d->fileName = meta.d->fileName;
+    d->metaData = meta.d->metaData;
     d->loader = meta.d->loader;
 }
 /*!
@@ -174,6 +176,8 @@ PluginMetaObject &PluginMetaObject::operator=(const PluginMetaObject &meta)
     d->depends = meta.depends();
     d->state = pluginState();
     d->plugin = plugin();
+    d->fileName = meta.d->fileName;
+    d->metaData = meta.d->metaData;
     d->loader = meta.d->loader;
     return *this;
 }
@@ -190,7 +194,7 @@ bool PluginMetaObject::isVirtual() const
  */
 QString PluginMetaObject::fileName() const
 {
-    return d->loader->fileName();
+    return d->fileName;
 }
 
 /*!
@@ -0,0 +1,230 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "pluginindex.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPluginLoader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+#include <cstring>
+
+#include <sys/stat.h>
+
+DPF_BEGIN_NAMESPACE
+
+// increase it when the layout of the index changes
+static constexpr int kIndexVersion { 2 };
+
+namespace {
+inline constexpr char kVersionKey[] { "version" };
+inline constexpr char kDirsKey[] { "dirs" };
+inline constexpr char kPathKey[] { "path" };
+inline constexpr char kModifiedKey[] { "mtime" };
+inline constexpr char kChangedKey[] { "ctime" };
+inline constexpr char kInodeKey[] { "inode" };
+inline constexpr char kSizeKey[] { "size" };
+inline constexpr char kPluginsKey[] { "plugins" };
+inline constexpr char kMetaDataKey[] { "metaData" };
+
+qint64 modifiedTime(const QFileInfo &info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+qint64 nanoseconds(const struct timespec &time)
+{
+    return static_cast<qint64>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+// the nanoseconds and the inodes do not fit the double of json
+QJsonValue toJson(quint64 value)
+{
+    return QString::number(value);
+}
+
+quint64 fromJson(const QJsonValue &value)
+{
+    return value.toString().toULongLong();
+}
+}   // namespace
+
+PluginIndex::PluginIndex(const QString &indexFile)
+    : indexFile(indexFile)
+{
+    load();
+}
+
+/*!
+ * \brief the plugin files in dirPath, the metadata is read only for the new or changed files
+ */
+QList<PluginIndex::Entry> PluginIndex::entries(const QString &dirPath)
+{
+    const QString &path { QDir::cleanPath(dirPath) };
+    QFileInfo info(path);
+    if (!info.isDir())
+        return {};
+
+    Directory &dir = dirs[path];
+    const qint64 modified { modifiedTime(info) };
+    if (dir.modified != modified) {
+        // files were added, removed or renamed
+        dir.modified = modified;
+        rescan(path, &dir);
+        changed = true;
+        return dir.entries;
+    }
+
+    for (auto it = dir.entries.begin(); it != dir.entries.end();) {
+        if (!QFileInfo::exists(it->fileName)) {
+            it = dir.entries.erase(it);
+            changed = true;
+            continue;
+        }
+        changed = refresh(&*it) || changed;
+        ++it;
+    }
+    return dir.entries;
+}
+
+bool PluginIndex::save()
+{
+    if (readCount > 0)
+        qInfo() << "Read the metadata of" << readCount << "plugin files";
+    if (!changed || indexFile.isEmpty())
+        return true;
+
+    QJsonArray dirArray;
+    for (auto it = dirs.cbegin(); it != dirs.cend(); ++it) {
+        QJsonArray plugins;
+        for (const Entry &entry : it.value().entries) {
+            plugins.append(QJsonObject { { kPathKey, entry.fileName },
+                                         { kModifiedKey, toJson(static_cast<quint64>(entry.modified)) },
+                                         { kChangedKey, toJson(static_cast<quint64>(entry.changed)) },
+                                         { kInodeKey, toJson(entry.inode) },
+                                         { kSizeKey, entry.size },
+                                         { kMetaDataKey, entry.metaData } });
+        }
+        dirArray.append(QJsonObject { { kPathKey, it.key() },
+                                      { kModifiedKey, it.value().modified },
+                                      { kPluginsKey, plugins } });
+    }
+
+    QDir().mkpath(QFileInfo(indexFile).absolutePath());
+    QSaveFile file(indexFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write the plugin index:" << indexFile << file.errorString();
+        return false;
+    }
+
+    const QJsonObject root { { kVersionKey, kIndexVersion }, { kDirsKey, dirArray } };
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning() << "Failed to write the plugin index:" << indexFile << file.errorString();
+        return false;
+    }
+
+    changed = false;
+    return true;
+}
+
+QString PluginIndex::defaultIndexFile()
+{
+    const QString &cacheDir { QStandardPaths::writableLocation(QStandardPaths::CacheLocation) };
+    if (cacheDir.isEmpty())
+        return QString();
+    return cacheDir + "/dpf-plugin-index.json";
+}
+
+void PluginIndex::load()
+{
+    if (indexFile.isEmpty())
+        return;
+
+    QFile file(indexFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject &root { QJsonDocument::fromJson(file.readAll()).object() };
+    if (root.value(kVersionKey).toInt() != kIndexVersion) {
+        qInfo() << "Discard the plugin index of another version:" << indexFile;
+        return;
+    }
+
+    const QJsonArray &dirArray { root.value(kDirsKey).toArray() };
+    for (const QJsonValue &dirValue : dirArray) {
+        const QJsonObject &dirObject { dirValue.toObject() };
+        Directory dir;
+        dir.modified = static_cast<qint64>(dirObject.value(kModifiedKey).toDouble());
+        const QJsonArray &plugins { dirObject.value(kPluginsKey).toArray() };
+        for (const QJsonValue &pluginValue : plugins) {
+            const QJsonObject &pluginObject { pluginValue.toObject() };
+            Entry entry;
+            entry.fileName = pluginObject.value(kPathKey).toString();
+            entry.modified = static_cast<qint64>(fromJson(pluginObject.value(kModifiedKey)));
+            entry.changed = static_cast<qint64>(fromJson(pluginObject.value(kChangedKey)));
+            entry.inode = fromJson(pluginObject.value(kInodeKey));
+            entry.size = static_cast<qint64>(pluginObject.value(kSizeKey).toDouble());
+            entry.metaData = pluginObject.value(kMetaDataKey).toObject();
+            dir.entries.append(entry);
+        }
+        dirs.insert(dirObject.value(kPathKey).toString(), dir);
+    }
+}
+
+/*!
+ * \brief read the metadata of the entry again if its file changed, a file replaced by
+ * another one with the same mtime and size is found by its ctime and inode
+ * \return true if the entry is changed
+ */
+bool PluginIndex::refresh(Entry *entry)
+{
+    struct stat info;
+    if (::stat(QFile::encodeName(entry->fileName).constData(), &info) != 0)
+        memset(&info, 0, sizeof(info));
+
+    const qint64 modified { nanoseconds(info.st_mtim) };
+    const qint64 changed { nanoseconds(info.st_ctim) };
+    if (entry->modified == modified && entry->changed == changed
+        && entry->inode == info.st_ino && entry->size == info.st_size)
+        return false;
+
+    entry->modified = modified;
+    entry->changed = changed;
+    entry->inode = info.st_ino;
+    entry->size = info.st_size;
+    // QPluginLoader reads the metadata from the ELF of the file
+    entry->metaData = QPluginLoader(entry->fileName).metaData();
+    ++readCount;
+    return true;
+}
+
+void PluginIndex::rescan(const QString &dirPath, Directory *dir)
+{
+    QMap<QString, Entry> known;
+    for (const Entry &entry : dir->entries)
+        known.insert(entry.fileName, entry);
+
+    dir->entries.clear();
+    QDirIterator dirItera(dirPath, { "*.so" },
+                          QDir::Filter::Files,
+                          QDirIterator::IteratorFlag::NoIteratorFlags);
+    while (dirItera.hasNext()) {
+        dirItera.next();
+        Entry entry { known.value(dirItera.filePath()) };
+        entry.fileName = dirItera.filePath();
+        refresh(&entry);
+        dir->entries.append(entry);
+    }
+}
+
+DPF_END_NAMESPACE
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PLUGININDEX_H
+#define PLUGININDEX_H
+
+#include <dfm-framework/dfm_framework_global.h>
+
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+DPF_BEGIN_NAMESPACE
+
+/*!
+ * \brief The PluginIndex class keeps the metadata of the plugin files in a file under the
+ * cache dir, so that the metadata is read from the ELF of a plugin only when it is new or
+ * changed. A plugin dir is trusted while its mtime is unchanged, its files are only stat.
+ */
+class PluginIndex
+{
+    Q_DISABLE_COPY(PluginIndex)
+
+public:
+    struct Entry
+    {
+        QString fileName;
+        qint64 modified { 0 };   // the mtime and the ctime in nanoseconds
+        qint64 changed { 0 };
+        quint64 inode { 0 };
+        qint64 size { 0 };
+        QJsonObject metaData;   // the metadata of QPluginLoader, empty if the file is not a plugin
+    };
+
+    explicit PluginIndex(const QString &indexFile = defaultIndexFile());
+
+    QList<Entry> entries(const QString &dirPath);
+    bool save();
+
+    static QString defaultIndexFile();
+
+private:
+    struct Directory
+    {
+        qint64 modified { 0 };
+        QList<Entry> entries;
+    };
+
+    void load();
+    bool refresh(Entry *entry);
+    void rescan(const QString &dirPath, Directory *dir);
+
+private:
+    QString indexFile;
+    QMap<QString, Directory> dirs;
+    int readCount { 0 };
+    bool changed { false };
+};
+
+DPF_END_NAMESPACE
+
+#endif   // PLUGININDEX_H
@@ -4,12 +4,15 @@
 
 #include "pluginmetaobject_p.h"
 #include "pluginmanager_p.h"
+#include "pluginindex.h"
 
 #include <dfm-framework/listener/listener.h>
 #include <dfm-framework/lifecycle/plugin.h>
 #include <dfm-framework/lifecycle/plugincreator.h>
 #include <dfm-framework/log/codetimecheck.h>
 
+#include <QElapsedTimer>
+
 DPF_BEGIN_NAMESPACE
 
 namespace GlobalPrivate {
@@ -142,6 +145,7 @@ bool PluginManagerPrivate::readPlugins()
 
 /*!
  * \brief 扫描所有插件到目标队列
+ * \details the metadata comes from the plugin index, only the new or changed plugin files are read
  * \param destQueue
  * \param pluginPaths
  * \param pluginIID
@@ -157,29 +161,27 @@ void PluginManagerPrivate::scanfAllPlugin(QQueue<PluginMetaObjectPointer> *destQ
     if (pluginIIDs.isEmpty())
         return;
 
+    PluginIndex index;
     for (const QString &path : pluginPaths) {
-        QDirIterator dirItera(path, { "*.so" },
-                              QDir::Filter::Files,
-                              QDirIterator::IteratorFlag::NoIteratorFlags);
-
-        while (dirItera.hasNext()) {
-            dirItera.next();
-            PluginMetaObjectPointer metaObj(new PluginMetaObject);
-            const QString &fileName { dirItera.path() + "/" + dirItera.fileName() };
-            metaObj->d->loader->setFileName(fileName);
-            QJsonObject &&metaJson = metaObj->d->loader->metaData();
+        for (const PluginIndex::Entry &entry : index.entries(path)) {
+            const QJsonObject &metaJson = entry.metaData;
             QJsonObject &&dataJson = metaJson.value("MetaData").toObject();
             QString &&iid = metaJson.value("IID").toString();
             if (!pluginIIDs.contains(iid))
                 continue;
 
             bool isVirtual = dataJson.contains(kVirtualPluginMeta) && dataJson.contains(kVirtualPluginList);
-            if (isVirtual)
-                scanfVirtualPlugin(destQueue, fileName, dataJson, blackList);
-            else
+            if (isVirtual) {
+                scanfVirtualPlugin(destQueue, entry.fileName, metaJson, blackList);
+            } else {
+                PluginMetaObjectPointer metaObj(new PluginMetaObject);
+                metaObj->d->fileName = entry.fileName;
+                metaObj->d->metaData = metaJson;
                 scanfRealPlugin(destQueue, metaObj, dataJson, blackList);
+            }
         }
     }
+    index.save();
 
     dpfCheckTimeEnd();
 }
@@ -203,10 +205,11 @@ void PluginManagerPrivate::scanfRealPlugin(QQueue<PluginMetaObjectPointer> *dest
 }
 
 void PluginManagerPrivate::scanfVirtualPlugin(QQueue<PluginMetaObjectPointer> *destQueue, const QString &fileName,
-                                              const QJsonObject &dataJson, const QStringList &blackList)
+                                              const QJsonObject &metaJson, const QStringList &blackList)
 {
     Q_ASSERT(destQueue);
 
+    QJsonObject &&dataJson { metaJson.value("MetaData").toObject() };
     QJsonObject &&metaDataJson { dataJson.value(kVirtualPluginMeta).toObject() };
     QString &&realName { metaDataJson.value(kPluginName).toString() };
     if (blackList.contains(realName)) {
@@ -224,7 +227,8 @@ void PluginManagerPrivate::scanfVirtualPlugin(QQueue<PluginMetaObjectPointer> *d
         }
 
         PluginMetaObjectPointer metaObj(new PluginMetaObject);
-        metaObj->d->loader->setFileName(fileName);
+        metaObj->d->fileName = fileName;
+        metaObj->d->metaData = metaJson;
         metaObj->d->isVirtual = true;
         metaObj->d->realName = realName;
         metaObj->d->name = name;
@@ -243,7 +247,8 @@ void PluginManagerPrivate::readJsonToMeta(PluginMetaObjectPointer metaObject)
 
     metaObject->d->state = PluginMetaObject::kReading;
 
-    QJsonObject &&jsonObj = metaObject->d->loader->metaData();
+    QJsonObject &&jsonObj = metaObject->d->metaData.isEmpty() ? metaObject->d->pluginLoader()->metaData()
+                                                              : metaObject->d->metaData;
     if (jsonObj.isEmpty())
         return;
 
@@ -308,14 +313,20 @@ bool PluginManagerPrivate::loadPlugins()
 {
     dpfCheckTimeBegin();
 
+    QElapsedTimer timer;
+    timer.start();
     dependsSort(&loadQueue, &notLazyLoadQuene);
 
     bool ret = true;
     std::for_each(loadQueue.begin(), loadQueue.end(), [&ret, this](PluginMetaObjectPointer pointer) {
+        QElapsedTimer timer;
+        timer.start();
         if (!PluginManagerPrivate::doLoadPlugin(pointer))
             ret = false;
+        pointer->d->loadTime = timer.elapsed();
     });
 
+    loadPluginsTime = timer.elapsed();
     dpfCheckTimeEnd();
     return ret;
 }
@@ -327,12 +338,18 @@ bool PluginManagerPrivate::initPlugins()
 {
     dpfCheckTimeBegin();
 
+    QElapsedTimer timer;
+    timer.start();
     bool ret = true;
     std::for_each(loadQueue.begin(), loadQueue.end(), [&ret, this](PluginMetaObjectPointer pointer) {
+        QElapsedTimer timer;
+        timer.start();
         if (!PluginManagerPrivate::doInitPlugin(pointer))
             ret = false;
+        pointer->d->initTime = timer.elapsed();
     });
 
+    initPluginsTime = timer.elapsed();
     emit Listener::instance()->pluginsInitialized();
     allPluginsInitialized = true;
     dpfCheckTimeEnd();
@@ -347,12 +364,19 @@ bool PluginManagerPrivate::startPlugins()
 {
     dpfCheckTimeBegin();
 
+    QElapsedTimer timer;
+    timer.start();
     bool ret = true;
     std::for_each(loadQueue.begin(), loadQueue.end(), [&ret, this](PluginMetaObjectPointer pointer) {
+        QElapsedTimer timer;
+        timer.start();
         if (!PluginManagerPrivate::doStartPlugin(pointer))
             ret = false;
+        pointer->d->startTime = timer.elapsed();
     });
 
+    startPluginsTime = timer.elapsed();
+    reportStartup();
     emit Listener::instance()->pluginsStarted();
     allPluginsStarted = true;
     dpfCheckTimeEnd();
@@ -439,9 +463,10 @@ bool PluginManagerPrivate::doLoadPlugin(PluginMetaObjectPointer pointer)
     }
 
     pointer->d->state = PluginMetaObject::State::kLoading;
+    QPluginLoader *loader = pointer->d->pluginLoader();
 
     if (pointer->isVirtual() && loadedVirtualPlugins.contains(pointer->d->realName)) {
-        auto creator = qobject_cast<PluginCreator *>(pointer->d->loader->instance());
+        auto creator = qobject_cast<PluginCreator *>(loader->instance());
         if (creator)
             pointer->d->plugin = creator->create(pointer->name());
         pointer->d->state = PluginMetaObject::State::kLoaded;
@@ -449,22 +474,22 @@ bool PluginManagerPrivate::doLoadPlugin(PluginMetaObjectPointer pointer)
         return true;
     }
 
-    if (!pointer->d->loader->load()) {
-        pointer->d->error = "Failed load plugin: " + pointer->d->loader->errorString();
-        qCritical() << pointer->errorString() << pointer->d->name << pointer->d->loader->fileName();
+    if (!loader->load()) {
+        pointer->d->error = "Failed load plugin: " + loader->errorString();
+        qCritical() << pointer->errorString() << pointer->d->name << loader->fileName();
         return false;
     }
 
     // resolve loader instance
     bool isNullPluginInstance { false };
     if (pointer->isVirtual()) {
-        auto creator = qobject_cast<PluginCreator *>(pointer->d->loader->instance());
+        auto creator = qobject_cast<PluginCreator *>(loader->instance());
         if (creator)
             pointer->d->plugin = creator->create(pointer->name());
         else
             isNullPluginInstance = true;
     } else {
-        pointer->d->plugin = QSharedPointer<Plugin>(qobject_cast<Plugin *>(pointer->d->loader->instance()));
+        pointer->d->plugin = QSharedPointer<Plugin>(qobject_cast<Plugin *>(loader->instance()));
         if (pointer->d->plugin.isNull())
             isNullPluginInstance = true;
     }
@@ -477,7 +502,7 @@ bool PluginManagerPrivate::doLoadPlugin(PluginMetaObjectPointer pointer)
 
     // load success
     pointer->d->state = PluginMetaObject::State::kLoaded;
-    qInfo() << "Loaded plugin: " << pointer->d->name << pointer->d->loader->fileName();
+    qInfo() << "Loaded plugin: " << pointer->d->name << loader->fileName();
     if (pointer->isVirtual())
         loadedVirtualPlugins.push_back(pointer->d->realName);
 
@@ -630,4 +655,25 @@ bool PluginManagerPrivate::doPluginSort(const PluginDependGroup group, QMap<QStr
     return doPluginSort(nextGroup, nextSrc, dest);
 }
 
+void PluginManagerPrivate::reportStartup() const
+{
+    qInfo("Plugins startup: load %lld ms, initialize %lld ms, start %lld ms",
+          loadPluginsTime, initPluginsTime, startPluginsTime);
+
+    // the slowest plugins first
+    QList<PluginMetaObjectPointer> plugins(loadQueue);
+    auto cost = [](const PluginMetaObjectPointer &pointer) {
+        return pointer->d->loadTime + pointer->d->initTime + pointer->d->startTime;
+    };
+    std::stable_sort(plugins.begin(), plugins.end(), [&cost](const PluginMetaObjectPointer &a, const PluginMetaObjectPointer &b) {
+        return cost(a) > cost(b);
+    });
+
+    for (const PluginMetaObjectPointer &pointer : plugins) {
+        qInfo("    %s: load %lld ms, initialize %lld ms, start %lld ms",
+              qUtf8Printable(pointer->name()), pointer->d->loadTime, pointer->d->initTime,
+              pointer->d->startTime);
+    }
+}
+
 DPF_END_NAMESPACE
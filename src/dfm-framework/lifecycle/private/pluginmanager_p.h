@@ -40,6 +40,10 @@ class PluginManagerPrivate : public QSharedData
     QQueue<PluginMetaObjectPointer> loadQueue;
     bool allPluginsInitialized { false };
     bool allPluginsStarted { false };
+    // the wall time of loadPlugins, initPlugins and startPlugins, in milliseconds
+    qint64 loadPluginsTime { 0 };
+    qint64 initPluginsTime { 0 };
+    qint64 startPluginsTime { 0 };
 
 public:
     explicit PluginManagerPrivate(PluginManager *qq);
@@ -64,7 +68,7 @@ public:
     static void scanfRealPlugin(QQueue<PluginMetaObjectPointer> *destQueue, PluginMetaObjectPointer metaObj,
                                 const QJsonObject &dataJson, const QStringList &blackList);
     static void scanfVirtualPlugin(QQueue<PluginMetaObjectPointer> *destQueue, const QString &fileName,
-                                   const QJsonObject &dataJson, const QStringList &blackList);
+                                   const QJsonObject &metaJson, const QStringList &blackList);
     static void readJsonToMeta(PluginMetaObjectPointer metaObject);
     static void jsonToMeta(PluginMetaObjectPointer metaObject, const QJsonObject &metaData);
     static void dependsSort(QQueue<PluginMetaObjectPointer> *dstQueue,
@@ -79,6 +83,7 @@ private:
     static bool doPluginSort(const PluginDependGroup group,
                              QMap<QString, PluginMetaObjectPointer> src,
                              QQueue<PluginMetaObjectPointer> *dest);
+    void reportStartup() const;
 };
 
 DPF_END_NAMESPACE
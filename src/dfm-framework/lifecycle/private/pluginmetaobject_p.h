@@ -8,6 +8,7 @@
 #include <QString>
 #include <QStringList>
 #include <QSharedPointer>
+#include <QJsonObject>
 
 DPF_BEGIN_NAMESPACE
 
@@ -66,13 +67,26 @@ public:
     QString error;
     PluginMetaObject::State state;
     QList<PluginDepend> depends;
+    // the time spent to load, initialize and start the plugin, in milliseconds
+    qint64 loadTime { 0 };
+    qint64 initTime { 0 };
+    qint64 startTime { 0 };
     QSharedPointer<Plugin> plugin;
-    QSharedPointer<QPluginLoader> loader;
+    QString fileName;
+    QJsonObject metaData;   // the metadata of the loader, kept by the plugin index
+    QSharedPointer<QPluginLoader> loader;   // created when it is needed, it reads the ELF
 
     explicit PluginMetaObjectPrivate(PluginMetaObject *q)
-        : q(q), loader(new QPluginLoader(nullptr))
+        : q(q)
     {
     }
+
+    QPluginLoader *pluginLoader()
+    {
+        if (!loader)
+            loader.reset(new QPluginLoader(fileName));
+        return loader.data();
+    }
 };
 
 DPF_END_NAMESPACE
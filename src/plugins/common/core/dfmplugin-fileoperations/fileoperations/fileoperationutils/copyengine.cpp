@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "copyengine.h"
+
+#include <QDebug>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+// every call copies at most this size, so that the progress keeps moving and pause or stop is responsive
+static constexpr qint64 kKernelCopyChunk { 8 * 1024 * 1024 };
+
+namespace {
+// the errors which mean the way is not supported by the file systems or the kernel
+bool isUnsupported(int error)
+{
+    return error == EXDEV || error == EINVAL || error == EOPNOTSUPP || error == ENOTSUP
+            || error == ENOSYS || error == ENOTTY || error == EBADF || error == EPERM;
+}
+
+QPair<quint64, quint64> devicePair(int fromFd, int toFd)
+{
+    struct stat fromStat;
+    struct stat toStat;
+    if (fstat(fromFd, &fromStat) != 0 || fstat(toFd, &toStat) != 0)
+        return qMakePair(quint64(0), quint64(0));
+    return qMakePair(static_cast<quint64>(fromStat.st_dev), static_cast<quint64>(toStat.st_dev));
+}
+
+ssize_t copyFileRange(int fromFd, loff_t *fromOffset, int toFd, loff_t *toOffset, size_t length)
+{
+#ifdef SYS_copy_file_range
+    return syscall(SYS_copy_file_range, fromFd, fromOffset, toFd, toOffset, length, 0u);
+#else
+    Q_UNUSED(fromFd)
+    Q_UNUSED(fromOffset)
+    Q_UNUSED(toFd)
+    Q_UNUSED(toOffset)
+    Q_UNUSED(length)
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+}
+
+CopyEngine *CopyEngine::instance()
+{
+    static CopyEngine ins;
+    return &ins;
+}
+
+/*!
+ * \brief copy the data of fromFd to toFd which is empty, kFallback is returned
+ * only if nothing is written, so the caller can copy the file from the start.
+ */
+CopyEngine::Result CopyEngine::copy(int fromFd, int toFd, qint64 size, const Progress &progress, int *error)
+{
+    const auto &key = devicePair(fromFd, toFd);
+    Strategy current = cachedStrategy(key);
+    forever {
+        Result result = Result::kFallback;
+        Strategy next = Strategy::kUserSpace;
+        switch (current) {
+        case Strategy::kReflink:
+            result = doReflink(fromFd, toFd, size, progress, error);
+            next = Strategy::kCopyFileRange;
+            break;
+        case Strategy::kCopyFileRange:
+            result = doCopyFileRange(fromFd, toFd, size, progress, error);
+            next = Strategy::kSendfile;
+            break;
+        case Strategy::kSendfile:
+            result = doSendfile(fromFd, toFd, size, progress, error);
+            next = Strategy::kUserSpace;
+            break;
+        case Strategy::kUserSpace:
+            return Result::kFallback;
+        }
+
+        if (result != Result::kFallback)
+            return result;
+
+        demote(key, next);
+        current = next;
+    }
+}
+
+CopyEngine::Strategy CopyEngine::strategy(int fromFd, int toFd)
+{
+    return cachedStrategy(devicePair(fromFd, toFd));
+}
+
+CopyEngine::Strategy CopyEngine::cachedStrategy(const QPair<quint64, quint64> &key)
+{
+    QReadLocker lk(&lock);
+    return strategies.value(key, Strategy::kReflink);
+}
+
+void CopyEngine::demote(const QPair<quint64, quint64> &key, Strategy next)
+{
+    QWriteLocker lk(&lock);
+    // another thread may have demoted it further
+    if (strategies.value(key, Strategy::kReflink) < next) {
+        qInfo() << "kernel copy strategy of device" << key.first << "to" << key.second << "changed to" << static_cast<int>(next);
+        strategies.insert(key, next);
+    }
+}
+
+CopyEngine::Result CopyEngine::doReflink(int fromFd, int toFd, qint64 size, const Progress &progress, int *error)
+{
+#ifdef FICLONE
+    if (ioctl(toFd, FICLONE, fromFd) == 0) {
+        // the clone is done at once, the progress is reported in one step
+        if (progress && !progress(size))
+            return Result::kStopped;
+        return Result::kDone;
+    }
+
+    if (!isUnsupported(errno)) {
+        if (error)
+            *error = errno;
+        return Result::kError;
+    }
+#else
+    Q_UNUSED(fromFd)
+    Q_UNUSED(toFd)
+    Q_UNUSED(size)
+    Q_UNUSED(progress)
+    Q_UNUSED(error)
+#endif
+    return Result::kFallback;
+}
+
+CopyEngine::Result CopyEngine::doCopyFileRange(int fromFd, int toFd, qint64 size, const Progress &progress, int *error)
+{
+    loff_t fromOffset = 0;
+    loff_t toOffset = 0;
+    while (fromOffset < size) {
+        const size_t length = static_cast<size_t>(qMin(kKernelCopyChunk, size - fromOffset));
+        const ssize_t copied = copyFileRange(fromFd, &fromOffset, toFd, &toOffset, length);
+        if (copied < 0) {
+            if (errno == EINTR)
+                continue;
+            if (fromOffset == 0 && isUnsupported(errno))
+                return Result::kFallback;
+            if (error)
+                *error = errno;
+            return Result::kError;
+        }
+
+        // nothing can be copied from some virtual files, the source file may also be truncated meanwhile
+        if (copied == 0) {
+            if (fromOffset == 0)
+                return Result::kFallback;
+            break;
+        }
+
+        if (progress && !progress(copied))
+            return Result::kStopped;
+    }
+
+    return Result::kDone;
+}
+
+CopyEngine::Result CopyEngine::doSendfile(int fromFd, int toFd, qint64 size, const Progress &progress, int *error)
+{
+    off_t offset = 0;
+    while (offset < size) {
+        const size_t length = static_cast<size_t>(qMin(kKernelCopyChunk, size - offset));
+        const ssize_t copied = sendfile(toFd, fromFd, &offset, length);
+        if (copied < 0) {
+            if (errno == EINTR)
+                continue;
+            if (offset == 0 && isUnsupported(errno))
+                return Result::kFallback;
+            if (error)
+                *error = errno;
+            return Result::kError;
+        }
+
+        if (copied == 0) {
+            if (offset == 0)
+                return Result::kFallback;
+            break;
+        }
+
+        if (progress && !progress(copied))
+            return Result::kStopped;
+    }
+
+    return Result::kDone;
+}
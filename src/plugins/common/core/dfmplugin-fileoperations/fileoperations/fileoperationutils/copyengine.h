@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef COPYENGINE_H
+#define COPYENGINE_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QHash>
+#include <QPair>
+#include <QReadWriteLock>
+
+#include <functional>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+
+/*!
+ * \brief The CopyEngine class copies the data of local files in the kernel. It tries
+ * FICLONE, copy_file_range and sendfile in order, the first one which works for a
+ * (source fs, target fs) pair is remembered, so later files go to it directly.
+ */
+class CopyEngine
+{
+    Q_DISABLE_COPY(CopyEngine)
+
+public:
+    enum class Strategy : quint8 {
+        kReflink,
+        kCopyFileRange,
+        kSendfile,
+        kUserSpace,   // none of the kernel ways works, copy by read and write
+    };
+
+    enum class Result : quint8 {
+        kDone,
+        kFallback,   // nothing is copied, use the user space copy instead
+        kError,
+        kStopped,
+    };
+
+    // called with the size copied every time, returns false to stop copying
+    using Progress = std::function<bool(qint64)>;
+
+    static CopyEngine *instance();
+
+    Result copy(int fromFd, int toFd, qint64 size, const Progress &progress, int *error = nullptr);
+    Strategy strategy(int fromFd, int toFd);
+
+private:
+    CopyEngine() = default;
+
+    Strategy cachedStrategy(const QPair<quint64, quint64> &key);
+    void demote(const QPair<quint64, quint64> &key, Strategy next);
+
+    Result doReflink(int fromFd, int toFd, qint64 size, const Progress &progress, int *error);
+    Result doCopyFileRange(int fromFd, int toFd, qint64 size, const Progress &progress, int *error);
+    Result doSendfile(int fromFd, int toFd, qint64 size, const Progress &progress, int *error);
+
+private:
+    QReadWriteLock lock;
+    QHash<QPair<quint64, quint64>, Strategy> strategies;
+};
+
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // COPYENGINE_H
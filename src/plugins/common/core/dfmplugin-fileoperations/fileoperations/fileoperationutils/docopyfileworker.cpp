@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "docopyfileworker.h"
+#include "copyengine.h"
 #include "utils/fileutils.h"
 
 #include <dfm-io/core/diofactory.h>
@@ -14,10 +15,13 @@
 #include <QWaitCondition>
 #include <QMutex>
 #include <QThread>
+#include <QScopedPointer>
 
 #include <fcntl.h>
+#include <unistd.h>
 #include <zlib.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
 static const quint32 kMaxBufferLength { 1024 * 1024 * 1 };
 
@@ -70,6 +74,41 @@ void DoCopyFileWorker::doFileCopy(const AbstractFileInfoPointer fromInfo, const
     doCopyFilePractically(fromInfo, toInfo, nullptr);
     workData->completeFileCount++;
 }
+/*!
+ * \brief DoCopyFileWorker::doFileCopyBatch Copy a batch of small local files, the
+ * directories are opened once for the batch and the target files are notified together
+ * \param files the source and target file information of the files
+ */
+void DoCopyFileWorker::doFileCopyBatch(const QList<QPair<AbstractFileInfoPointer, AbstractFileInfoPointer>> &files)
+{
+    if (files.isEmpty() || isStopped())
+        return;
+
+    emit currentTask(files.first().first->urlOf(UrlInfoType::kUrl), files.first().second->urlOf(UrlInfoType::kUrl));
+
+    QHash<QString, int> dirFds;
+    QScopedArrayPointer<char> buffer(new char[kMaxBufferLength]);
+    QList<QUrl> addedUrls;
+    for (const auto &file : files) {
+        if (isStopped())
+            break;
+
+        if (doSmallFileCopy(file.first, file.second, &dirFds, buffer.data(), kMaxBufferLength))
+            addedUrls.append(file.second->urlOf(UrlInfoType::kUrl));
+        else if (isStopped())
+            break;
+        else
+            doCopyFilePractically(file.first, file.second, nullptr);
+        workData->completeFileCount++;
+    }
+
+    for (const int fd : dirFds) {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    FileUtils::notifyFilesChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType::kFileAdded, addedUrls);
+}
 
 void DoCopyFileWorker::writeExblockFile()
 {
@@ -325,35 +364,42 @@ bool DoCopyFileWorker::doCopyFilePractically(const AbstractFileInfoPointer fromI
     // resize target file
     if (workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyResizeDestinationFile) && !resizeTargetFile(fromInfo, toInfo, toDevice, skip))
         return false;
+    // 优先在内核中拷贝
+    bool kernelCopied = false;
+    if (!doKernelCopyFile(fromInfo, toInfo, &kernelCopied, skip))
+        return false;
+
     // 循环读取和写入文件，拷贝
     qint64 blockSize = fromInfo->size() > kMaxBufferLength ? kMaxBufferLength : fromInfo->size();
-    char *data = new char[static_cast<uint>(blockSize + 1)];
     uLong sourceCheckSum = adler32(0L, nullptr, 0);
-    qint64 sizeRead = 0;
+    if (!kernelCopied) {
+        char *data = new char[static_cast<uint>(blockSize + 1)];
+        qint64 sizeRead = 0;
 
-    do {
-        if (!doReadFile(fromInfo, toInfo, fromDevice, data, blockSize, sizeRead, skip)) {
-            delete[] data;
-            data = nullptr;
-            return false;
-        }
+        do {
+            if (!doReadFile(fromInfo, toInfo, fromDevice, data, blockSize, sizeRead, skip)) {
+                delete[] data;
+                data = nullptr;
+                return false;
+            }
 
-        if (!doWriteFile(fromInfo, toInfo, toDevice, data, sizeRead, skip)) {
-            delete[] data;
-            data = nullptr;
-            return false;
-        }
+            if (!doWriteFile(fromInfo, toInfo, toDevice, data, sizeRead, skip)) {
+                delete[] data;
+                data = nullptr;
+                return false;
+            }
 
-        if (Q_LIKELY(workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))) {
-            sourceCheckSum = adler32(sourceCheckSum, reinterpret_cast<Bytef *>(data), static_cast<uInt>(sizeRead));
-        }
+            if (Q_LIKELY(workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))) {
+                sourceCheckSum = adler32(sourceCheckSum, reinterpret_cast<Bytef *>(data), static_cast<uInt>(sizeRead));
+            }
 
-        toInfo->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardSize, toDevice->size());
+            toInfo->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardSize, toDevice->size());
 
-    } while (fromDevice->pos() != fromInfo->size());
+        } while (fromDevice->pos() != fromInfo->size());
 
-    delete[] data;
-    data = nullptr;
+        delete[] data;
+        data = nullptr;
+    }
 
     // 对文件加权
     setTargetPermissions(fromInfo, toInfo);
@@ -610,6 +656,190 @@ bool DoCopyFileWorker::resizeTargetFile(const AbstractFileInfoPointer &fromInfo,
     return true;
 }
 
+/*!
+ * \brief DoCopyFileWorker::doKernelCopyFile Copy the data of local files in the kernel
+ * \param fromInfo File information of source file
+ * \param toInfo File information of target file, it has been opened and truncated
+ * \param done Output parameter: whether the data has been copied
+ * \param skip Output parameter: whether skip
+ * \return false if the copy is stopped or the error is not retried, done is false
+ * and true is returned when the normal copy should be used
+ */
+bool DoCopyFileWorker::doKernelCopyFile(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
+                                        bool *done, bool *skip)
+{
+    *done = false;
+    // the data does not pass through user space, so integrity checking needs the normal copy,
+    // and the devices synchronized on every write are kept on it too
+    if (workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking) || workData->needSyncEveryRW)
+        return true;
+
+    const QUrl &fromUrl = fromInfo->urlOf(UrlInfoType::kUrl);
+    const QUrl &toUrl = toInfo->urlOf(UrlInfoType::kUrl);
+    if (!fromUrl.isLocalFile() || !toUrl.isLocalFile())
+        return true;
+
+    const int fromFd = open(fromUrl.path().toUtf8().toStdString().data(), O_RDONLY | O_CLOEXEC);
+    if (fromFd < 0)
+        return true;
+    const int toFd = open(toUrl.path().toUtf8().toStdString().data(), O_WRONLY | O_CLOEXEC);
+    if (toFd < 0) {
+        close(fromFd);
+        return true;
+    }
+
+    int error = 0;
+    qint64 copiedSize = 0;
+    const auto result = CopyEngine::instance()->copy(fromFd, toFd, fromInfo->size(), [this, &copiedSize](qint64 size) {
+        copiedSize += size;
+        workData->currentWriteSize += size;
+        return stateCheck();
+    }, &error);
+    close(fromFd);
+    close(toFd);
+
+    switch (result) {
+    case CopyEngine::Result::kDone:
+        *done = true;
+        return true;
+    case CopyEngine::Result::kFallback:
+        return true;
+    case CopyEngine::Result::kStopped:
+        return false;
+    case CopyEngine::Result::kError:
+        break;
+    }
+
+    // the file is copied again from the start if retried
+    workData->currentWriteSize -= copiedSize;
+    const QString &errorMsg = QString::fromLocal8Bit(strerror(error));
+    qWarning() << "kernel copy error, url from: " << fromUrl << " url to: " << toUrl
+               << " error code: " << error << " error msg: " << errorMsg;
+    AbstractJobHandler::SupportAction action = doHandleErrorAndWait(fromUrl, toUrl, AbstractJobHandler::JobErrorType::kWriteError,
+                                                                    true, errorMsg);
+    checkRetry();
+    if (action == AbstractJobHandler::SupportAction::kRetryAction && !isStopped())
+        return true;
+
+    actionOperating(action, fromInfo->size(), skip);
+    return false;
+}
+
+/*!
+ * \brief DoCopyFileWorker::doSmallFileCopy Copy a small local file with the file
+ * descriptors opened relative to the cached directories
+ * \param fromInfo File information of source file
+ * \param toInfo File information of target file
+ * \param dirFds the directory file descriptors of the batch
+ * \param buffer Data buffer used if the file can not be copied in the kernel
+ * \param bufferSize Data buffer size
+ * \return false if the file should be copied by doCopyFilePractically, which
+ * handles the errors, or if the copy is stopped, the partial target is removed then
+ */
+bool DoCopyFileWorker::doSmallFileCopy(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
+                                       QHash<QString, int> *dirFds, char *buffer, const qint64 bufferSize)
+{
+    if (workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking) || workData->needSyncEveryRW)
+        return false;
+
+    const QUrl &fromUrl = fromInfo->urlOf(UrlInfoType::kUrl);
+    const QUrl &toUrl = toInfo->urlOf(UrlInfoType::kUrl);
+    if (!fromUrl.isLocalFile() || !toUrl.isLocalFile())
+        return false;
+
+    auto openAt = [dirFds](const QString &path, const int flags) {
+        const int index = path.lastIndexOf('/');
+        if (index < 0)
+            return -1;
+        const QString &dirPath = index > 0 ? path.left(index) : QStringLiteral("/");
+        auto it = dirFds->constFind(dirPath);
+        // the failed directory is cached too, its files go to the normal copy
+        if (it == dirFds->constEnd())
+            it = dirFds->insert(dirPath, open(dirPath.toUtf8().constData(), O_PATH | O_DIRECTORY | O_CLOEXEC));
+        if (it.value() < 0)
+            return -1;
+        return openat(it.value(), path.mid(index + 1).toUtf8().constData(), flags, 0600);
+    };
+
+    const int fromFd = openAt(fromUrl.path(), O_RDONLY | O_CLOEXEC);
+    if (fromFd < 0)
+        return false;
+    struct stat fromStat;
+    if (fstat(fromFd, &fromStat) != 0 || !S_ISREG(fromStat.st_mode)) {
+        close(fromFd);
+        return false;
+    }
+    const int toFd = openAt(toUrl.path(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC);
+    if (toFd < 0) {
+        close(fromFd);
+        return false;
+    }
+
+    qint64 copiedSize = 0;
+    auto progress = [this, &copiedSize](qint64 size) {
+        copiedSize += size;
+        workData->currentWriteSize += size;
+        return stateCheck();
+    };
+    auto result = fromStat.st_size > 0
+            ? CopyEngine::instance()->copy(fromFd, toFd, fromStat.st_size, progress)
+            : CopyEngine::Result::kDone;
+    if (result == CopyEngine::Result::kFallback) {
+        result = CopyEngine::Result::kDone;
+        while (result == CopyEngine::Result::kDone) {
+            const ssize_t sizeRead = read(fromFd, buffer, static_cast<size_t>(bufferSize));
+            if (sizeRead == 0)
+                break;
+            if (sizeRead < 0) {
+                if (errno != EINTR)
+                    result = CopyEngine::Result::kError;
+                continue;
+            }
+
+            ssize_t sizeWrite = 0;
+            while (sizeWrite < sizeRead) {
+                const ssize_t size = write(toFd, buffer + sizeWrite, static_cast<size_t>(sizeRead - sizeWrite));
+                if (size < 0 && errno == EINTR)
+                    continue;
+                if (size <= 0) {
+                    result = CopyEngine::Result::kError;
+                    break;
+                }
+                sizeWrite += size;
+            }
+            if (result == CopyEngine::Result::kDone && !progress(sizeRead))
+                result = CopyEngine::Result::kStopped;
+        }
+    }
+
+    if (result == CopyEngine::Result::kDone) {
+        //权限为0000时，源文件已经被删除，无需修改新建的文件的权限为0000
+        if (fromStat.st_mode & 0777)
+            fchmod(toFd, fromStat.st_mode & 0777);
+        const struct timespec times[2] { fromStat.st_atim, fromStat.st_mtim };
+        futimens(toFd, times);
+        if (fromStat.st_size <= 0)
+            workData->zeroOrlinkOrDirWriteSize += FileUtils::getMemoryPageSize();
+    }
+    close(fromFd);
+    close(toFd);
+
+    // the file is copied again from the start by the normal copy, which reports the error
+    if (result == CopyEngine::Result::kError) {
+        workData->currentWriteSize -= copiedSize;
+        return false;
+    }
+
+    if (result == CopyEngine::Result::kStopped) {
+        workData->currentWriteSize -= copiedSize;
+        if (unlink(toUrl.path().toUtf8().constData()) != 0)
+            qWarning() << "remove the partial file failed: " << toUrl << strerror(errno);
+        return false;
+    }
+
+    return true;
+}
+
 /*!
  * \brief FileOperateBaseWorker::doReadFile  Read file contents
  * \param fromUrl URL of the source file
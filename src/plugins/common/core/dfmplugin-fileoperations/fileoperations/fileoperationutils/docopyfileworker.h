@@ -45,6 +45,7 @@ public:
     bool doCopyFilePractically(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo,
                                bool *skip);
     void doFileCopy(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo);
+    void doFileCopyBatch(const QList<QPair<AbstractFileInfoPointer, AbstractFileInfoPointer>> &files);
     void readExblockFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo);
     void writeExblockFile();
     void doMemcpyLocalBigFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, char *dest, char *source, size_t size);
@@ -82,6 +83,10 @@ private:   // file copy
                   bool *skip);
     bool resizeTargetFile(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
                           const QSharedPointer<DFMIO::DFile> &file, bool *skip);
+    bool doKernelCopyFile(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
+                          bool *done, bool *skip);
+    bool doSmallFileCopy(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
+                         QHash<QString, int> *dirFds, char *buffer, const qint64 bufferSize);
     bool doReadFile(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
                     const QSharedPointer<DFMIO::DFile> &fromDevice,
                     char *data, const qint64 &blockSize, qint64 &readSize, bool *skip);
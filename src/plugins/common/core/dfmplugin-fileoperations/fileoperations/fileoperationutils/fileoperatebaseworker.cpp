@@ -4,6 +4,7 @@
 
 #include "fileoperatebaseworker.h"
 #include "fileoperations/fileoperationutils/fileoperationsutils.h"
+#include "fileoperations/fileoperationutils/copyengine.h"
 #include "fileoperations/copyfiles/storageinfo.h"
 #include "workerdata.h"
 
@@ -33,6 +34,9 @@
 #include <sys/mman.h>
 
 constexpr uint32_t kBigFileSize { 300 * 1024 * 1024 };
+constexpr qint64 kSmallFileSize { 1024 * 1024 };
+constexpr int kSmallFileBatchCount { 64 };
+constexpr int kLargeFileLaneCount { 2 };
 
 DPFILEOPERATIONS_USE_NAMESPACE
 USING_IO_NAMESPACE
@@ -635,13 +639,14 @@ bool FileOperateBaseWorker::checkAndCopyDir(const AbstractFileInfoPointer &fromI
 
 void FileOperateBaseWorker::waitThreadPoolOver()
 {
+    flushSmallFileBatch();
     // wait all thread start
     if (!isStopped() && threadPool) {
         QThread::msleep(10);
     }
     bool isExBlockWriteOverFlag = false;
     // wait thread pool copy local file or copy big file over
-    while (!isStopped() && threadPool && threadPool->activeThreadCount() > 0) {
+    while (!isStopped() && threadPool && (threadPool->activeThreadCount() > 0 || (largeFileThreadPool && largeFileThreadPool->activeThreadCount() > 0))) {
         if (isTargetFileExBlock && workData->blockCopyInfoQueue.size() == 0 && threadPool->activeThreadCount() == 1 && !isExBlockWriteOverFlag) {
             // do last block file write
             isExBlockWriteOverFlag = true;
@@ -686,7 +691,8 @@ void FileOperateBaseWorker::setSkipValue(bool *skip, AbstractJobHandler::Support
 
 void FileOperateBaseWorker::initThreadCopy()
 {
-    for (int i = 0; i < threadCount; i++) {
+    // the workers after threadCount are the lanes of the large files
+    for (int i = 0; i < threadCount + kLargeFileLaneCount; i++) {
         QSharedPointer<DoCopyFileWorker> copy(new DoCopyFileWorker(workData));
         // todo init new
         connect(copy.data(), &DoCopyFileWorker::errorNotify, this, &FileOperateBaseWorker::emitErrorNotify, Qt::DirectConnection);
@@ -698,6 +704,8 @@ void FileOperateBaseWorker::initThreadCopy()
 
     threadPool.reset(new QThreadPool);
     threadPool->setMaxThreadCount(threadCount);
+    largeFileThreadPool.reset(new QThreadPool);
+    largeFileThreadPool->setMaxThreadCount(kLargeFileLaneCount);
 }
 
 void FileOperateBaseWorker::initSignalCopyWorker()
@@ -725,12 +733,32 @@ bool FileOperateBaseWorker::doCopyLocalFile(const AbstractFileInfoPointer fromIn
     if (!stateCheck())
         return false;
 
+    // large files are copied in their own lanes, so that they do not hold the small files behind them
+    if (fromInfo->size() > kSmallFileSize) {
+        QtConcurrent::run(largeFileThreadPool.data(), threadCopyWorker[threadCount + largeFileCopyCount % kLargeFileLaneCount].data(),
+                          static_cast<void (DoCopyFileWorker::*)(const AbstractFileInfoPointer, const AbstractFileInfoPointer)>(&DoCopyFileWorker::doFileCopy),
+                          fromInfo, toInfo);
+        largeFileCopyCount++;
+        return true;
+    }
+
+    smallFileBatch.append(qMakePair(fromInfo, toInfo));
+    if (smallFileBatch.size() >= kSmallFileBatchCount)
+        flushSmallFileBatch();
+
+    return true;
+}
+
+void FileOperateBaseWorker::flushSmallFileBatch()
+{
+    if (smallFileBatch.isEmpty() || !threadPool)
+        return;
+
     QtConcurrent::run(threadPool.data(), threadCopyWorker[threadCopyFileCount % threadCount].data(),
-                      static_cast<void (DoCopyFileWorker::*)(const AbstractFileInfoPointer, const AbstractFileInfoPointer)>(&DoCopyFileWorker::doFileCopy),
-                      fromInfo, toInfo);
+                      &DoCopyFileWorker::doFileCopyBatch, smallFileBatch);
+    smallFileBatch.clear();
 
     threadCopyFileCount++;
-    return true;
 }
 
 bool FileOperateBaseWorker::doCopyLocalBigFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, bool *skip)
@@ -745,6 +773,31 @@ bool FileOperateBaseWorker::doCopyLocalBigFile(const AbstractFileInfoPointer fro
         close(fromFd);
         return false;
     }
+    // copy in the kernel if possible, mmap is the fallback
+    if (!workData->needSyncEveryRW && ftruncate(toFd, 0) == 0) {
+        int error = 0;
+        qint64 copiedSize = 0;
+        const auto result = CopyEngine::instance()->copy(fromFd, toFd, fromInfo->size(), [this, &copiedSize](qint64 size) {
+            copiedSize += size;
+            workData->currentWriteSize += size;
+            return stateCheck();
+        }, &error);
+
+        if (result == CopyEngine::Result::kDone || result == CopyEngine::Result::kStopped) {
+            close(fromFd);
+            close(toFd);
+            if (result == CopyEngine::Result::kStopped)
+                return false;
+            setTargetPermissions(fromInfo, toInfo);
+            return true;
+        }
+
+        if (result == CopyEngine::Result::kError) {
+            qWarning() << "kernel copy error, fallback to mmap, url from: " << fromInfo->urlOf(UrlInfoType::kUrl)
+                       << " url to: " << toInfo->urlOf(UrlInfoType::kUrl) << " error msg: " << strerror(error);
+            workData->currentWriteSize -= copiedSize;
+        }
+    }
     // resize target file
     if (!doCopyLocalBigFileResize(fromInfo, toInfo, toFd, skip)) {
         close(fromFd);
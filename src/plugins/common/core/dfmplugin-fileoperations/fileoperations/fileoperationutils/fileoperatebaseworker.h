@@ -93,6 +93,7 @@ private:
                              bool *skip, bool isCountSize = false);
     QUrl createNewTargetUrl(const AbstractFileInfoPointer &toInfo, const QString &fileName);
     bool doCopyLocalFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo);
+    void flushSmallFileBatch();
     bool doCopyExBlockFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo);
     bool doCopyOtherFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, bool *skip);
     bool doCopyLocalBigFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, bool *skip);
@@ -143,6 +144,9 @@ protected:
     DirPermissonList dirPermissonList;   // dir set Permisson list
 
     std::atomic_int threadCopyFileCount { 0 };
+    std::atomic_int largeFileCopyCount { 0 };
+    QList<QPair<AbstractFileInfoPointer, AbstractFileInfoPointer>> smallFileBatch;   // small files waiting to be copied together
+    QSharedPointer<QThreadPool> largeFileThreadPool { nullptr };   // large files are copied here, not blocking small files
 };
 DPFILEOPERATIONS_END_NAMESPACE
 
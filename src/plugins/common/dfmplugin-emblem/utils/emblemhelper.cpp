@@ -14,29 +14,85 @@
 #include <dfm-io/core/dfileinfo.h>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QStandardPaths>
 
+#include <limits>
+
 USING_IO_NAMESPACE
 DFMBASE_USE_NAMESPACE
 DPF_USE_NAMESPACE
 DPEMBLEM_USE_NAMESPACE
 
-void EmblemWorker::onProduce(const QUrl &url)
+static constexpr quint64 kStatisticBatches { 100 };
+static constexpr quint64 kStatisticLookups { 10000 };
+
+EmblemIconTable &EmblemIconTable::instance()
 {
-    Q_ASSERT(qApp->thread() != QThread::currentThread());
+    static EmblemIconTable ins;
+    return ins;
+}
+
+qint16 EmblemIconTable::intern(const QString &path)
+{
+    {
+        QReadLocker locker(&lock);
+        auto it = ids.constFind(path);
+        if (it != ids.constEnd())
+            return it.value();
+    }
 
-    const auto &emblems { fetchEmblems(url) };
+    QWriteLocker locker(&lock);
+    auto it = ids.constFind(path);
+    if (it != ids.constEnd())
+        return it.value();
+    // the custom emblems are few, a table that is full just stops taking new ones
+    if (paths.size() >= std::numeric_limits<qint16>::max())
+        return -1;
+
+    const qint16 id = static_cast<qint16>(paths.size());
+    paths.append(path);
+    ids.insert(path, id);
+    return id;
+}
+
+QString EmblemIconTable::path(qint16 id) const
+{
+    QReadLocker locker(&lock);
+    return paths.value(id);
+}
+
+void EmblemWorker::onProduce(const QList<QUrl> &urls)
+{
+    Q_ASSERT(qApp->thread() != QThread::currentThread());
 
-    if (cache.contains(url)) {
-        const auto &old { cache.value(url) };
-        if (!iconNamesEqual(old, emblems)) {
-            cache[url] = emblems;
-            emit emblemChanged(url, emblems);
+    QElapsedTimer timer;
+    timer.start();
+
+    // the shared paths are fetched once for the batch instead of once for every url
+    const QSet<QString> &sharedPaths { fetchSharedPaths() };
+    ProductQueue changed;
+    for (const QUrl &url : urls) {
+        const Product &emblems { fetchEmblems(url, &sharedPaths) };
+        auto it = cache.find(url);
+        if (it == cache.end()) {   // save to cache
+            cache.insert(url, emblems);
+            changed.insert(url, emblems);
+        } else if (it.value() != emblems) {
+            it.value() = emblems;
+            changed.insert(url, emblems);
         }
-    } else {   // save to cache
-        cache.insert(url, emblems);
-        emit emblemChanged(url, emblems);
     }
+
+    if (!changed.isEmpty())
+        emit emblemChanged(changed);
+
+    const quint64 count = ++batches;
+    batchUrls += static_cast<quint64>(urls.size());
+    batchTime += static_cast<quint64>(timer.nsecsElapsed() / 1000);
+    if (count % kStatisticBatches == 0)
+        qDebug() << "emblem batches:" << count << "urls:" << batchUrls.load()
+                 << "average latency(us):" << batchTime.load() / count;
 }
 
 void EmblemWorker::onClear()
@@ -44,125 +100,89 @@ void EmblemWorker::onClear()
     cache.clear();
 }
 
-QList<QIcon> EmblemWorker::fetchEmblems(const QUrl &url) const
+Product EmblemWorker::fetchEmblems(const QUrl &url, const QSet<QString> *sharedPaths) const
 {
     AbstractFileInfoPointer info = InfoFactory::create<AbstractFileInfo>(url);
     if (!info)
         return {};
 
-    QList<QIcon> emblemList;
-
-    emblemList = getSystemEmblems(info);
+    Product emblems;
+    emblems.systemEmblems = getSystemEmblems(info, sharedPaths);
 
     if (FileUtils::isGvfsFile(url))
-        return emblemList;
+        return emblems;
 
     // add gio emblem icons
-    const auto &gioEmblemsMap = getGioEmblems(info);
-    QMap<int, QIcon>::const_iterator iter = gioEmblemsMap.begin();
-    while (iter != gioEmblemsMap.end()) {
-        if (iter.key() == emblemList.count()) {
-            emblemList.append(iter.value());
-            ++iter;
-            continue;
-        }
-
-        if (iter.key() > emblemList.count()) {
-            emblemList.append(QIcon());
-            continue;
-        }
-
-        if (emblemList.at(iter.key()).isNull())
-            emblemList.replace(iter.key(), iter.value());
-
-        ++iter;
-    }
+    getGioEmblems(url, &emblems);
+    return emblems;
+}
 
-    return emblemList;
+QSet<QString> EmblemWorker::fetchSharedPaths() const
+{
+    QSet<QString> paths;
+    const auto &shares = dpfSlotChannel->push("dfmplugin_dirshare", "slot_Share_AllShareInfos").value<QList<QVariantMap>>();
+    for (const auto &share : shares)
+        paths.insert(share.value("path").toString());
+    return paths;
 }
 
-QList<QIcon> EmblemWorker::getSystemEmblems(const AbstractFileInfoPointer &info) const
+quint8 EmblemWorker::getSystemEmblems(const AbstractFileInfoPointer &info, const QSet<QString> *sharedPaths) const
 {
-    QList<QIcon> emblems;
+    auto bit = [](SystemEmblemType type) {
+        return static_cast<quint8>(1 << static_cast<int>(type));
+    };
+
+    quint8 emblems = 0;
 
     if (info->isAttributes(OptInfoType::kIsSymLink))
-        emblems << QIcon::fromTheme("emblem-symbolic-link", standardEmblem(SystemEmblemType::kLink));
+        emblems |= bit(SystemEmblemType::kLink);
 
     if (!info->isAttributes(OptInfoType::kIsWritable))
-        emblems << QIcon::fromTheme("emblem-readonly", standardEmblem(SystemEmblemType::kLock));
+        emblems |= bit(SystemEmblemType::kLock);
 
     if (!info->isAttributes(OptInfoType::kIsReadable))
-        emblems << QIcon::fromTheme("emblem-unreadable", standardEmblem(SystemEmblemType::kUnreadable));
+        emblems |= bit(SystemEmblemType::kUnreadable);
 
-    bool shared = dpfSlotChannel->push("dfmplugin_dirshare", "slot_Share_IsPathShared", info->pathOf(PathInfoType::kAbsoluteFilePath)).toBool();
+    const QString &path = info->pathOf(PathInfoType::kAbsoluteFilePath);
+    bool shared = sharedPaths ? sharedPaths->contains(path)
+                              : dpfSlotChannel->push("dfmplugin_dirshare", "slot_Share_IsPathShared", path).toBool();
     if (shared)
-        emblems << QIcon::fromTheme("emblem-shared", standardEmblem(SystemEmblemType::kShare));
+        emblems |= bit(SystemEmblemType::kShare);
 
     return emblems;
 }
 
-QMap<int, QIcon> EmblemWorker::getGioEmblems(const AbstractFileInfoPointer &info) const
+void EmblemWorker::getGioEmblems(const QUrl &url, Product *product) const
 {
-    QMap<int, QIcon> emblemsMap;
-
-    // use AbstractFileInfo to access emblems, avoid query again
-    AbstractFileInfoPointer fileInfo = InfoFactory::create<AbstractFileInfo>(info->urlOf(UrlInfoType::kUrl), false);
-    if (!fileInfo)
-        return {};
-    const QStringList &emblemData = fileInfo->customAttribute("metadata::emblems", DFileInfo::DFileAttributeType::kTypeStringV).toStringList();
+    // read the attribute straight from gio, creating a second uncached file info costs more
+    const QStringList &emblemData = DecoratorFileInfo(url).customAttribute("metadata::emblems", DFileInfo::DFileAttributeType::kTypeStringV).toStringList();
 
     if (emblemData.isEmpty())
-        return emblemsMap;
+        return;
 
     const QString &emblemsStr = emblemData.first();
+    if (emblemsStr.isEmpty())
+        return;
 
-    if (!emblemsStr.isEmpty()) {
 #if (QT_VERSION <= QT_VERSION_CHECK(5, 15, 0))
-        const QStringList &emblemsStrList = emblemsStr.split("|", QString::SkipEmptyParts);
+    const QStringList &emblemsStrList = emblemsStr.split("|", QString::SkipEmptyParts);
 #else
-        const QStringList &emblemsStrList = emblemsStr.split("|", Qt::SkipEmptyParts);
+    const QStringList &emblemsStrList = emblemsStr.split("|", Qt::SkipEmptyParts);
 #endif
-        for (int i = 0; i < emblemsStrList.length(); i++) {
-            QString pos;
-            QIcon emblem;
-            if (parseEmblemString(&emblem, pos, emblemsStrList.at(i)))
-                setEmblemIntoIcons(pos, emblem, &emblemsMap);
-        }
-
-        return emblemsMap;
-    }
-
-    return emblemsMap;
-}
-
-QIcon EmblemWorker::standardEmblem(const SystemEmblemType type) const
-{
-    static QIcon linkEmblem(QIcon::fromTheme("emblem-symbolic-link"));
-    static QIcon lockEmblem(QIcon::fromTheme("emblem-locked"));
-    static QIcon unreadableEmblem(QIcon::fromTheme("emblem-unreadable"));
-    static QIcon shareEmblem(QIcon::fromTheme("emblem-shared"));
-
-    switch (type) {
-    case SystemEmblemType::kLink:
-        return linkEmblem;
-    case SystemEmblemType::kLock:
-        return lockEmblem;
-    case SystemEmblemType::kUnreadable:
-        return unreadableEmblem;
-    case SystemEmblemType::kShare:
-        return shareEmblem;
+    for (int i = 0; i < emblemsStrList.length(); i++) {
+        QString pos;
+        QString emblemPath;
+        if (parseEmblemString(&emblemPath, pos, emblemsStrList.at(i)))
+            product->gioEmblems[static_cast<size_t>(emblemIndex(pos))] = EmblemIconTable::instance().intern(emblemPath);
     }
-
-    return QIcon();
 }
 
-bool EmblemWorker::parseEmblemString(QIcon *emblem, QString &pos, const QString &emblemStr) const
+bool EmblemWorker::parseEmblemString(QString *emblemPath, QString &pos, const QString &emblemStr) const
 {
     // default position
     pos = "rd";
 
     if (!emblemStr.isEmpty()) {
-        QIcon emblemIcon;
         QString imgPath;
 
         if (emblemStr.contains(";")) {
@@ -188,40 +208,16 @@ bool EmblemWorker::parseEmblemString(QIcon *emblem, QString &pos, const QString
             if (suffix != "svg" && suffix != "png" && suffix != "gif" && suffix != "bmp" && suffix != "jpg")
                 return false;
 
-            emblemIcon = QIcon(imgPath);
-            if (!emblemIcon.isNull()) {
-                *emblem = emblemIcon;
-                return true;
-            }
+            // the icon is loaded on the main thread, only the path travels with the product
+            *emblemPath = imgPath;
+            return true;
         }
     }
 
     return false;
 }
 
-bool EmblemWorker::iconNamesEqual(const QList<QIcon> &first, const QList<QIcon> &second)
-{
-    if (first.isEmpty() && second.isEmpty())
-        return true;
-
-    if (first.size() != second.size())
-        return false;
-
-    QVector<QString> firstNames { first.size(), QString() };
-    QVector<QString> secondNames { second.size(), QString() };
-
-    std::transform(first.begin(), first.end(), firstNames.begin(), [](const QIcon &icon) {
-        return icon.name();
-    });
-
-    std::transform(second.begin(), second.end(), secondNames.begin(), [](const QIcon &icon) {
-        return icon.name();
-    });
-
-    return firstNames == secondNames;
-}
-
-void EmblemWorker::setEmblemIntoIcons(const QString &pos, const QIcon &emblem, QMap<int, QIcon> *iconMap) const
+int EmblemWorker::emblemIndex(const QString &pos) const
 {
     int emblemIndex = 0;   // default position rd = 0, rightdown
 
@@ -235,7 +231,7 @@ void EmblemWorker::setEmblemIntoIcons(const QString &pos, const QIcon &emblem, Q
     else if (pos == "ru")
         emblemIndex = 3;
 
-    (*iconMap)[emblemIndex] = emblem;
+    return emblemIndex;
 }
 
 EmblemHelper::EmblemHelper(QObject *parent)
@@ -270,28 +266,58 @@ QList<QRectF> EmblemHelper::emblemRects(const QRectF &paintArea) const
     return list;
 }
 
-QList<QIcon> EmblemHelper::emblemIcons(const QUrl &url) const
+QList<QIcon> EmblemHelper::emblemIcons(const QUrl &url)
 {
-    if (hasEmblem(url))
-        return productQueue.value(url);
+    auto it = productQueue.constFind(url);
+    if (it != productQueue.constEnd()) {
+        ++hits;
+    } else {
+        // kept until the worker reports it, so that the repaints before do not fetch again
+        ++misses;
+        it = productQueue.insert(url, worker->fetchEmblems(url));
+    }
 
-    return worker->fetchEmblems(url);
+    if ((hits + misses) % kStatisticLookups == 0)
+        qDebug() << "emblem cache hits:" << hits << "misses:" << misses;
+
+    return toIcons(it.value());
 }
 
 void EmblemHelper::pending(const QUrl &url)
 {
-    emit requestProduce(url);
+    // the urls painted in a short while are produced in one batch
+    if (!pendingUrlSet.contains(url)) {
+        pendingUrlSet.insert(url);
+        pendingUrls.append(url);
+    }
+
+    if (!produceTimer.isActive())
+        produceTimer.start();
+}
+
+void EmblemHelper::onProduceTimeout()
+{
+    if (pendingUrls.isEmpty())
+        return;
+
+    emit requestProduce(pendingUrls);
+    pendingUrls.clear();
+    pendingUrlSet.clear();
 }
 
-void EmblemHelper::onEmblemChanged(const QUrl &url, const Product &product)
+void EmblemHelper::onEmblemChanged(const ProductQueue &products)
 {
-    productQueue[url] = product;
-    if (hasEmblem(url)) {   // real changed
-        auto eventID { DPF_NAMESPACE::Event::instance()->eventType("ddplugin_canvas", "slot_FileInfoModel_UpdateFile") };
+    auto eventID { DPF_NAMESPACE::Event::instance()->eventType("ddplugin_canvas", "slot_FileInfoModel_UpdateFile") };
+    for (auto it = products.cbegin(); it != products.cend(); ++it) {
+        auto old = productQueue.find(it.key());
+        if (old != productQueue.end() && old.value() == it.value())
+            continue;
+
+        productQueue[it.key()] = it.value();
         if (eventID != DPF_NAMESPACE::EventTypeScope::kInValid)
-            dpfSlotChannel->push("ddplugin_canvas", "slot_FileInfoModel_UpdateFile", url);
+            dpfSlotChannel->push("ddplugin_canvas", "slot_FileInfoModel_UpdateFile", it.key());
         else
-            dpfSlotChannel->push("dfmplugin_workspace", "slot_Model_FileUpdate", url);
+            dpfSlotChannel->push("dfmplugin_workspace", "slot_Model_FileUpdate", it.key());
     }
 }
 
@@ -301,16 +327,79 @@ bool EmblemHelper::onUrlChanged(quint64 windowId, const QUrl &url)
     Q_UNUSED(url);
 
     clearEmblem();
+    pendingUrls.clear();
+    pendingUrlSet.clear();
     emit requestClear();
 
     return false;
 }
 
+QList<QIcon> EmblemHelper::toIcons(const Product &product)
+{
+    QList<QIcon> emblemList;
+
+    for (auto type : { SystemEmblemType::kLink, SystemEmblemType::kLock,
+                       SystemEmblemType::kUnreadable, SystemEmblemType::kShare }) {
+        if (product.systemEmblems & (1 << static_cast<int>(type)))
+            emblemList.append(systemEmblem(type));
+    }
+
+    // the gio emblems take their position if it is not taken by the system emblems
+    for (int i = 0; i < static_cast<int>(product.gioEmblems.size()); ++i) {
+        const qint16 id = product.gioEmblems[static_cast<size_t>(i)];
+        if (id < 0)
+            continue;
+
+        while (emblemList.count() < i)
+            emblemList.append(QIcon());
+
+        if (emblemList.count() == i)
+            emblemList.append(gioEmblem(id));
+        else if (emblemList.at(i).isNull())
+            emblemList.replace(i, gioEmblem(id));
+    }
+
+    return emblemList;
+}
+
+QIcon EmblemHelper::systemEmblem(const SystemEmblemType type) const
+{
+    static QIcon linkEmblem(QIcon::fromTheme("emblem-symbolic-link"));
+    static QIcon lockEmblem(QIcon::fromTheme("emblem-readonly", QIcon::fromTheme("emblem-locked")));
+    static QIcon unreadableEmblem(QIcon::fromTheme("emblem-unreadable"));
+    static QIcon shareEmblem(QIcon::fromTheme("emblem-shared"));
+
+    switch (type) {
+    case SystemEmblemType::kLink:
+        return linkEmblem;
+    case SystemEmblemType::kLock:
+        return lockEmblem;
+    case SystemEmblemType::kUnreadable:
+        return unreadableEmblem;
+    case SystemEmblemType::kShare:
+        return shareEmblem;
+    }
+
+    return QIcon();
+}
+
+QIcon EmblemHelper::gioEmblem(qint16 id)
+{
+    auto it = gioEmblemIcons.constFind(id);
+    if (it == gioEmblemIcons.constEnd())
+        it = gioEmblemIcons.insert(id, QIcon(EmblemIconTable::instance().path(id)));
+    return it.value();
+}
+
 void EmblemHelper::initialize()
 {
     Q_ASSERT(qApp->thread() == QThread::currentThread());
     dpfSignalDispatcher->installEventFilter(GlobalEventType::kChangeCurrentUrl, this, &EmblemHelper::onUrlChanged);
 
+    produceTimer.setSingleShot(true);
+    produceTimer.setInterval(kProduceInterval);
+    connect(&produceTimer, &QTimer::timeout, this, &EmblemHelper::onProduceTimeout);
+
     worker->moveToThread(&workerThread);
     connect(&workerThread, &QThread::finished, worker, &QObject::deleteLater);
     connect(this, &EmblemHelper::requestProduce, worker, &EmblemWorker::onProduce, Qt::QueuedConnection);
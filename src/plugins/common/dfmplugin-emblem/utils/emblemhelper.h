@@ -13,35 +13,77 @@
 
 #include <QIcon>
 #include <QThread>
+#include <QTimer>
+#include <QSet>
+#include <QReadWriteLock>
+
+#include <array>
+#include <atomic>
 
 DPEMBLEM_BEGIN_NAMESPACE
-using Product = QList<QIcon>;   // for a url
+// the emblems of a url, the system emblems are bits of SystemEmblemType and
+// the gio emblems are the ids in EmblemIconTable by position (rd, ld, lu, ru)
+struct EmblemSet
+{
+    quint8 systemEmblems { 0 };
+    std::array<qint16, 4> gioEmblems { { -1, -1, -1, -1 } };
+
+    inline bool operator==(const EmblemSet &other) const
+    {
+        return systemEmblems == other.systemEmblems && gioEmblems == other.gioEmblems;
+    }
+    inline bool operator!=(const EmblemSet &other) const { return !(*this == other); }
+};
+
+using Product = EmblemSet;   // for a url
 using ProductQueue = QHash<QUrl, Product>;
 
+// the image paths of the gio emblems, interned so that a url keeps only their ids
+class EmblemIconTable
+{
+public:
+    static EmblemIconTable &instance();
+    qint16 intern(const QString &path);
+    QString path(qint16 id) const;
+
+private:
+    EmblemIconTable() = default;
+
+    mutable QReadWriteLock lock;
+    QHash<QString, qint16> ids;
+    QStringList paths;
+};
+
 class EmblemWorker : public QObject
 {
     Q_OBJECT
 
 public:
-    QList<QIcon> fetchEmblems(const QUrl &url) const;
+    Product fetchEmblems(const QUrl &url, const QSet<QString> *sharedPaths = nullptr) const;
+
+    inline quint64 batchCount() const { return batches.load(); }
+    inline quint64 batchUrlCount() const { return batchUrls.load(); }
+    inline quint64 batchTotalTime() const { return batchTime.load(); }   // us
 
 public Q_SLOTS:
-    void onProduce(const QUrl &url);
+    void onProduce(const QList<QUrl> &urls);
     void onClear();
 
 Q_SIGNALS:
-    void emblemChanged(const QUrl &url, const Product &product);
+    void emblemChanged(const ProductQueue &products);
 
 private:
-    QList<QIcon> getSystemEmblems(const AbstractFileInfoPointer &info) const;
-    QMap<int, QIcon> getGioEmblems(const AbstractFileInfoPointer &info) const;
-    QIcon standardEmblem(const SystemEmblemType type) const;
-    bool parseEmblemString(QIcon *emblem, QString &pos, const QString &emblemStr) const;
-    bool iconNamesEqual(const QList<QIcon> &first, const QList<QIcon> &second);
-    void setEmblemIntoIcons(const QString &pos, const QIcon &emblem, QMap<int, QIcon> *iconMap) const;
+    QSet<QString> fetchSharedPaths() const;
+    quint8 getSystemEmblems(const AbstractFileInfoPointer &info, const QSet<QString> *sharedPaths) const;
+    void getGioEmblems(const QUrl &url, Product *product) const;
+    bool parseEmblemString(QString *emblemPath, QString &pos, const QString &emblemStr) const;
+    int emblemIndex(const QString &pos) const;
 
 private:
     ProductQueue cache;
+    std::atomic<quint64> batches { 0 };
+    std::atomic<quint64> batchUrls { 0 };
+    std::atomic<quint64> batchTime { 0 };
 };
 
 class EmblemHelper : public QObject
@@ -56,24 +98,37 @@ public:
     inline void clearEmblem() { productQueue.clear(); }
 
     QList<QRectF> emblemRects(const QRectF &paintArea) const;
-    QList<QIcon> emblemIcons(const QUrl &url) const;
+    QList<QIcon> emblemIcons(const QUrl &url);
     void pending(const QUrl &url);
 
+    inline quint64 hitCount() const { return hits; }
+    inline quint64 missCount() const { return misses; }
+
 Q_SIGNALS:
-    void requestProduce(const QUrl &url);
+    void requestProduce(const QList<QUrl> &urls);
     void requestClear();
 
 private Q_SLOTS:
-    void onEmblemChanged(const QUrl &url, const Product &product);
+    void onEmblemChanged(const ProductQueue &products);
     bool onUrlChanged(quint64 windowId, const QUrl &url);
+    void onProduceTimeout();
 
 private:
     void initialize();
+    QList<QIcon> toIcons(const Product &product);
+    QIcon systemEmblem(const SystemEmblemType type) const;
+    QIcon gioEmblem(qint16 id);
 
 private:
     EmblemWorker *worker { new EmblemWorker };
     ProductQueue productQueue;
     QThread workerThread;
+    QTimer produceTimer;
+    QList<QUrl> pendingUrls;
+    QSet<QUrl> pendingUrlSet;
+    QHash<qint16, QIcon> gioEmblemIcons;
+    quint64 hits { 0 };
+    quint64 misses { 0 };
 
     static constexpr int kProduceInterval { 300 };   // ms
 };
@@ -21,6 +21,8 @@
 #include <QDebug>
 #include <QProcess>
 #include <QVariant>
+#include <QSqlQuery>
+#include <QSqlError>
 
 DPTAG_USE_NAMESPACE
 USING_IO_NAMESPACE
@@ -29,6 +31,15 @@ static constexpr char kTagDbName[] = ".__tag.db";
 static constexpr char kTagTableFileTags[] = "file_tags";
 static constexpr char kTagTableTagProperty[] = "tag_property";
 
+static QVariantList toVariantList(const QStringList &list)
+{
+    QVariantList ret;
+    ret.reserve(list.size());
+    for (const auto &item : list)
+        ret.append(item);
+    return ret;
+}
+
 TagDbHandle *TagDbHandle::instance()
 {
     static TagDbHandle ins;
@@ -98,15 +109,9 @@ QVariantMap TagDbHandle::getTagsByUrls(const QStringList &urlList)
     }
 
     // query
-    const auto &field = Expression::Field<FileTagInfo>;
     QVariantMap allFileTags;
     for (auto &path : urlList) {
-        const auto &beanList = handle->query<FileTagInfo>().where(field("filePath") == path).toBeans();
-
-        QStringList fileTags;
-        for (auto oneBean : beanList)
-            fileTags.append(oneBean->getTagName());
-
+        const auto &fileTags = fileTagsIndex.value(path);
         if (!fileTags.isEmpty())
             allFileTags.insert(path, fileTags);
     }
@@ -155,16 +160,9 @@ QVariantMap TagDbHandle::getFilesByTag(const QStringList &tags)
     }
 
     // query
-    const auto &field = Expression::Field<FileTagInfo>;
     QVariantMap allTagFiles;
-    for (auto &tag : tags) {
-        const auto &obj = handle->query<FileTagInfo>().where(field("tagName") == tag).toBeans();
-        QStringList files;
-        for (auto tempBean : obj)
-            files.append(tempBean->getFilePath());
-
-        allTagFiles.insert(tag, QVariant { files });
-    }
+    for (auto &tag : tags)
+        allTagFiles.insert(tag, QVariant { QStringList(tagFilesIndex.value(tag).values()) });
 
     finally.dismiss();
     return allTagFiles;
@@ -175,20 +173,7 @@ QHash<QString, QStringList> TagDbHandle::getAllFileWithTags()
     DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
     finally.dismiss();
 
-    // query
-    const auto &beans = handle->query<FileTagInfo>().toBeans();
-
-    QHash<QString, QStringList> fileTagsMap;
-    for (auto &bean : beans) {
-        const auto &path = bean->getFilePath();
-        if (fileTagsMap.contains(path)) {
-            fileTagsMap[path].append(bean->getTagName());
-        } else {
-            fileTagsMap.insert(path, { bean->getTagName() });
-        }
-    }
-
-    return fileTagsMap;
+    return fileTagsIndex;
 }
 
 bool TagDbHandle::addTagProperty(const QVariantMap &data)
@@ -223,36 +208,34 @@ bool TagDbHandle::addTagsForFiles(const QVariantMap &data)
         return false;
     }
 
-    const auto &allTags = getTagsByUrls(data.keys());
-    auto it = allTags.begin();
-    QMap<QString, QStringList> allMutualTags;
-
-    for (; it != allTags.end(); ++it)
-        allMutualTags.insert(it.key(), it.value().toStringList());
-
-    // insert file--tags
-    bool ret = true;
-    auto dataIt = data.begin();
-    for (; dataIt != data.end(); ++dataIt) {
-        if (allMutualTags.keys().contains(dataIt.key())) {
-            const auto &tmpList = dataIt.value().toStringList();
-            const auto &tempMutualTags = allMutualTags.value(dataIt.key());
-            for (const auto &tp : tmpList) {
-                if (!tempMutualTags.contains(tp)) {
-                    ret = tagFile(dataIt.key(), dataIt.value());
-                    if (!ret) {
-                        return false;
-                    }
-                }
-            }
-        } else {
-            ret = tagFile(dataIt.key(), dataIt.value());
-            if (!ret) {
-                return false;
+    // only the tags which the files do not have yet are inserted
+    QVariantList paths, tags;
+    for (auto it = data.begin(); it != data.end(); ++it) {
+        const auto &fileTags = fileTagsIndex.value(it.key());
+        const auto &newTags = it.value().toStringList();
+        QStringList addedTags;
+        for (const auto &tag : newTags) {
+            if (!fileTags.contains(tag) && !addedTags.contains(tag)) {
+                addedTags.append(tag);
+                paths.append(it.key());
+                tags.append(tag);
             }
         }
     }
 
+    if (!paths.isEmpty()) {
+        // insert file--tags
+        const QString &sql = QString("INSERT INTO %1 (filePath, tagName, tagOrder, future) VALUES (?, ?, 0, 'null')")
+                                     .arg(SqliteHelper::tableName<FileTagInfo>());
+        if (!handle->transaction([&]() { return execBatch(sql, { paths, tags }); })) {
+            lastErr = QString("Tag files failed! %1").arg(lastErr);
+            return false;
+        }
+
+        for (int i = 0; i < paths.size(); ++i)
+            insertIndex(paths.at(i).toString(), tags.at(i).toString());
+    }
+
     emit filesWereTagged(data);
     finally.dismiss();
     return true;
@@ -267,11 +250,25 @@ bool TagDbHandle::removeTagsOfFiles(const QVariantMap &data)
         return false;
     }
 
+    QVariantList paths, tags;
+    for (auto it = data.begin(); it != data.end(); ++it) {
+        const auto &tempTags = it.value().toStringList();
+        for (const auto &tag : tempTags) {
+            paths.append(it.key());
+            tags.append(tag);
+        }
+    }
+
     // remove file--tags
-    auto it = data.begin();
-    for (; it != data.end(); ++it)
-        if (!removeSpecifiedTagOfFile(it.key(), it.value()))
-            return false;
+    const QString &sql = QString("DELETE FROM %1 WHERE filePath = ? AND tagName = ?")
+                                 .arg(SqliteHelper::tableName<FileTagInfo>());
+    if (!handle->transaction([&]() { return execBatch(sql, { paths, tags }); })) {
+        lastErr = QString("Remove specified tags of files failed! %1").arg(lastErr);
+        return false;
+    }
+
+    for (int i = 0; i < paths.size(); ++i)
+        removeIndex(paths.at(i).toString(), tags.at(i).toString());
 
     emit filesUntagged(data);
     finally.dismiss();
@@ -287,17 +284,18 @@ bool TagDbHandle::deleteTags(const QStringList &tags)
         return false;
     }
 
-    const auto &fieldOne = Expression::Field<TagProperty>;
-    const auto &fieldTwo = Expression::Field<FileTagInfo>;
+    const QVariantList &tagList = toVariantList(tags);
+    bool ret = handle->transaction([&]() {
+        return execBatch(QString("DELETE FROM %1 WHERE tagName = ?").arg(SqliteHelper::tableName<TagProperty>()), { tagList })
+                && execBatch(QString("DELETE FROM %1 WHERE tagName = ?").arg(SqliteHelper::tableName<FileTagInfo>()), { tagList });
+    });
+    if (!ret)
+        return ret;
 
-    bool ret = true;
     for (const auto &tag : tags) {
-        ret = handle->remove<TagProperty>(fieldOne("tagName") == tag);
-        if (!ret)
-            return ret;
-        ret = handle->remove<FileTagInfo>(fieldTwo("tagName") == tag);
-        if (!ret)
-            return ret;
+        const auto &files = tagFilesIndex.take(tag);
+        for (const auto &file : files)
+            removeIndex(file, tag);
     }
 
     emit tagsDeleted(tags);
@@ -314,10 +312,15 @@ bool TagDbHandle::deleteFiles(const QStringList &urls)
         return false;
     }
 
-    auto field = Expression::Field<FileTagInfo>;
+    const QVariantList &urlList = toVariantList(urls);
+    const QString &sql = QString("DELETE FROM %1 WHERE filePath = ?").arg(SqliteHelper::tableName<FileTagInfo>());
+    if (!handle->transaction([&]() { return execBatch(sql, { urlList }); }))
+        return false;
+
     for (const auto &url : urls) {
-        if (!handle->remove<FileTagInfo>(field("filePath") == url))
-            return false;
+        const auto &fileTags = fileTagsIndex.value(url);
+        for (const auto &tag : fileTags)
+            removeIndex(url, tag);
     }
 
     finally.dismiss();
@@ -384,10 +387,26 @@ bool TagDbHandle::changeFilePaths(const QVariantMap &data)
         return false;
     }
 
-    auto it = data.begin();
-    for (; it != data.end(); ++it)
-        if (!changeFilePath(it.key(), it.value().toString()))
-            return false;
+    // a renamed dir carries the tags of its children, they are updated with the dir as a prefix
+    QVariantList newPaths, oldPaths, oldPrefixes;
+    for (auto it = data.begin(); it != data.end(); ++it) {
+        if (it.key().isEmpty() || it.value().toString().isEmpty())
+            continue;
+        newPaths.append(it.value().toString());
+        oldPaths.append(it.key());
+        oldPrefixes.append(it.key().endsWith("/") ? it.key() : it.key() + "/");
+    }
+
+    const QString &sql = QString("UPDATE %1 SET filePath = ? || substr(filePath, length(?) + 1)"
+                                 " WHERE filePath = ? OR substr(filePath, 1, length(?)) = ?")
+                                 .arg(SqliteHelper::tableName<FileTagInfo>());
+    if (!handle->transaction([&]() { return execBatch(sql, { newPaths, oldPaths, oldPaths, oldPrefixes, oldPrefixes }); })) {
+        lastErr = QString("Change file paths failed! %1").arg(lastErr);
+        return false;
+    }
+
+    for (int i = 0; i < oldPaths.size(); ++i)
+        renameIndex(oldPaths.at(i).toString(), newPaths.at(i).toString());
 
     finally.dismiss();
     return true;
@@ -409,9 +428,9 @@ bool TagDbHandle::checkDatabase()
     if (!dir.exists())
         dir.mkpath(dbPath);
 
-    const auto &dbFilePath = DFMUtils::buildFilePath(dbPath.toLocal8Bit(),
-                                                     kTagDbName,
-                                                     nullptr);
+    dbFilePath = DFMUtils::buildFilePath(dbPath.toLocal8Bit(),
+                                         kTagDbName,
+                                         nullptr);
     handle = new SqliteHandle(dbFilePath);
     QSqlDatabase db { SqliteConnectionPool::instance().openConnection(dbFilePath) };
     if (!db.isValid() || db.isOpenError()) {
@@ -426,6 +445,8 @@ bool TagDbHandle::checkDatabase()
     if (!checkTableExists(kTagTableFileTags))
         return false;
 
+    // the file tags are answered from memory, the index is kept in step with every write
+    loadIndex();
     return true;
 }
 
@@ -434,12 +455,6 @@ bool TagDbHandle::checkTag(const QString &tag)
     return handle->query<TagProperty>().where(Expression::Field<TagProperty>("tagName") == tag).toBeans().size() > 0;
 }
 
-bool TagDbHandle::checkFile(const QString &file)
-{
-    // Query field 'filePath' of database table file_tags
-    return handle->query<FileTagInfo>().where(Expression::Field<FileTagInfo>("filePath") == file).toBeans().size() > 0;
-}
-
 bool TagDbHandle::insertTagProperty(const QString &name, const QVariant &value)
 {
     DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
@@ -465,65 +480,6 @@ bool TagDbHandle::insertTagProperty(const QString &name, const QVariant &value)
     return true;
 }
 
-bool TagDbHandle::tagFile(const QString &file, const QVariant &tags)
-{
-    DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
-
-    if (file.isEmpty() || tags.isNull()) {
-        lastErr = "input parameter is empty!";
-        return false;
-    }
-
-    // insert file--tags
-    const QStringList &tempTags = tags.toStringList();
-    int suc = tempTags.count();
-    for (const auto &tag : tempTags) {
-        FileTagInfo temp;
-        temp.setFilePath(file);
-        temp.setTagName(tag);
-        temp.setTagOrder(0);
-        temp.setFuture("null");
-        if (-1 == handle->insert<FileTagInfo>(temp))
-            break;
-        suc--;
-    }
-
-    if (0 < suc) {
-        lastErr = QString("Tag file failed! file: %1, tagName: %2").arg(file).arg(tempTags.at(--suc));
-        return false;
-    }
-
-    finally.dismiss();
-    return true;
-}
-
-bool TagDbHandle::removeSpecifiedTagOfFile(const QString &url, const QVariant &val)
-{
-    DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
-
-    if (url.isEmpty() || val.isNull()) {
-        lastErr = "input parameter is empty!";
-        return false;
-    }
-
-    auto field = Expression::Field<FileTagInfo>;
-    const auto tempTags = val.toStringList();
-    int suc = tempTags.count();
-    for (const auto &tag : tempTags) {
-        if (!handle->remove<FileTagInfo>((field("filePath") == url) && (field("tagName") == tag)))
-            break;
-        suc--;
-    }
-
-    if (0 < suc) {
-        lastErr = QString("Remove specified tag Of File failed! file: %1, tagName: %2").arg(url).arg(tempTags.at(--suc));
-        return false;
-    }
-
-    finally.dismiss();
-    return true;
-}
-
 bool TagDbHandle::changeTagColor(const QString &tagName, const QString &newTagColor)
 {
     DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
@@ -568,31 +524,94 @@ bool TagDbHandle::changeTagNameWithFile(const QString &tagName, const QString &n
         return true;
     });
 
-    if (ret)
+    if (ret) {
+        const auto &files = tagFilesIndex.value(tagName);
+        for (const auto &file : files) {
+            removeIndex(file, tagName);
+            insertIndex(file, newName);
+        }
         finally.dismiss();
+    }
 
     return ret;
 }
 
-bool TagDbHandle::changeFilePath(const QString &oldPath, const QString &newPath)
+bool TagDbHandle::execBatch(const QString &sql, const QList<QVariantList> &values)
 {
-    DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
-
-    if (oldPath.isEmpty() || newPath.isEmpty()) {
-        lastErr = "input parameter is empty!";
+    QSqlDatabase db { SqliteConnectionPool::instance().openConnection(dbFilePath) };
+    QSqlQuery query { db };
+    if (!query.prepare(sql)) {
+        lastErr = query.lastError().text();
+        qWarning() << "Prepare sql failed:" << sql << lastErr;
         return false;
     }
 
-    const auto &field = Expression::Field<FileTagInfo>;
-    if (!handle->update<TagProperty>(field("filePath") = newPath, field("filePath") == oldPath)) {
-        lastErr = QString("Change file path failed! oldPath: %1, newPath: %2").arg(oldPath).arg(oldPath);
+    for (const auto &value : values)
+        query.addBindValue(value);
+
+    if (!query.execBatch()) {
+        lastErr = query.lastError().text();
+        qWarning() << "Execute sql failed:" << sql << lastErr;
         return false;
     }
 
-    finally.dismiss();
     return true;
 }
 
+void TagDbHandle::loadIndex()
+{
+    fileTagsIndex.clear();
+    tagFilesIndex.clear();
+
+    const auto &beans = handle->query<FileTagInfo>().toBeans();
+    for (auto &bean : beans)
+        insertIndex(bean->getFilePath(), bean->getTagName());
+}
+
+void TagDbHandle::insertIndex(const QString &file, const QString &tag)
+{
+    auto &fileTags = fileTagsIndex[file];
+    if (!fileTags.contains(tag))
+        fileTags.append(tag);
+    tagFilesIndex[tag].insert(file);
+}
+
+void TagDbHandle::removeIndex(const QString &file, const QString &tag)
+{
+    auto fileIt = fileTagsIndex.find(file);
+    if (fileIt != fileTagsIndex.end()) {
+        fileIt->removeAll(tag);
+        if (fileIt->isEmpty())
+            fileTagsIndex.erase(fileIt);
+    }
+
+    auto tagIt = tagFilesIndex.find(tag);
+    if (tagIt != tagFilesIndex.end()) {
+        tagIt->remove(file);
+        if (tagIt->isEmpty())
+            tagFilesIndex.erase(tagIt);
+    }
+}
+
+void TagDbHandle::renameIndex(const QString &oldPath, const QString &newPath)
+{
+    const QString &oldPrefix = oldPath.endsWith("/") ? oldPath : oldPath + "/";
+    QStringList renamedFiles;
+    for (auto it = fileTagsIndex.cbegin(); it != fileTagsIndex.cend(); ++it) {
+        if (it.key() == oldPath || it.key().startsWith(oldPrefix))
+            renamedFiles.append(it.key());
+    }
+
+    for (const auto &file : renamedFiles) {
+        const auto &fileTags = fileTagsIndex.value(file);
+        const QString &newFile = newPath + file.mid(oldPath.length());
+        for (const auto &tag : fileTags) {
+            removeIndex(file, tag);
+            insertIndex(newFile, tag);
+        }
+    }
+}
+
 bool TagDbHandle::checkTableExists(const QString &tableName)
 {
     if (tableName.isEmpty())
@@ -9,6 +9,7 @@
 
 #include <QObject>
 #include <QMap>
+#include <QSet>
 
 DFMBASE_USE_NAMESPACE
 namespace dfmplugin_tag {
@@ -58,13 +59,15 @@ public:
 
 private:
     bool checkTag(const QString &tag);
-    bool checkFile(const QString &file);
     bool insertTagProperty(const QString &name, const QVariant &value);
-    bool tagFile(const QString &file, const QVariant &tags);
-    bool removeSpecifiedTagOfFile(const QString &url, const QVariant &val);
     bool changeTagColor(const QString &tagName, const QString &newTagColor);
     bool changeTagNameWithFile(const QString &tagName, const QString &newName);
-    bool changeFilePath(const QString &oldPath, const QString &newPath);
+    bool execBatch(const QString &sql, const QList<QVariantList> &values);
+
+    void loadIndex();
+    void insertIndex(const QString &file, const QString &tag);
+    void removeIndex(const QString &file, const QString &tag);
+    void renameIndex(const QString &oldPath, const QString &newPath);
 
     bool checkTableExists(const QString &tableName);
     bool createTable(const QString &tableName);
@@ -83,7 +86,10 @@ Q_SIGNALS:
 
 private:
     SqliteHandle *handle { nullptr };
+    QString dbFilePath;
     QString lastErr;
+    QHash<QString, QStringList> fileTagsIndex;   // file path -> tags
+    QHash<QString, QSet<QString>> tagFilesIndex;   // tag -> file paths
 };
 
 }
@@ -219,6 +219,27 @@ FileTagCache::TagColorMap FileTagCache::getTagsColor(const QStringList &tags)
     return tagsColor;
 }
 
+FileTagCache::TagColorMap FileTagCache::getFileTagsColor(const QString &path)
+{
+    if (path.isEmpty())
+        return {};
+
+    // the tags and their colors are read under one lock, it is called for every painted item
+    QReadLocker wlk(&d->lock);
+    auto it = d->fileTagsCache.constFind(path);
+    if (it == d->fileTagsCache.constEnd())
+        return {};
+
+    TagColorMap tagsColor;
+    for (const auto &tag : it.value()) {
+        auto colorIt = d->tagProperty.constFind(tag);
+        if (colorIt != d->tagProperty.constEnd())
+            tagsColor.insert(tag, colorIt.value());
+    }
+
+    return tagsColor;
+}
+
 FileTagCacheController &FileTagCacheController::instance()
 {
     static FileTagCacheController cacheController;
@@ -235,6 +256,11 @@ QMap<QString, QColor> FileTagCacheController::getCacheTagsColor(const QStringLis
     return FileTagCache::instance().getTagsColor(tags);
 }
 
+QMap<QString, QColor> FileTagCacheController::getCacheFileTagsColor(const QString &path)
+{
+    return FileTagCache::instance().getFileTagsColor(path);
+}
+
 FileTagCacheController::~FileTagCacheController()
 {
     updateThread->quit();
@@ -46,6 +46,7 @@ public:
     virtual ~FileTagCache() override;
     QStringList getCacheFileTags(const QString &path);
     TagColorMap getTagsColor(const QStringList &tags);
+    TagColorMap getFileTagsColor(const QString &path);
 
 private:
     explicit FileTagCache(QObject *parent = nullptr);
@@ -73,6 +74,7 @@ public:
     static FileTagCacheController &instance();
     QStringList getCacheFileTags(const QString &path);
     QMap<QString, QColor> getCacheTagsColor(const QStringList &tags);
+    QMap<QString, QColor> getCacheFileTagsColor(const QString &path);
 
 Q_SIGNALS:
     void initLoadTagInfos();
@@ -18,6 +18,7 @@
 #include "dfm-base/dfm_global_defines.h"
 #include "dfm-base/base/schemefactory.h"
 #include "dfm-base/base/device/deviceutils.h"
+#include "dfm-base/base/device/deviceproxymanager.h"
 #include "dfm-base/utils/dialogmanager.h"
 #include "dfm-base/utils/clipboard.h"
 #include "dfm-base/utils/fileutils.h"
@@ -58,6 +59,12 @@ void TagManager::initializeConnection()
     connect(TagProxyHandleIns, &TagProxyHandle::tagsNameChanged, this, &TagManager::onTagNameChanged);
     connect(TagProxyHandleIns, &TagProxyHandle::filesTagged, this, &TagManager::onFilesTagged);
     connect(TagProxyHandleIns, &TagProxyHandle::filesUntagged, this, &TagManager::onFilesUntagged);
+
+    // the verdict of a dir depends on the device mounted on it
+    connect(DevProxyMng, &DeviceProxyManager::blockDevMounted, this, &TagManager::clearDirCanTagCache);
+    connect(DevProxyMng, &DeviceProxyManager::blockDevUnmounted, this, &TagManager::clearDirCanTagCache);
+    connect(DevProxyMng, &DeviceProxyManager::protocolDevMounted, this, &TagManager::clearDirCanTagCache);
+    connect(DevProxyMng, &DeviceProxyManager::protocolDevUnmounted, this, &TagManager::clearDirCanTagCache);
 }
 
 TagManager *TagManager::instance()
@@ -76,29 +83,32 @@ QUrl TagManager::rootUrl()
 
 bool TagManager::canTagFile(const QUrl &url) const
 {
-    // TODO(perf) costs when first painting (while loading files)
     if (!url.isValid())
         return false;
 
-    QUrl localUrl;
-    if (url.scheme() == Global::Scheme::kFile) {
-        localUrl = url;
-    } else {
-        QList<QUrl> transUrls {};
-        QList<QUrl> srcUrls { url };
-        bool ok = UniversalUtils::urlsTransform(srcUrls, &transUrls);
-        if (ok && !transUrls.isEmpty()) {
-            localUrl = transUrls.first();
-        }
+    if (url.scheme() == Global::Scheme::kFile)
+        return localFileCanTagFilter(url);
+
+    // the files of a dir which are not transformed to local files are answered by the
+    // hook once for the dir
+    const QString &dirKey { url.adjusted(QUrl::RemoveFilename | QUrl::RemoveQuery | QUrl::RemoveFragment).toString() };
+    {
+        QReadLocker locker(&dirCanTagLock);
+        auto it = hookCanTagCache.constFind(dirKey);
+        if (it != hookCanTagCache.constEnd())
+            return it.value();
     }
 
-    if (!localUrl.isEmpty() && localUrl.scheme() == Global::Scheme::kFile)
-        return localFileCanTagFilter(localUrl);
-
-    if (dpfHookSequence->run("dfmplugin_tag", "hook_CanTag", url))
-        return true;
+    QList<QUrl> transUrls {};
+    QList<QUrl> srcUrls { url };
+    bool ok = UniversalUtils::urlsTransform(srcUrls, &transUrls);
+    if (ok && !transUrls.isEmpty() && transUrls.first().scheme() == Global::Scheme::kFile)
+        return localFileCanTagFilter(transUrls.first());
 
-    return false;
+    const bool canTag = dpfHookSequence->run("dfmplugin_tag", "hook_CanTag", url);
+    QWriteLocker locker(&dirCanTagLock);
+    hookCanTagCache.insert(dirKey, canTag);
+    return canTag;
 }
 
 bool TagManager::paintListTagsHandle(int role, const QUrl &url, QPainter *painter, QRectF *rect)
@@ -109,11 +119,7 @@ bool TagManager::paintListTagsHandle(int role, const QUrl &url, QPainter *painte
     if (role != kItemFileDisplayNameRole && role != kItemNameRole)
         return false;
 
-    const auto &tags = FileTagCacheController::instance().getCacheFileTags(url.path());
-    if (tags.isEmpty())
-        return false;
-
-    const auto &tagsColor = FileTagCacheController::instance().getCacheTagsColor(tags);
+    const auto &tagsColor = FileTagCacheController::instance().getCacheFileTagsColor(url.path());
     if (!tagsColor.isEmpty()) {
         QRectF boundingRect(0, 0, (tagsColor.size() + 1) * kTagDiameter / 2, kTagDiameter);
         boundingRect.moveCenter(rect->center());
@@ -135,12 +141,7 @@ bool TagManager::paintIconTagsHandle(const QUrl &url, const QRectF &rect, QPaint
     if (!canTagFile(url.toString()))
         return false;
 
-    const auto &fileTags = FileTagCacheController::instance().getCacheFileTags(url.path());
-    if (fileTags.isEmpty())
-        return false;
-
-    const auto &tagsColor = FileTagCacheController::instance().getCacheTagsColor(fileTags);
-
+    const auto &tagsColor = FileTagCacheController::instance().getCacheFileTagsColor(url.path());
     if (!tagsColor.isEmpty()) {
         auto document = layout->documentHandle();
         if (document) {
@@ -479,23 +480,19 @@ bool TagManager::deleteTagData(const QStringList &data, const TagActionType &typ
 
 bool TagManager::localFileCanTagFilter(const QUrl &url) const
 {
-    auto &&fileInfo { InfoFactory::create<AbstractFileInfo>(url) };
-    if (!fileInfo)
+    QString filePath { url.path() };
+    if (filePath.size() > 1 && filePath.endsWith("/"))
+        filePath.chop(1);
+    const int index = filePath.lastIndexOf("/");
+    if (index < 0)
         return false;
 
-    if (!AnythingMonitorFilter::instance().whetherFilterCurrentPath(fileInfo->urlOf(AbstractFileInfo::FileUrlInfoType::kParentUrl).toLocalFile()))
-        return false;
-
-    const QString filePath { fileInfo->pathOf(AbstractFileInfo::FilePathInfoType::kFilePath) };
-    const QString &compressPath { QDir::homePath() + "/.avfs/" };
-    if (filePath.startsWith(compressPath))
-        return false;
-
-    const QString &parentPath { fileInfo->urlOf(AbstractFileInfo::FileUrlInfoType::kParentUrl).path() };
-    if (parentPath == "/home" || parentPath == FileUtils::bindPathTransform("/home", true))
+    // the rules of the parent dir are the same for all its children, they are checked once
+    if (!localDirCanTagFilter(index > 0 ? filePath.left(index) : QString("/")))
         return false;
 
     if (FileUtils::isDesktopFile(url)) {
+        auto &&fileInfo { InfoFactory::create<AbstractFileInfo>(url) };
         auto desktopInfo { dynamic_cast<DesktopFileInfo *>(fileInfo.data()) };
         if (desktopInfo)
             return desktopInfo->canTag();
@@ -507,6 +504,36 @@ bool TagManager::localFileCanTagFilter(const QUrl &url) const
     return !SystemPathUtil::instance()->isSystemPath(filePath);
 }
 
+bool TagManager::localDirCanTagFilter(const QString &dirPath) const
+{
+    {
+        QReadLocker locker(&dirCanTagLock);
+        auto it = dirCanTagCache.constFind(dirPath);
+        if (it != dirCanTagCache.constEnd())
+            return it.value();
+    }
+
+    bool canTag = AnythingMonitorFilter::instance().whetherFilterCurrentPath(dirPath);
+
+    const QString &compressPath { QDir::homePath() + "/.avfs/" };
+    if (canTag && (dirPath + "/").startsWith(compressPath))
+        canTag = false;
+
+    if (canTag && (dirPath == "/home" || dirPath == FileUtils::bindPathTransform("/home", true)))
+        canTag = false;
+
+    QWriteLocker locker(&dirCanTagLock);
+    dirCanTagCache.insert(dirPath, canTag);
+    return canTag;
+}
+
+void TagManager::clearDirCanTagCache()
+{
+    QWriteLocker locker(&dirCanTagLock);
+    dirCanTagCache.clear();
+    hookCanTagCache.clear();
+}
+
 QVariant TagManager::transformQueryData(const QDBusVariant &var) const
 {
     QVariant variant { var.variant() };
@@ -12,6 +12,8 @@
 #include <QObject>
 #include <QPainter>
 #include <QMap>
+#include <QHash>
+#include <QReadWriteLock>
 #include <QDBusVariant>
 
 namespace dfmplugin_tag {
@@ -85,6 +87,8 @@ private:
     QMap<QString, QString> getTagsColorName(const QStringList &tags) const;
     bool deleteTagData(const QStringList &data, const TagActionType &type);
     bool localFileCanTagFilter(const QUrl &url) const;
+    bool localDirCanTagFilter(const QString &dirPath) const;
+    void clearDirCanTagCache();
     QVariant transformQueryData(const QDBusVariant &var) const;
 
 private:
@@ -92,6 +96,10 @@ private:
     TagPainter *tagPainter;
 
     QMap<QString, QString> tagColorMap;   // tag--color
+
+    mutable QReadWriteLock dirCanTagLock;
+    mutable QHash<QString, bool> dirCanTagCache;   // dir path--whether its children can be tagged
+    mutable QHash<QString, bool> hookCanTagCache;   // dir url--hook_CanTag of its children without local files
 };
 
 }
@@ -36,8 +36,10 @@ void CanvasGrid::initSurface(int count)
     d->clean();
 
     d->surfaces.clear();
+    d->grids.clear();
+    d->changedSurfaces.clear();
     for (int i = 1; i <= count; ++i)
-        d->surfaces.insert(i, QSize(0, 0));
+        d->resizeSurface(i, QSize(0, 0));
 }
 
 void CanvasGrid::updateSize(int index, const QSize &size)
@@ -56,19 +58,19 @@ void CanvasGrid::updateSize(int index, const QSize &size)
         return;
 
     // need to rearrange items if surface /a index isn't empty.
-    bool rearrange = !d->itemPos.value(index).isEmpty();
+    bool rearrange = d->itemCount(index) > 0;
     if (rearrange) {
         // get current items to restore
         auto allItems = items();
 
         //update surface size
-        itor.value() = size;
+        d->resizeSurface(index, size);
 
         // rearrange all items
         setItems(allItems);
     } else {
         // just update surface size
-        itor.value() = size;
+        d->resizeSurface(index, size);
     }
 }
 
@@ -126,20 +128,19 @@ QStringList CanvasGrid::items(int index) const
         for (const int &idx : d->surfaceIndex())
             ret << items(idx);
     } else { // get items which is in surface \a index
-        auto item = d->itemPos.value(index);
-        ret  << CanvasGridSpecialist::sortItemInGrid(item) << overloadItems(index);
+        ret << d->items(index) << overloadItems(index);
     }
     return ret;
 }
 
 QString CanvasGrid::item(int index, const QPoint &pos) const
 {
-    return d->posItem[index].value(pos);
+    return d->item(GridPos(index, pos));
 }
 
 QHash<QString, QPoint> CanvasGrid::points(int index) const
 {
-    return d->itemPos.value(index);
+    return d->points(index);
 }
 
 bool CanvasGrid::point(const QString &item, QPair<int, QPoint> &pos) const
@@ -147,15 +148,7 @@ bool CanvasGrid::point(const QString &item, QPair<int, QPoint> &pos) const
     if (item.isEmpty())
         return false;
 
-    for (auto itor = d->itemPos.begin(); itor != d->itemPos.end(); ++itor) {
-        if (itor->contains(item)) {
-            pos.first = itor.key();
-            pos.second = itor->value(item);
-            return true;
-        }
-    }
-
-    return false;
+    return d->position(item, pos);
 }
 
 QStringList CanvasGrid::overloadItems(int index) const
@@ -213,7 +206,8 @@ bool CanvasGrid::remove(int index, const QString &item)
     if (Q_UNLIKELY(item.isEmpty()))
         return false;
 
-    if (d->itemPos.value(index).contains(item)) {
+    GridPos pos;
+    if (d->position(item, pos) && pos.first == index) {
         d->remove(index, item);
         requestSync();
         return true;
@@ -327,10 +321,7 @@ CanvasGridPrivate::CanvasGridPrivate(CanvasGrid *qq)
 
 void CanvasGridPrivate::clean()
 {
-    //todo(zy) clear all data and create clean grid
-    posItem.clear();
-    itemPos.clear();
-    overload.clear();
+    clearItems();
 }
 
 void CanvasGridPrivate::sequence(QStringList sortedItems)
@@ -339,23 +330,14 @@ void CanvasGridPrivate::sequence(QStringList sortedItems)
 
     for (int idx : surfaceIndex()) {
         qDebug() << "surface id:" << idx << "left item " << sortedItems.size();
-        QHash<QPoint, QString> allPos;
-        QHash<QString, QPoint> allItem;
         if (!sortedItems.isEmpty()) {
             int max = q->gridCount(idx);
             const int height = surfaces.value(idx).height();
             int cur = 0;
-            for (; cur < max && !sortedItems.isEmpty(); ++cur) {
-                QString &&item = sortedItems.takeFirst();
-                QPoint pos(cur / height, cur % height);
-                allPos.insert(pos, item);
-                allItem.insert(item, pos);
-            }
+            for (; cur < max && !sortedItems.isEmpty(); ++cur)
+                insert(idx, QPoint(cur / height, cur % height), sortedItems.takeFirst());
             qDebug() << "surface" << idx << "drop items count:" << cur << "max" << max;
         }
-
-        itemPos.insert(idx, allItem);
-        posItem.insert(idx, allPos);
     }
     qDebug() << "overload items " << sortedItems.size();
     overload = sortedItems;
@@ -379,6 +361,11 @@ void CanvasGridPrivate::restore(QStringList currentItems)
     // the item's pos in record is invalid to current grid.
     QStringList invalidPos;
 
+    QSet<QString> existed;
+    for (const QString &item : currentItems)
+        existed.insert(item);
+    QSet<QString> restored;
+
     // restore each surface.
     for (int idx : idxs) {
         const QHash<QString, QPoint> &oldPos = profile.value(idx);
@@ -391,7 +378,7 @@ void CanvasGridPrivate::restore(QStringList currentItems)
             // using covertFileUrlToDesktop(itor.key()).toString() to cover it to file://
             QString item = itor.key();
 
-            if (!currentItems.contains(item))
+            if (!existed.contains(item) || restored.contains(item))
                 continue; // item was removed.
 
             const QPoint &pos = itor.value();
@@ -401,15 +388,19 @@ void CanvasGridPrivate::restore(QStringList currentItems)
              else
                 invalidPos.append(item);
 
-            // remove item restored
-            currentItems.removeOne(item);
+            // mark item restored
+            restored.insert(item);
         }
     }
 
     // append invalid-pos and rest items to empty pos
     {
         QStringList overloadItems;
-        overloadItems << invalidPos << currentItems;
+        overloadItems << invalidPos;
+        for (const QString &item : currentItems) {
+            if (!restored.contains(item))
+                overloadItems << item;
+        }
         if (!overloadItems.isEmpty())
             q->append(overloadItems);
     }
@@ -447,17 +438,20 @@ QHash<int, QHash<QString, QPoint> > CanvasGridPrivate::profiles() const
 void CanvasGridPrivate::sync()
 {
     const int count = surfaces.count();
-    if (q->items().isEmpty() || count < 1)
+    if ((itemGrid.isEmpty() && overload.isEmpty()) || count < 1)
         return;
 
+    // only the surfaces changed since last sync are written.
+
     auto idxs = surfaceIndex();
 
     // single mode
     if (count == 1) {
         // update group SingleScreen
-        DispalyIns->setCoordinates(CanvasGridSpecialist::singleIndex,itemPos.value(idxs.first()));
-        // if itemPos's schema is desktop://,
-        // using CanvasGridSpecialist::covertDesktopUrlToFiles(itemPos.value(idxs.first())) to cover it to file://
+        if (changedSurfaces.contains(idxs.first()))
+            DispalyIns->setCoordinates(CanvasGridSpecialist::singleIndex, points(idxs.first()));
+        // if the points schema is desktop://,
+        // using CanvasGridSpecialist::covertDesktopUrlToFiles(points(idxs.first())) to cover it to file://
 
     } else {
         QList<QString> profile;
@@ -467,14 +461,17 @@ void CanvasGridPrivate::sync()
 
             // update group Screen_xx
             // for compatibility. covert "ddecesktop:/" used by code to "file://" used record file.
-            // if itemPos's schema is desktop://,
-            // using CanvasGridSpecialist::covertDesktopUrlToFiles(itemPos.value(idx)) to cover it to file://
-            DispalyIns->setCoordinates(key, itemPos.value(idx));
+            // if the points schema is desktop://,
+            // using CanvasGridSpecialist::covertDesktopUrlToFiles(points(idx)) to cover it to file://
+            if (changedSurfaces.contains(idx))
+                DispalyIns->setCoordinates(key, points(idx));
         }
 
         // update group ProFile
         DispalyIns->setProfile(profile);
     }
+
+    changedSurfaces.clear();
 }
 
 const char *const CanvasGridSpecialist::profilePrefix = "Screen_";
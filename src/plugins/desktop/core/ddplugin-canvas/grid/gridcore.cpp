@@ -4,14 +4,97 @@
 
 #include "gridcore.h"
 
+#include <QDebug>
+
 uint qHash(const QPoint &key, uint seed)
 {
-    QString val = QString("%1x%2").arg(key.x()).arg(key.y());
-    return qHash<QString>(val, seed);
+    return qHash((quint64(quint32(key.x())) << 32) | quint32(key.y()), seed);
 }
 
 using namespace ddplugin_canvas;
 
+GridItemTable *GridItemTable::instance()
+{
+    static GridItemTable ins;
+    return &ins;
+}
+
+int GridItemTable::intern(const QString &item)
+{
+    auto it = ids.constFind(item);
+    if (it != ids.constEnd()) {
+        ref(it.value());
+        return it.value();
+    }
+
+    int id = 0;
+    if (freeIds.isEmpty()) {
+        items.append(item);
+        refs.append(1);
+        id = items.size();
+    } else {
+        id = freeIds.takeLast();
+        items[id - 1] = item;
+        refs[id - 1] = 1;
+    }
+
+    ids.insert(item, id);
+    return id;
+}
+
+void GridItemTable::ref(int id)
+{
+    Q_ASSERT(id > 0 && id <= refs.size() && refs.at(id - 1) > 0);
+    ++refs[id - 1];
+}
+
+void GridItemTable::deref(int id)
+{
+    Q_ASSERT(id > 0 && id <= refs.size() && refs.at(id - 1) > 0);
+    if (--refs[id - 1] > 0)
+        return;
+
+    ids.remove(items.at(id - 1));
+    items[id - 1].clear();
+    freeIds.append(id);
+}
+
+int GridItemTable::id(const QString &item) const
+{
+    return ids.value(item, 0);
+}
+
+QString GridItemTable::item(int id) const
+{
+    return items.value(id - 1);
+}
+
+void GridSurface::reset(const QSize &sz)
+{
+    size = sz;
+    const int total = qMax(0, sz.width()) * qMax(0, sz.height());
+    cells = QVector<int>(total, 0);
+    used = QVector<quint64>((total + 63) / 64, 0);
+    if (total % 64)
+        used.last() = ~quint64(0) << (total % 64);
+    count = 0;
+}
+
+int GridSurface::nextVoid(int from) const
+{
+    from = qMax(0, from);
+    const int first = from >> 6;
+    for (int word = first; word < used.size(); ++word) {
+        quint64 free = ~used.at(word);
+        if (word == first)
+            free &= ~quint64(0) << (from & 63);
+        if (free)
+            return (word << 6) + __builtin_ctzll(free);
+    }
+
+    return -1;
+}
+
 GridCore::GridCore()
 {
 
@@ -19,15 +102,17 @@ GridCore::GridCore()
 
 GridCore::GridCore(const GridCore &other)
     : surfaces(other.surfaces)
-    , posItem(other.posItem)
-    , itemPos(other.itemPos)
+    , grids(other.grids)
+    , itemGrid(other.itemGrid)
     , overload(other.overload)
+    , changedSurfaces(other.changedSurfaces)
 {
+    refItems();
 }
 
 GridCore::~GridCore()
 {
-
+    derefItems();
 }
 
 QList<int> GridCore::surfaceIndex() const
@@ -44,42 +129,72 @@ bool GridCore::applay(GridCore *core)
     if (!core)
         return false;
 
+    // the ids of core are held first, those shared with this one are not freed
+    core->refItems();
+    derefItems();
+
     surfaces = core->surfaces;
-    posItem = core->posItem;
-    itemPos = core->itemPos;
+    grids = core->grids;
+    itemGrid = core->itemGrid;
     overload = core->overload;
+    changedSurfaces = core->changedSurfaces;
     return true;
 }
 
 void GridCore::insert(int index, const QPoint &pos, const QString &it)
 {
-    itemPos[index].insert(it, pos);
-    posItem[index].insert(pos, it);
+    // an item is only on one grid.
+    auto old = itemGrid.constFind(GridItemTable::instance()->id(it));
+    if (old != itemGrid.constEnd())
+        takeCell(old->first, grids[old->first].cellIndex(old->second));
+
+    auto grid = grids.find(index);
+    if (Q_UNLIKELY(grid == grids.end() || !CanvasGridSpecialist::isValid(pos, grid->size))) {
+        qWarning() << "can not insert" << it << "to invalid pos" << index << pos;
+        pushOverload({it});
+        return;
+    }
+
+    // the item on the pos is replaced.
+    const int cell = grid->cellIndex(pos);
+    if (grid->isUsed(cell))
+        takeCell(index, cell);
+
+    const int id = GridItemTable::instance()->intern(it);
+    grid->cells[cell] = id;
+    grid->used[cell >> 6] |= quint64(1) << (cell & 63);
+    ++grid->count;
+    itemGrid.insert(id, GridPos(index, pos));
+    changedSurfaces.insert(index);
 }
 
 void GridCore::remove(int index, const QString &it)
 {
-    auto pos = itemPos[index].take(it);
-    posItem[index].remove(pos);
+    auto pos = itemGrid.constFind(GridItemTable::instance()->id(it));
+    if (pos == itemGrid.constEnd() || pos->first != index)
+        return;
+
+    takeCell(index, grids[index].cellIndex(pos->second));
 }
 
 void GridCore::remove(int index, const QPoint &pos)
 {
-    QString it = posItem[index].take(pos);
-    itemPos[index].remove(it);
+    auto grid = grids.constFind(index);
+    if (grid == grids.constEnd() || !CanvasGridSpecialist::isValid(pos, grid->size))
+        return;
+
+    takeCell(index, grid->cellIndex(pos));
 }
 
 QList<QPoint> GridCore::voidPos(int index) const
 {
     QList<QPoint> ret;
-    const QSize &size = surfaces.value(index, QSize(0, 0));
-    const QHash<QPoint, QString> &usedPos = posItem.value(index);
-    for (int x = 0; x < size.width(); ++x)
-        for (int y = 0; y < size.height(); ++y) {
-            QPoint pos(x, y);
-            if (!usedPos.contains(pos))
-                ret.append(pos);
-        }
+    auto grid = grids.constFind(index);
+    if (grid == grids.constEnd())
+        return ret;
+
+    for (int cell = grid->nextVoid(0); cell >= 0; cell = grid->nextVoid(cell + 1))
+        ret.append(grid->cellPos(cell));
 
     return ret;
 }
@@ -87,23 +202,15 @@ QList<QPoint> GridCore::voidPos(int index) const
 bool GridCore::findVoidPos(GridPos &pos) const
 {
     for (int idx : surfaceIndex()) {
-        const QHash<QPoint, QString> &usedPos = posItem.value(idx);
-        const QSize &size = surfaces.value(idx);
-
-        // no void pos
-        if (isFull(idx))
-            continue;
+        const GridSurface &grid = grids.value(idx);
 
         // find first void pos.
-        for (int x = 0; x < size.width(); ++x)
-            for (int y = 0; y < size.height(); ++y) {
-                QPoint curPos(x, y);
-                if (!usedPos.contains(curPos)) {
-                    pos.first = idx;
-                    pos.second = curPos;
-                    return true;
-                }
-            }
+        const int cell = grid.nextVoid(0);
+        if (cell >= 0) {
+            pos.first = idx;
+            pos.second = grid.cellPos(cell);
+            return true;
+        }
     }
 
     return false;
@@ -111,45 +218,142 @@ bool GridCore::findVoidPos(GridPos &pos) const
 
 bool GridCore::isFull(int index) const
 {
-    const QSize &size = surfaces.value(index, QSize(0, 0));
-    int itemCount = posItem.value(index).count();
-
-    return itemCount >= size.width() * size.height();
+    auto grid = grids.constFind(index);
+    return grid == grids.constEnd() || grid->count >= grid->cells.size();
 }
 
 bool GridCore::position(const QString &it, GridPos &pos) const
 {
-    bool find = false;
-    for (auto itor = itemPos.begin(); itor != itemPos.end(); ++itor) {
-        if (itor.value().contains(it)) {
-            find = true;
-            pos.first = itor.key();
-            pos.second = itor.value().value(it);
-            break;
-        }
-    }
+    auto found = itemGrid.constFind(GridItemTable::instance()->id(it));
+    if (found == itemGrid.constEnd())
+        return false;
 
-    return find;
+    pos = found.value();
+    return true;
 }
 
 QString GridCore::item(const GridPos &pos) const
 {
-    return posItem.value(pos.first).value(pos.second);
+    auto grid = grids.constFind(pos.first);
+    if (grid == grids.constEnd() || !CanvasGridSpecialist::isValid(pos.second, grid->size))
+        return QString();
+
+    const int id = grid->cells.at(grid->cellIndex(pos.second));
+    return id ? GridItemTable::instance()->item(id) : QString();
 }
 
 void GridCore::removeAll(const QStringList &items)
 {
-    for (int index : itemPos.keys()) {
-        for (const QString &it : items) {
+    for (const QString &it : items) {
+        overload.removeAll(it);
 
-            overload.removeAll(it);
+        auto pos = itemGrid.constFind(GridItemTable::instance()->id(it));
+        if (pos == itemGrid.constEnd())
+            continue;
+        takeCell(pos->first, grids[pos->first].cellIndex(pos->second));
+    }
+}
+
+void GridCore::resizeSurface(int index, const QSize &size)
+{
+    const GridSurface old = grids.value(index);
+    surfaces.insert(index, size);
+
+    GridSurface &grid = grids[index];
+    grid.reset(size);
+    changedSurfaces.insert(index);
+
+    // keep the items that still fit, the others are overloaded.
+    QStringList outside;
+    for (int cell = 0; cell < old.cells.size(); ++cell) {
+        const int id = old.cells.at(cell);
+        if (id == 0)
+            continue;
 
-            if (!itemPos[index].contains(it))
-                continue;
-            auto pos = itemPos[index].take(it);
-            posItem[index].remove(pos);
+        const QPoint &pos = old.cellPos(cell);
+        if (CanvasGridSpecialist::isValid(pos, size)) {
+            const int newCell = grid.cellIndex(pos);
+            grid.cells[newCell] = id;
+            grid.used[newCell >> 6] |= quint64(1) << (newCell & 63);
+            ++grid.count;
+        } else {
+            itemGrid.remove(id);
+            outside.append(GridItemTable::instance()->item(id));
+            GridItemTable::instance()->deref(id);
         }
     }
+
+    if (!outside.isEmpty())
+        pushOverload(outside);
+}
+
+QStringList GridCore::items(int index) const
+{
+    // the grids are stored in the order they are shown
+    QStringList ret;
+    const GridSurface &grid = grids.value(index);
+    for (int id : grid.cells) {
+        if (id)
+            ret.append(GridItemTable::instance()->item(id));
+    }
+
+    return ret;
+}
+
+QHash<QString, QPoint> GridCore::points(int index) const
+{
+    QHash<QString, QPoint> ret;
+    const GridSurface &grid = grids.value(index);
+    for (int cell = 0; cell < grid.cells.size(); ++cell) {
+        if (const int id = grid.cells.at(cell))
+            ret.insert(GridItemTable::instance()->item(id), grid.cellPos(cell));
+    }
+
+    return ret;
+}
+
+int GridCore::itemCount(int index) const
+{
+    return grids.value(index).count;
+}
+
+void GridCore::clearItems()
+{
+    for (auto it = grids.begin(); it != grids.end(); ++it) {
+        it->reset(it->size);
+        changedSurfaces.insert(it.key());
+    }
+
+    derefItems();
+    itemGrid.clear();
+    overload.clear();
+}
+
+void GridCore::takeCell(int index, int cell)
+{
+    auto grid = grids.find(index);
+    if (grid == grids.end() || !grid->isUsed(cell))
+        return;
+
+    const int id = grid->cells.at(cell);
+    itemGrid.remove(id);
+    grid->cells[cell] = 0;
+    grid->used[cell >> 6] &= ~(quint64(1) << (cell & 63));
+    --grid->count;
+    changedSurfaces.insert(index);
+    GridItemTable::instance()->deref(id);
+}
+
+void GridCore::refItems() const
+{
+    for (auto it = itemGrid.cbegin(); it != itemGrid.cend(); ++it)
+        GridItemTable::instance()->ref(it.key());
+}
+
+void GridCore::derefItems() const
+{
+    for (auto it = itemGrid.cbegin(); it != itemGrid.cend(); ++it)
+        GridItemTable::instance()->deref(it.key());
 }
 
 
@@ -247,19 +451,19 @@ void AppendOper::tryAppendAfter(QStringList items, int index, const QPoint &begi
 
 QStringList AppendOper::appendAfter(QStringList items, int index, const QPoint &begin)
 {
-    if (items.isEmpty())
+    const int height = surfaceSize(index).height();
+    if (items.isEmpty() || height < 1)
         return items;
 
-    QList<QPoint> posList = voidPos(index);
-    for (const QPoint &pos : posList) {
-        if ((pos.x() > begin.x()) || (pos.x() == begin.x() && pos.y() >= begin.y())) {
-            // all items is appenped
-            if (items.isEmpty())
-                return items;
+    // the void grids after \a begin in the order they are shown
+    int cell = begin.x() < 0 ? 0 : begin.x() * height + qBound(0, begin.y(), height);
+    while (!items.isEmpty()) {
+        cell = grids.value(index).nextVoid(cell);
+        if (cell < 0)
+            break;
 
-            QString &&item = items.takeFirst();
-            insert(index, pos, item);
-        }
+        insert(index, QPoint(cell / height, cell % height), items.takeFirst());
+        ++cell;
     }
 
     return items;
@@ -268,15 +472,11 @@ QStringList AppendOper::appendAfter(QStringList items, int index, const QPoint &
 void AppendOper::append(QStringList items)
 {
     for (int idx : surfaceIndex()) {
-        auto posList = voidPos(idx);
-        for (const QPoint &pos : posList) {
-            // all items is appenped
-            if (items.isEmpty())
-                return;
-
-            QString &&it = items.takeFirst();
-            insert(idx, pos, it);
-        }
+        items = appendAfter(items, idx, QPoint(0, 0));
+
+        // all items is appenped
+        if (items.isEmpty())
+            return;
     }
 
     // overload
@@ -8,13 +8,58 @@
 #include "canvasgridspecialist.h"
 
 #include <QMap>
+#include <QSet>
 #include <QSize>
+#include <QVector>
 
 extern uint qHash(const QPoint &key, uint seed);
 
 namespace ddplugin_canvas {
 
 typedef QPair<int, QPoint> GridPos;
+
+// the paths of items are interned, the grids keep only their ids. every GridCore holds
+// a reference to the ids on its grids, an id is freed and reused when none holds it.
+class GridItemTable
+{
+public:
+    static GridItemTable *instance();
+    int intern(const QString &item);   // the id of the item with a reference taken
+    void ref(int id);
+    void deref(int id);
+    int id(const QString &item) const;   // 0 if the item is on no grid
+    QString item(int id) const;
+    inline int count() const {
+        return ids.size();
+    }
+private:
+    QHash<QString, int> ids;
+    QStringList items;
+    QVector<int> refs;
+    QVector<int> freeIds;
+};
+
+// the occupancy of a surface, the grids are ordered by column as they are shown.
+struct GridSurface
+{
+    QSize size;
+    QVector<int> cells;   // the item id on each grid, 0 is void
+    QVector<quint64> used;   // a bit for each grid, the bits after the last grid are set
+    int count = 0;
+
+    void reset(const QSize &sz);
+    int nextVoid(int from) const;
+    inline int cellIndex(const QPoint &pos) const {
+        return pos.x() * size.height() + pos.y();
+    }
+    inline QPoint cellPos(int cell) const {
+        return QPoint(cell / size.height(), cell % size.height());
+    }
+    inline bool isUsed(int cell) const {
+        return used.at(cell >> 6) & (quint64(1) << (cell & 63));
+    }
+};
+
 class GridCore
 {
 protected:
@@ -34,6 +79,12 @@ public:
     virtual bool position(const QString &item, GridPos &pos) const;
     virtual QString item(const GridPos &pos) const;
     virtual void removeAll(const QStringList &items);
+public:
+    void resizeSurface(int index, const QSize &size);
+    QStringList items(int index) const;
+    QHash<QString, QPoint> points(int index) const;
+    int itemCount(int index) const;
+    void clearItems();
 public:
     inline QSize surfaceSize(int index) const {
         return surfaces.value(index, QSize(0, 0));
@@ -44,17 +95,22 @@ public:
     }
 
     inline bool isVoid(int index, const QPoint &pos) {
-        return !posItem.value(index).contains(pos);
+        return item(GridPos(index, pos)).isEmpty();
     }
 
     inline void pushOverload(const QStringList &items){
         overload.append(items);
     }
+protected:
+    void takeCell(int index, int cell);
+    void refItems() const;
+    void derefItems() const;
 public:
     QMap<int, QSize> surfaces;
-    QMap<int, QHash<QPoint, QString>> posItem;
-    QMap<int, QHash<QString, QPoint>> itemPos;
+    QMap<int, GridSurface> grids;
+    QHash<int, GridPos> itemGrid;   // the position of an item id
     QStringList overload;
+    QSet<int> changedSurfaces;   // to be synced to the profile
 };
 
 class MoveGridOper : public GridCore
@@ -277,27 +277,30 @@ bool CanvasProxyModelPrivate::lessThan(const QUrl &left, const QUrl &right) cons
         }
     }
 
-    QVariant leftData = q->data(leftIdx, fileSortRole);
-    QVariant rightData = q->data(rightIdx, fileSortRole);
-
     // When the selected sort attribute value is the same, sort by file name
-    auto compareByName = [this, leftIdx, rightIdx]() {
-        QString leftName = q->data(leftIdx, kItemFileDisplayNameRole).toString();
-        QString rightName = q->data(rightIdx, kItemFileDisplayNameRole).toString();
-        return FileUtils::compareString(leftName, rightName, fileSortOrder);
+    auto compareByName = [this, leftIdx, rightIdx, leftInfo, rightInfo]() {
+        // the sort key cached on file info is reused unless the name is changed by extend.
+        auto nameKey = [this](const QModelIndex &idx, const DFMLocalFileInfoPointer &info) {
+            const QString &name = q->data(idx, kItemFileDisplayNameRole).toString();
+            const SortKey &key = info->sortKeyOf(DisPlayInfoType::kFileDisplayName);
+            return key.text() == name ? key : SortKey(name);
+        };
+        return FileUtils::compareString(nameKey(leftIdx, leftInfo), nameKey(rightIdx, rightInfo), fileSortOrder);
     };
 
     switch (fileSortRole) {
+    case kItemFileDisplayNameRole:
+        // the names are compared by their sort keys, they are not collated again for each comparison
+        return compareByName();
     case kItemFileLastModifiedRole:
-    case kItemFileMimeTypeRole:
-    case kItemFileDisplayNameRole: {
-        QString leftString = leftData.toString();
-        QString rightString = rightData.toString();
+    case kItemFileMimeTypeRole: {
+        QString leftString = q->data(leftIdx, fileSortRole).toString();
+        QString rightString = q->data(rightIdx, fileSortRole).toString();
         return leftString == rightString ? compareByName() : FileUtils::compareString(leftString, rightString, fileSortOrder);
     }
     case kItemFileSizeRole: {
-        qint64 leftSize = leftData.toLongLong();
-        qint64 rightSize = rightData.toLongLong();
+        qint64 leftSize = q->data(leftIdx, fileSortRole).toLongLong();
+        qint64 rightSize = q->data(rightIdx, fileSortRole).toLongLong();
         return leftSize == rightSize ? compareByName() : ((fileSortOrder == Qt::DescendingOrder) ^ (leftSize < rightSize)) == 0x01;
     }
     default:
@@ -21,14 +21,7 @@ CollectionDataProvider::~CollectionDataProvider()
 
 QString CollectionDataProvider::key(const QUrl &url) const
 {
-    QString ret;
-    for (const CollectionBaseDataPtr &ptr: collections.values()) {
-        if (ptr->items.contains(url)) {
-            ret = ptr->key;
-            break;
-        }
-    }
-    return ret;
+    return itemIndex.value(url).key;
 }
 
 QString CollectionDataProvider::name(const QString &key) const
@@ -56,11 +49,8 @@ QList<QUrl> CollectionDataProvider::items(const QString &key) const
 
 bool CollectionDataProvider::contains(const QString &key, const QUrl &url) const
 {
-    auto it = collections.find(key);
-    if (it == collections.end())
-        return false;
-
-    return (*it)->items.contains(url);
+    auto it = itemIndex.constFind(url);
+    return it != itemIndex.constEnd() && it->key == key;
 }
 
 bool CollectionDataProvider::sorted(const QString &key, const QList<QUrl> &urls)
@@ -74,11 +64,12 @@ bool CollectionDataProvider::sorted(const QString &key, const QList<QUrl> &urls)
 
     // check data, \a all member of urls must be in items.
     for (const QUrl &url : urls) {
-        if (!(*it)->items.contains(url))
+        if (!contains(key, url))
             return false;
     }
 
     (*it)->items = urls;
+    indexItems(*it);
     emit itemsChanged(key);
     return true;
 }
@@ -99,17 +90,17 @@ void CollectionDataProvider::moveUrls(const QList<QUrl> &urls, const QString &ta
         auto it = collections.find(sourceId);
         if (it != collections.end()) {
             for (auto url : urls) {
-                int oldIndex = it.value()->items.indexOf(url);
+                int oldIndex = indexOf(sourceId, url);
                 if (-1 == oldIndex) {
                     qWarning() << "unknow error:" << url << it.value()->items;
                     continue;
                 }
                 if (oldIndex < targetIndex)
                     targetIndex--;
-                it.value()->items.removeOne(url);
+                removeItem(url);
             }
             for (auto url : urls) {
-                it.value()->items.insert(targetIndex++, url);
+                insertItem(sourceId, targetIndex++, url);
             }
             emit itemsChanged(sourceId);
         }
@@ -118,7 +109,8 @@ void CollectionDataProvider::moveUrls(const QList<QUrl> &urls, const QString &ta
         auto it = collections.find(sourceId);
         if (it != collections.end()) {
             for (auto url : urls) {
-                it.value()->items.removeOne(url);
+                if (contains(sourceId, url))
+                    removeItem(url);
             }
             emit itemsChanged(sourceId);
         } else {
@@ -127,7 +119,7 @@ void CollectionDataProvider::moveUrls(const QList<QUrl> &urls, const QString &ta
         it = collections.find(targetKey);
         if (it != collections.end()) {
             for (auto url : urls) {
-                it.value()->items.insert(targetIndex++, url);
+                insertItem(targetKey, targetIndex++, url);
             }
             emit itemsChanged(targetKey);
         }
@@ -136,6 +128,18 @@ void CollectionDataProvider::moveUrls(const QList<QUrl> &urls, const QString &ta
 
 void CollectionDataProvider::addPreItems(const QString &targetKey, const QList<QUrl> &urls, int targetIndex)
 {
+    for (const QUrl &url : urls) {
+        // an url waits for one collection only
+        const QString &old = preItemIndex.value(url);
+        if (!old.isEmpty() && old != targetKey) {
+            auto oldIt = preCollectionItems.find(old);
+            oldIt.value().second.removeAll(url);
+            if (oldIt.value().second.isEmpty())
+                preCollectionItems.erase(oldIt);
+        }
+        preItemIndex.insert(url, targetKey);
+    }
+
     auto it = preCollectionItems.find(targetKey);
     if (it == preCollectionItems.end()) {
         QPair<int, QList<QUrl>> items{targetIndex, urls};
@@ -148,33 +152,123 @@ void CollectionDataProvider::addPreItems(const QString &targetKey, const QList<Q
 
 bool CollectionDataProvider::checkPreItem(const QUrl &url, QString &key, int &index)
 {
-    for (auto it = preCollectionItems.constBegin(); it != preCollectionItems.constEnd(); ++it) {
-        if (it.value().second.contains(url)) {
-            key = it.key();
-            index = it.value().first;
-            return true;
-        }
-    }
+    auto pre = preItemIndex.constFind(url);
+    if (pre == preItemIndex.constEnd())
+        return false;
+
+    auto it = preCollectionItems.constFind(pre.value());
+    if (Q_UNLIKELY(it == preCollectionItems.constEnd()))
+        return false;
 
-    return false;
+    key = it.key();
+    index = it.value().first;
+    return true;
 }
 
 bool CollectionDataProvider::takePreItem(const QUrl &url, QString &key, int &index)
 {
-    for (auto it = preCollectionItems.begin(); it != preCollectionItems.end(); ++it) {
-        if (it.value().second.contains(url)) {
-            key = it.key();
-            // current index will to be used,add it
-            index = it.value().first++;
+    auto pre = preItemIndex.find(url);
+    if (pre == preItemIndex.end())
+        return false;
+
+    auto it = preCollectionItems.find(pre.value());
+    preItemIndex.erase(pre);
+    if (Q_UNLIKELY(it == preCollectionItems.end()))
+        return false;
+
+    key = it.key();
+    // current index will to be used,add it
+    index = it.value().first++;
+
+    it.value().second.removeAll(url);
+    if (it.value().second.isEmpty())
+        preCollectionItems.erase(it);
+
+    return true;
+}
+
+int CollectionDataProvider::indexOf(const QString &key, const QUrl &url) const
+{
+    auto pos = itemIndex.find(url);
+    if (pos == itemIndex.end() || pos->key != key)
+        return -1;
 
-            it.value().second.removeAll(url);
-            if (it.value().second.isEmpty())
-                preCollectionItems.remove(key);
+    auto it = collections.constFind(key);
+    if (Q_UNLIKELY(it == collections.constEnd()))
+        return -1;
 
-            return true;
+    // the items before it are inserted or removed a few at a time,
+    // so the url is searched from the hint outward.
+    const QList<QUrl> &items = it.value()->items;
+    const int hint = qBound(0, pos->hint, items.size());
+    const int range = qMax(hint + 1, items.size() - hint);
+    for (int offset = 0; offset < range; ++offset) {
+        if (hint + offset < items.size() && items.at(hint + offset) == url) {
+            pos->hint = hint + offset;
+            return pos->hint;
+        }
+        if (offset > 0 && hint - offset >= 0 && items.at(hint - offset) == url) {
+            pos->hint = hint - offset;
+            return pos->hint;
         }
     }
 
-    return false;
+    qWarning() << "the index of items is out of sync:" << url << key;
+    return -1;
+}
+
+void CollectionDataProvider::insertItem(const QString &key, int index, const QUrl &url)
+{
+    auto it = collections.find(key);
+    if (it == collections.end())
+        return;
+
+    QList<QUrl> &items = it.value()->items;
+    index = qBound(0, index, items.size());
+    items.insert(index, url);
+    itemIndex.insert(url, ItemPosition { key, index });
+}
+
+QString CollectionDataProvider::removeItem(const QUrl &url)
+{
+    auto pos = itemIndex.constFind(url);
+    if (pos == itemIndex.constEnd())
+        return QString();
+
+    const QString key = pos->key;
+    const int index = indexOf(key, url);
+    if (index >= 0)
+        collections.value(key)->items.removeAt(index);
+
+    itemIndex.remove(url);
+    return key;
+}
+
+QString CollectionDataProvider::replaceItem(const QUrl &oldUrl, const QUrl &newUrl)
+{
+    const QString key = this->key(oldUrl);
+    const int index = indexOf(key, oldUrl);
+    if (index < 0)
+        return QString();
+
+    collections.value(key)->items.replace(index, newUrl);
+    itemIndex.remove(oldUrl);
+    itemIndex.insert(newUrl, ItemPosition { key, index });
+    return key;
+}
+
+void CollectionDataProvider::indexItems(const CollectionBaseDataPtr &base)
+{
+    for (int i = 0; i < base->items.size(); ++i)
+        itemIndex.insert(base->items.at(i), ItemPosition { base->key, i });
+}
+
+void CollectionDataProvider::unindexItems(const CollectionBaseDataPtr &base)
+{
+    for (const QUrl &url : base->items) {
+        auto it = itemIndex.find(url);
+        if (it != itemIndex.end() && it->key == base->key)
+            itemIndex.erase(it);
+    }
 }
 
@@ -11,6 +11,8 @@
 #include <QObject>
 #include <QHash>
 
+#include <climits>
+
 namespace ddplugin_organizer {
 
 class CollectionDataProvider : public QObject
@@ -37,12 +39,30 @@ protected:
     virtual void insert(const QUrl &, const QString &, const int) = 0;
     virtual QString remove(const QUrl &) = 0;
     virtual QString change(const QUrl &) = 0;
+protected:
+    int indexOf(const QString &key, const QUrl &url) const;
+    void insertItem(const QString &key, int index, const QUrl &url);
+    inline void appendItem(const QString &key, const QUrl &url) { insertItem(key, INT_MAX, url); }
+    QString removeItem(const QUrl &url);
+    QString replaceItem(const QUrl &oldUrl, const QUrl &newUrl);
+    void indexItems(const CollectionBaseDataPtr &base);
+    void unindexItems(const CollectionBaseDataPtr &base);
 signals:
     void nameChanged(const QString &key, const QString &name);
     void itemsChanged(const QString &key);
 protected:
     QHash<QString, CollectionBaseDataPtr> collections;
     QHash<QString, QPair<int, QList<QUrl>>> preCollectionItems;
+
+    // the collection of every url and where it was in the items last time, the position
+    // is a hint that is verified on use, so the mutators do not renumber the items after it.
+    struct ItemPosition
+    {
+        QString key;
+        int hint = -1;
+    };
+    mutable QHash<QUrl, ItemPosition> itemIndex;
+    QHash<QUrl, QString> preItemIndex;
 };
 
 }
@@ -27,6 +27,7 @@ void CustomDataHandler::check(const QSet<QUrl> &vaild)
             if (vaild.contains(*it)) {
                 ++it;
             } else {
+                itemIndex.remove(*it);
                 it = iter.value()->items.erase(it);
             }
         }
@@ -44,32 +45,35 @@ bool CustomDataHandler::addBaseData(const CollectionBaseDataPtr &base)
         return false;
 
     collections.insert(base->key, base);
+    indexItems(base);
     return true;
 }
 
 void CustomDataHandler::removeBaseData(const QString &key)
 {
-    collections.remove(key);
+    if (auto base = collections.take(key))
+        unindexItems(base);
 }
 
 bool CustomDataHandler::reset(const QList<CollectionBaseDataPtr> &datas)
 {
-    for (const CollectionBaseDataPtr &ptr : datas)
+    for (const CollectionBaseDataPtr &ptr : datas) {
+        if (auto old = collections.value(ptr->key))
+            unindexItems(old);
         collections.insert(ptr->key, ptr);
+        indexItems(ptr);
+    }
 
     return true;
 }
 
 QString CustomDataHandler::remove(const QUrl &url)
 {
-    for (auto iter = collections.begin(); iter != collections.end(); ++iter) {
-        if (iter.value()->items.removeOne(url)) {
-            emit itemsChanged(iter.key());
-            return iter.key();
-        }
-    }
+    const QString &key = removeItem(url);
+    if (!key.isEmpty())
+        emit itemsChanged(key);
 
-    return "";
+    return key;
 }
 
 QString CustomDataHandler::change(const QUrl &)
@@ -79,40 +83,21 @@ QString CustomDataHandler::change(const QUrl &)
 
 QString CustomDataHandler::replace(const QUrl &oldUrl, const QUrl &newUrl)
 {
-    CollectionBaseDataPtr old;
-    int oldIdx = -1;
-    int newIdx = -1;
-    for (auto iter = collections.begin(); iter != collections.end(); ++iter) {
-        if (oldIdx < 0) {
-            oldIdx = iter.value()->items.indexOf(oldUrl);
-            if (oldIdx >= 0) {
-                // find old
-                old = iter.value();
-            }
-        }
-
-        if (newIdx < 0)
-            newIdx = iter.value()->items.indexOf(newUrl);
-
-        if (oldIdx >= 0 && newIdx >= 0)
-            break;
-    }
-
-    if (oldIdx < 0) {
+    if (!itemIndex.contains(oldUrl)) {
         qWarning() << "replace: no old url:" << oldUrl;
         return "";
     }
 
-    if (newIdx >= 0) {
+    if (itemIndex.contains(newUrl)) {
         qWarning() << "replace: new url is existed:" << newUrl;
         return "";
     }
 
-    Q_ASSERT(old);
-    old->items.replace(oldIdx, newUrl);
-    emit itemsChanged(old->key);
+    const QString &key = replaceItem(oldUrl, newUrl);
+    if (!key.isEmpty())
+        emit itemsChanged(key);
 
-    return old->key;
+    return key;
 }
 
 QString CustomDataHandler::append(const QUrl &)
@@ -133,7 +118,7 @@ void CustomDataHandler::insert(const QUrl &url, const QString &key, const int in
         base->key = key;
         base->items << url;
     } else {
-        it.value()->items.insert(index, url);
+        insertItem(key, index, url);
     }
 
     emit itemsChanged(key);
@@ -144,24 +129,15 @@ bool CustomDataHandler::acceptInsert(const QUrl &url)
     // todo(wcl) 新建流程
 
 
-    for (auto iter = collections.begin(); iter != collections.end(); ++iter) {
-        if (iter.value()->items.contains(url)) {
-           return true;
-        }
-    }
-
-    return false;
+    return itemIndex.contains(url);
 }
 
 QList<QUrl> CustomDataHandler::acceptReset(const QList<QUrl> &urls)
 {
     QList<QUrl> ret;
     for (const QUrl &url : urls) {
-        for (auto iter = collections.begin(); iter != collections.end(); ++iter) {
-            if (iter.value()->items.contains(url)) {
-                ret << url;
-            }
-        }
+        if (itemIndex.contains(url))
+            ret << url;
     }
 
     return ret;
@@ -169,11 +145,5 @@ QList<QUrl> CustomDataHandler::acceptReset(const QList<QUrl> &urls)
 
 bool CustomDataHandler::acceptRename(const QUrl &oldUrl, const QUrl &newUrl)
 {
-    for (auto iter = collections.begin(); iter != collections.end(); ++iter) {
-        if (iter.value()->items.contains(oldUrl)
-                || iter.value()->items.contains(newUrl))
-            return true;
-    }
-
-    return false;
+    return itemIndex.contains(oldUrl) || itemIndex.contains(newUrl);
 }
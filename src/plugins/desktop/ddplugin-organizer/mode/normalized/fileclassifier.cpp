@@ -34,6 +34,7 @@ FileClassifier::FileClassifier(QObject *parent) : CollectionDataProvider(parent)
 void FileClassifier::reset(const QList<QUrl> &urls)
 {
     collections.clear();
+    itemIndex.clear();
     for (const QString &id : classes()) {
         CollectionBaseDataPtr dp(new CollectionBaseData);
         dp->name = className(id);
@@ -51,7 +52,7 @@ void FileClassifier::reset(const QList<QUrl> &urls)
 
         auto it = collections.find(type);
         if (it != collections.end())
-            it.value()->items.append(url);
+            appendItem(type, url);
         else
             Q_ASSERT_X(it == collections.end(), "TypeClassifier", QString("unrecognized type %0").arg(type).toStdString().c_str());
     }
@@ -81,19 +82,18 @@ QString FileClassifier::replace(const QUrl &oldUrl, const QUrl &newUrl)
 
     if (Q_UNLIKELY(newType.isEmpty())) {
         qWarning() << "can not find file:" << newUrl;
-        collections[oldType]->items.removeOne(oldUrl);
+        removeItem(oldUrl);
         return newType;
     }
 
     if (oldType == newType) {
-        int idx = collections[newType]->items.indexOf(oldUrl);
-        collections[newType]->items.replace(idx, newUrl);
+        replaceItem(oldUrl, newUrl);
         emit itemsChanged(newType);
     } else {
-        collections[oldType]->items.removeOne(oldUrl);
+        removeItem(oldUrl);
         emit itemsChanged(oldType);
 
-        collections[newType]->items.append(newUrl);
+        appendItem(newType, newUrl);
         emit itemsChanged(newType);
     }
 #else
@@ -155,17 +155,17 @@ QString FileClassifier::append(const QUrl &url)
     if (cur.isEmpty()) {
         auto it = collections.find(ret);
         if (it != collections.end()) {
-            it.value()->items.append(url);
+            appendItem(ret, url);
             emit itemsChanged(ret);
         } else {
             Q_ASSERT_X(it == collections.end(), "TypeClassifier", QString("unrecognized type %0").arg(ret).toStdString().c_str());
         }
     } else { // existed
         if (cur != ret) {
-            collections[cur]->items.removeOne(url);
+            removeItem(url);
             emit itemsChanged(cur);
 
-            collections[ret]->items.append(url);
+            appendItem(ret, url);
             emit itemsChanged(ret);
         }
     }
@@ -187,17 +187,17 @@ QString FileClassifier::prepend(const QUrl &url)
     if (cur.isEmpty()) {
         auto it = collections.find(ret);
         if (it != collections.end()) {
-            it.value()->items.prepend(url);
+            insertItem(ret, 0, url);
             emit itemsChanged(ret);
         } else {
             Q_ASSERT_X(it == collections.end(), "TypeClassifier", QString("unrecognized type %0").arg(ret).toStdString().c_str());
         }
     } else { // existed
         if (cur != ret) {
-            collections[cur]->items.removeOne(url);
+            removeItem(url);
             emit itemsChanged(cur);
 
-            collections[ret]->items.prepend(url);
+            insertItem(ret, 0, url);
             emit itemsChanged(ret);
         }
     }
@@ -212,15 +212,9 @@ void FileClassifier::insert(const QUrl &, const QString &, const int)
 
 QString FileClassifier::remove(const QUrl &url)
 {
-    QString ret;
-    for (auto itor = collections.begin(); itor != collections.end(); ++itor) {
-        if (itor.value()->items.contains(url)) {
-            itor.value()->items.removeOne(url);
-            ret = itor.key();
-            emit itemsChanged(ret);
-            break;
-        }
-    }
+    QString ret = removeItem(url);
+    if (!ret.isEmpty())
+        emit itemsChanged(ret);
 
     return ret;
 }
@@ -233,10 +227,10 @@ QString FileClassifier::change(const QUrl &url)
 
     QString ret = classify(url);
     if (ret != cur) {
-        collections[cur]->items.removeOne(url);
+        removeItem(url);
         emit itemsChanged(cur);
 
-        collections[ret]->items.append(url);
+        appendItem(ret, url);
         emit itemsChanged(ret);
 
         return ret;
@@ -9,6 +9,7 @@
 #include "utils/fileoperator.h"
 
 #include <QDebug>
+#include <QSet>
 #include <QTime>
 
 using namespace ddplugin_organizer;
@@ -145,16 +146,20 @@ void NormalizedModePrivate::restore(const QList<CollectionBaseDataPtr> &cfgs)
     // order by config
     for (const CollectionBaseDataPtr &cfg : cfgs) {
         if (auto base = classifier->baseData(cfg->key)) {
-            QList<QUrl> org = base->items;
+            QSet<QUrl> org;
+            for (const QUrl &url : base->items)
+                org.insert(url);
             QList<QUrl> ordered;
             for (const QUrl &old : cfg->items) {
-                if (org.contains(old)) {
+                if (org.remove(old))
                     ordered << old;
-                    org.removeOne(old);
-                }
             }
 
-            ordered.append(org);
+            // the ones not in config keep their order, the members are unchanged.
+            for (const QUrl &url : base->items) {
+                if (org.contains(url))
+                    ordered << url;
+            }
             base->items = ordered;
         }
     }
@@ -1530,27 +1530,30 @@ bool CollectionView::lessThan(const QUrl &left, const QUrl &right) const
             return false;
     }
 
-    QVariant leftData = m->data(leftIdx, fileSortRole);
-    QVariant rightData = m->data(rightIdx, fileSortRole);
-
     // When the selected sort attribute value is the same, sort by file name
-    auto compareByName = [fileSortOrder, m, leftIdx, rightIdx]() {
-        QString leftName = m->data(leftIdx, kItemFileDisplayNameRole).toString();
-        QString rightName = m->data(rightIdx, kItemFileDisplayNameRole).toString();
-        return FileUtils::compareString(leftName, rightName, fileSortOrder);
+    auto compareByName = [fileSortOrder, m, leftIdx, rightIdx, leftInfo, rightInfo]() {
+        // the sort key cached on file info is reused unless the name is changed by extend.
+        auto nameKey = [m](const QModelIndex &idx, const DFMLocalFileInfoPointer &info) {
+            const QString &name = m->data(idx, kItemFileDisplayNameRole).toString();
+            const SortKey &key = info->sortKeyOf(DisPlayInfoType::kFileDisplayName);
+            return key.text() == name ? key : SortKey(name);
+        };
+        return FileUtils::compareString(nameKey(leftIdx, leftInfo), nameKey(rightIdx, rightInfo), fileSortOrder);
     };
 
     switch (fileSortRole) {
+    case kItemFileDisplayNameRole:
+        // the names are compared by their sort keys, they are not collated again for each comparison
+        return compareByName();
     case kItemFileLastModifiedRole:
-    case kItemFileMimeTypeRole:
-    case kItemFileDisplayNameRole: {
-        QString leftString = leftData.toString();
-        QString rightString = rightData.toString();
+    case kItemFileMimeTypeRole: {
+        QString leftString = m->data(leftIdx, fileSortRole).toString();
+        QString rightString = m->data(rightIdx, fileSortRole).toString();
         return leftString == rightString ? compareByName() : FileUtils::compareString(leftString, rightString, fileSortOrder);
     }
     case kItemFileSizeRole: {
-        qint64 leftSize = leftData.toLongLong();
-        qint64 rightSize = rightData.toLongLong();
+        qint64 leftSize = m->data(leftIdx, fileSortRole).toLongLong();
+        qint64 rightSize = m->data(rightIdx, fileSortRole).toLongLong();
         return leftSize == rightSize ? compareByName() : ((fileSortOrder == Qt::DescendingOrder) ^ (leftSize < rightSize)) == 0x01;
     }
     default:
@@ -12,11 +12,14 @@
 #include "dfm-base/utils/decorator/decoratorfile.h"
 
 #include <QDir>
+#include <QFileInfo>
 #include <QXmlStreamReader>
 #include <QUrl>
 #include <QMetaType>
 #include <QList>
-#include <QMutexLocker>
+#include <QSet>
+
+#include <algorithm>
 
 DFMBASE_USE_NAMESPACE
 namespace dfmplugin_recent {
@@ -26,53 +29,132 @@ RecentIterateWorker::RecentIterateWorker()
 {
 }
 
+/*!
+ * \brief RecentIterateWorker::doWork parse the xbel again only if its size or mtime
+ * changed, and only the added or modified bookmarks are checked on the disk
+ */
 void RecentIterateWorker::doWork()
 {
+    update(false);
+}
 
-    QFile file(RecentHelper::xbelPath());
-    QList<QUrl> urlList;
-
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QXmlStreamReader reader(&file);
-
-        while (!reader.atEnd()) {
-
-            if (!reader.readNextStartElement() || reader.name() != "bookmark") {
-                continue;
-            }
-
-            const QStringRef &location = reader.attributes().value("href");
-            const QStringRef &readTime = reader.attributes().value("modified");
-
-            if (!location.isEmpty()) {
-                QUrl url = QUrl(location.toString());
-                auto info = InfoFactory::create<AbstractFileInfo>(url, false);
-                if (info && DecoratorFile(url.path()).exists() && info->isAttributes(OptInfoType::kIsFile)) {
-                    const auto &bindPath = FileUtils::bindPathTransform(info->pathOf(PathInfoType::kAbsoluteFilePath), false);
-                    QUrl recentUrl = QUrl::fromLocalFile(bindPath);
-                    recentUrl.setScheme(RecentHelper::scheme());
-                    qint64 readTimeSecs = QDateTime::fromString(readTime.toString(), Qt::ISODate).toSecsSinceEpoch();
-                    urlList.append(recentUrl);
-                    emit updateRecentFileInfo(recentUrl, location.toString(), readTimeSecs);
-                }
-            }
+/*!
+ * \brief RecentIterateWorker::recheck check all the bookmarks on the disk again,
+ * the files may be gone with an unmounted device while the xbel is unchanged
+ */
+void RecentIterateWorker::recheck()
+{
+    update(true);
+}
+
+void RecentIterateWorker::update(bool recheckAll)
+{
+    const QFileInfo xbel(RecentHelper::xbelPath());
+    const qint64 size = xbel.size();
+    const qint64 modified = xbel.lastModified().toMSecsSinceEpoch();
+    const bool xbelChanged = size != xbelSize || modified != xbelModified;
+    if (!xbelChanged && !recheckAll)
+        return;
+
+    QHash<QString, QString> hrefs;
+    if (xbelChanged) {
+        if (!parseXbel(&hrefs))
+            return;
+        xbelSize = size;
+        xbelModified = modified;
+    } else {
+        hrefs.reserve(bookmarks.size());
+        for (auto it = bookmarks.cbegin(); it != bookmarks.cend(); ++it)
+            hrefs.insert(it.key(), it.value().modified);
+    }
+
+    QMap<QUrl, QString> addedUrls;
+    QList<QUrl> updatedUrls;
+    QList<QUrl> removedUrls;
+
+    for (auto it = bookmarks.begin(); it != bookmarks.end();) {
+        if (hrefs.contains(it.key())) {
+            ++it;
+            continue;
         }
-        file.close();
-
-        QList<QUrl> deleteUrls;
-        const auto &recentNodes = RecentManager::instance()->getRecentNodes();
-        for (const QUrl &url : recentNodes.keys()) {
-            if (!urlList.contains(url)) {
-                deleteUrls << url;
-            } else {
-                auto info = recentNodes[url];
-                if (!info) {
-                    deleteUrls << url;
-                }
-            }
+        if (!it.value().recentUrl.isEmpty())
+            removedUrls.append(it.value().recentUrl);
+        it = bookmarks.erase(it);
+    }
+
+    for (auto it = hrefs.cbegin(); it != hrefs.cend(); ++it) {
+        auto bookmark = bookmarks.find(it.key());
+        if (bookmark == bookmarks.end()) {
+            const QUrl &url = recentUrl(it.key());
+            if (url.isValid())
+                addedUrls.insert(url, it.key());
+            bookmarks.insert(it.key(), Bookmark { it.value(), url });
+            continue;
+        }
+
+        if (bookmark.value().modified == it.value() && !recheckAll)
+            continue;
+
+        const QUrl &oldUrl = bookmark.value().recentUrl;
+        const QUrl &url = recentUrl(it.key());
+        if (url.isValid() && url == oldUrl) {
+            updatedUrls.append(url);
+        } else {
+            if (oldUrl.isValid())
+                removedUrls.append(oldUrl);
+            if (url.isValid())
+                addedUrls.insert(url, it.key());
         }
-        if (!deleteUrls.isEmpty())
-            emit deleteExistRecentUrls(deleteUrls);
+        bookmark.value() = Bookmark { it.value(), url };
+    }
+
+    // different hrefs may be bound to the same path
+    if (!removedUrls.isEmpty()) {
+        QSet<QUrl> liveUrls;
+        liveUrls.reserve(bookmarks.size());
+        for (const Bookmark &bookmark : bookmarks)
+            liveUrls.insert(bookmark.recentUrl);
+        removedUrls.erase(std::remove_if(removedUrls.begin(), removedUrls.end(),
+                                         [&liveUrls](const QUrl &url) { return liveUrls.contains(url); }),
+                          removedUrls.end());
     }
+
+    if (!addedUrls.isEmpty() || !updatedUrls.isEmpty() || !removedUrls.isEmpty())
+        emit recentDataChanged(addedUrls, updatedUrls, removedUrls);
+}
+
+// the href -> the modified time of every bookmark, no file is checked
+bool RecentIterateWorker::parseXbel(QHash<QString, QString> *hrefs) const
+{
+    QFile file(RecentHelper::xbelPath());
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    hrefs->reserve(bookmarks.size());
+    QXmlStreamReader reader(&file);
+    while (!reader.atEnd()) {
+        if (!reader.readNextStartElement() || reader.name() != "bookmark")
+            continue;
+
+        const QXmlStreamAttributes &attributes = reader.attributes();
+        const QStringRef &location = attributes.value("href");
+        if (!location.isEmpty())
+            hrefs->insert(location.toString(), attributes.value("modified").toString());
+    }
+    return true;
+}
+
+// the recent url of the file in href, it is empty if the file does not exist
+QUrl RecentIterateWorker::recentUrl(const QString &href) const
+{
+    const QUrl url(href);
+    auto info = InfoFactory::create<AbstractFileInfo>(url, false);
+    if (!info || !DecoratorFile(url.path()).exists() || !info->isAttributes(OptInfoType::kIsFile))
+        return QUrl();
+
+    const auto &bindPath = FileUtils::bindPathTransform(info->pathOf(PathInfoType::kAbsoluteFilePath), false);
+    QUrl recentUrl = QUrl::fromLocalFile(bindPath);
+    recentUrl.setScheme(RecentHelper::scheme());
+    return recentUrl;
 }
 }
@@ -8,6 +8,9 @@
 #include "dfmplugin_recent_global.h"
 
 #include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QUrl>
 
 namespace dfmplugin_recent {
 
@@ -19,10 +22,28 @@ public:
 
 public slots:
     void doWork();
+    void recheck();
 
 signals:
-    void updateRecentFileInfo(const QUrl &url, const QString originPath, qint64 readTime);
-    void deleteExistRecentUrls(const QList<QUrl> &urls);
+    // addedUrls: the recent url -> the href in xbel
+    void recentDataChanged(const QMap<QUrl, QString> &addedUrls, const QList<QUrl> &updatedUrls,
+                           const QList<QUrl> &removedUrls);
+
+private:
+    struct Bookmark
+    {
+        QString modified;
+        QUrl recentUrl;   // empty if the file does not exist
+    };
+
+    void update(bool recheckAll);
+    bool parseXbel(QHash<QString, QString> *hrefs) const;
+    QUrl recentUrl(const QString &href) const;
+
+private:
+    qint64 xbelSize { -1 };
+    qint64 xbelModified { -1 };
+    QHash<QString, Bookmark> bookmarks;   // the href -> the bookmark of the last parsed xbel
 };
 }
 #endif   // RECENTITERATEWORKER_H
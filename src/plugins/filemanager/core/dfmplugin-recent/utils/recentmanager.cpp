@@ -172,11 +172,10 @@ void RecentManager::init()
     iteratorWorker->moveToThread(&workerThread);
     connect(&workerThread, &QThread::finished, iteratorWorker, &QObject::deleteLater);
     connect(this, &RecentManager::asyncHandleFileChanged, iteratorWorker, &RecentIterateWorker::doWork);
+    connect(this, &RecentManager::asyncRecheckRecentFiles, iteratorWorker, &RecentIterateWorker::recheck);
 
-    connect(iteratorWorker, &RecentIterateWorker::updateRecentFileInfo, this,
-            &RecentManager::onUpdateRecentFileInfo);
-    connect(iteratorWorker, &RecentIterateWorker::deleteExistRecentUrls, this,
-            &RecentManager::onDeleteExistRecentUrls);
+    connect(iteratorWorker, &RecentIterateWorker::recentDataChanged, this,
+            &RecentManager::onRecentDataChanged);
 
     workerThread.start();
 
@@ -187,7 +186,7 @@ void RecentManager::init()
     connect(watcher.data(), &AbstractFileWatcher::fileAttributeChanged, this, &RecentManager::updateRecent);
     watcher->startWatcher();
 
-    connect(DevProxyMng, &DeviceProxyManager::protocolDevUnmounted, this, &RecentManager::updateRecent);
+    connect(DevProxyMng, &DeviceProxyManager::protocolDevUnmounted, this, &RecentManager::recheckRecent);
 }
 
 void RecentManager::updateRecent()
@@ -195,30 +194,37 @@ void RecentManager::updateRecent()
     emit asyncHandleFileChanged();
 }
 
-void RecentManager::onUpdateRecentFileInfo(const QUrl &url, const QString originPath, qint64 readTime)
+void RecentManager::recheckRecent()
 {
-    if (!recentNodes.contains(url)) {
-        recentNodes[url] = InfoFactory::create<AbstractFileInfo>(url);
-        recentOriginPaths[url] = originPath;
-        QSharedPointer<AbstractFileWatcher> watcher = WatcherCache::instance().getCacheWatcher(RecentHelper::rootUrl());
-        if (watcher) {
-            emit watcher->subfileCreated(url);
-        }
-    }
-
-    // ToDo(yanghao):update read time
-    Q_UNUSED(readTime)
+    emit asyncRecheckRecentFiles();
 }
 
-void RecentManager::onDeleteExistRecentUrls(const QList<QUrl> &urls)
+void RecentManager::onRecentDataChanged(const QMap<QUrl, QString> &addedUrls, const QList<QUrl> &updatedUrls,
+                                        const QList<QUrl> &removedUrls)
 {
-    for (const auto &url : urls) {
-        if (removeRecentFile(url)) {
-            QSharedPointer<AbstractFileWatcher> watcher = WatcherCache::instance().getCacheWatcher(RecentHelper::rootUrl());
-            if (watcher) {
-                emit watcher->fileDeleted(url);
-            }
-        }
+    QSharedPointer<AbstractFileWatcher> watcher = WatcherCache::instance().getCacheWatcher(RecentHelper::rootUrl());
+
+    for (const auto &url : removedUrls) {
+        if (removeRecentFile(url) && watcher)
+            emit watcher->fileDeleted(url);
+    }
+
+    for (auto it = addedUrls.cbegin(); it != addedUrls.cend(); ++it) {
+        if (recentNodes.contains(it.key()))
+            continue;
+        recentNodes[it.key()] = InfoFactory::create<AbstractFileInfo>(it.key());
+        recentOriginPaths[it.key()] = it.value();
+        if (watcher)
+            emit watcher->subfileCreated(it.key());
+    }
+
+    for (const auto &url : updatedUrls) {
+        const auto &info = recentNodes.value(url);
+        if (!info)
+            continue;
+        info->refresh();
+        if (watcher)
+            emit watcher->fileAttributeChanged(url);
     }
 }
 
@@ -75,6 +75,7 @@ public:
 
 signals:
     void asyncHandleFileChanged();
+    void asyncRecheckRecentFiles();
 
 private:
     explicit RecentManager(QObject *parent = nullptr);
@@ -84,8 +85,9 @@ private:
 
 private slots:
     void updateRecent();
-    void onUpdateRecentFileInfo(const QUrl &url, const QString originPath, qint64 readTime);
-    void onDeleteExistRecentUrls(const QList<QUrl> &urls);
+    void recheckRecent();
+    void onRecentDataChanged(const QMap<QUrl, QString> &addedUrls, const QList<QUrl> &updatedUrls,
+                             const QList<QUrl> &removedUrls);
 
 private:
     QThread workerThread;
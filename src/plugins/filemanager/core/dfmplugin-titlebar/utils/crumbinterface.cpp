@@ -4,6 +4,7 @@
 
 #include "crumbinterface.h"
 #include "utils/titlebarhelper.h"
+#include "utils/foldercompletioncache.h"
 
 #include "dfm-base/base/urlroute.h"
 #include "dfm-base/base/schemefactory.h"
@@ -11,12 +12,26 @@
 
 #include <dfm-framework/event/event.h>
 
+#include <QSet>
+#include <QtConcurrent>
+
 using namespace dfmplugin_titlebar;
 DFMBASE_USE_NAMESPACE
 
+// so many matches of the prefix are sent before the whole dir is listed
+static constexpr int kFirstMatchCount { 10 };
+
 CrumbInterface::CrumbInterface(QObject *parent)
     : QObject(parent)
 {
+    completionPool.setMaxThreadCount(1);
+}
+
+CrumbInterface::~CrumbInterface()
+{
+    if (completionStop)
+        *completionStop = true;
+    completionPool.waitForDone();
 }
 
 void CrumbInterface::setKeepAddressBar(bool keep)
@@ -94,6 +109,7 @@ QList<CrumbData> CrumbInterface::seprateUrl(const QUrl &url)
  * \brief Start request a completion list for address bar auto-completion.
  *
  * \param url The base url need to be completed.
+ * \param prefix The text typed after the base url, its matches are sent first.
  *
  * Since completion list can be long, so we need do async completion. Calling this
  * function will start a completion request and the completion list item will be sent
@@ -101,15 +117,24 @@ QList<CrumbData> CrumbInterface::seprateUrl(const QUrl &url)
  * the transmission isn't completed, you should call cancelCompletionListTransmission.
  * When transmission completed, it will send completionListTransmissionCompleted signal.
  *
+ * The sub dirs of a local dir are listed by name only and cached, see FolderCompletionCache.
+ *
  * \sa completionFound, completionListTransmissionCompleted, cancelCompletionListTransmission
  */
-void CrumbInterface::requestCompletionList(const QUrl &url)
+void CrumbInterface::requestCompletionList(const QUrl &url, const QString &prefix)
 {
     if (folderCompleterJobPointer) {
         folderCompleterJobPointer->disconnect();
         folderCompleterJobPointer->stopAndDeleteLater();
         folderCompleterJobPointer->setParent(nullptr);
     }
+    cancelCompletionListTransmission();
+
+    if (url.scheme() == Global::Scheme::kFile) {
+        requestLocalCompletionList(url.toLocalFile(), prefix);
+        return;
+    }
+
     folderCompleterJobPointer = new TraversalDirThread(url, QStringList(),
                                                        QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::NoIteratorFlags);
     folderCompleterJobPointer->setParent(this);
@@ -124,9 +149,6 @@ void CrumbInterface::requestCompletionList(const QUrl &url)
                 emit completionListTransmissionCompleted();
             },
             Qt::QueuedConnection);
-    // TODO(liyigang): imple follow interfaces
-    //    folderCompleterJobPointer->setTimeCeiling(1000);
-    //    folderCompleterJobPointer->setCountCeiling(500);
     folderCompleterJobPointer->start();
 }
 
@@ -139,6 +161,81 @@ void CrumbInterface::cancelCompletionListTransmission()
 {
     if (folderCompleterJobPointer)
         folderCompleterJobPointer->stop();
+
+    ++completionSerial;
+    if (completionStop)
+        *completionStop = true;
+}
+
+/*!
+ * \brief list the sub dirs of dirPath in the completion pool. The matches of prefix are
+ * sent first, the first ones as soon as they are read, then the rest sorted by name.
+ */
+void CrumbInterface::requestLocalCompletionList(const QString &dirPath, const QString &prefix)
+{
+    const quint64 serial = completionSerial;
+    completionStop.reset(new std::atomic_bool(false));
+    QSharedPointer<std::atomic_bool> stop = completionStop;
+
+    QtConcurrent::run(&completionPool, [this, serial, stop, dirPath, prefix]() {
+        FolderCompletionCache::DirStamp stamp;
+        if (*stop || !FolderCompletionCache::dirStamp(dirPath, &stamp)) {
+            postCompletion(serial, {}, true);
+            return;
+        }
+
+        QStringList names;
+        QSet<QString> sent;
+        if (!FolderCompletionCache::instance()->find(dirPath, stamp, &names)) {
+            QStringList firstMatches;
+            auto found = [&](const QString &name) {
+                names.append(name);
+                if (sent.size() < kFirstMatchCount && name.startsWith(prefix)) {
+                    firstMatches.append(name);
+                    sent.insert(name);
+                }
+                if (firstMatches.size() == kFirstMatchCount) {
+                    postCompletion(serial, firstMatches, false);
+                    firstMatches.clear();
+                }
+            };
+            if (!FolderCompletionCache::readDirNames(dirPath, found, *stop))
+                return;
+
+            // the completer compares the names case sensitively
+            std::sort(names.begin(), names.end());
+            FolderCompletionCache::instance()->insert(dirPath, stamp, names);
+            // too few matches to be sent ahead, they are sent in order with the rest
+            for (const QString &name : firstMatches)
+                sent.remove(name);
+        }
+
+        const QPair<int, int> &range = FolderCompletionCache::prefixRange(names, prefix);
+        QStringList completions;
+        completions.reserve(names.size() - sent.size());
+        for (int i = range.first; i < range.second; ++i) {
+            if (!sent.contains(names.at(i)))
+                completions.append(names.at(i));
+        }
+        completions.append(names.mid(0, range.first));
+        completions.append(names.mid(range.second));
+        postCompletion(serial, completions, true);
+    });
+}
+
+// called in the completion pool, the completions are sent in the thread of this
+void CrumbInterface::postCompletion(quint64 serial, const QStringList &completions, bool completed)
+{
+    QMetaObject::invokeMethod(
+            this, [this, serial, completions, completed]() {
+                if (serial != completionSerial)
+                    return;
+                if (!completions.isEmpty())
+                    emit completionFound(completions);
+                if (completed)
+                    emit completionListTransmissionCompleted();
+            },
+            Qt::QueuedConnection);
 }
 
 void CrumbInterface::onUpdateChildren(QList<AbstractFileInfoPointer> children)
@@ -11,6 +11,10 @@
 
 #include <QObject>
 #include <QPointer>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+#include <atomic>
 
 namespace dfmplugin_titlebar {
 
@@ -27,6 +31,7 @@ public:
     };
 
     explicit CrumbInterface(QObject *parent = nullptr);
+    ~CrumbInterface() override;
 
     void setKeepAddressBar(bool keep);
     void setSupportedScheme(const QString &scheme);
@@ -36,7 +41,7 @@ public:
     void processAction(ActionType type);
     void crumbUrlChangedBehavior(const QUrl &url);
     FAKE_VIRTUAL QList<CrumbData> seprateUrl(const QUrl &url);
-    void requestCompletionList(const QUrl &url);
+    void requestCompletionList(const QUrl &url, const QString &prefix = QString());
     void cancelCompletionListTransmission();
 
 signals:
@@ -51,9 +56,15 @@ private slots:
     void onUpdateChildren(QList<AbstractFileInfoPointer> children);
 
 private:
+    void requestLocalCompletionList(const QString &dirPath, const QString &prefix);
+    void postCompletion(quint64 serial, const QStringList &completions, bool completed);
+
     QString curScheme;
     bool keepAddr { false };
     QPointer<DFMBASE_NAMESPACE::TraversalDirThread> folderCompleterJobPointer;
+    QThreadPool completionPool;   // lists the local dirs
+    QSharedPointer<std::atomic_bool> completionStop;
+    quint64 completionSerial { 0 };   // the completions of other serials are dropped
 };
 
 }
@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "foldercompletioncache.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+using namespace dfmplugin_titlebar;
+
+// so many dirs are cached, the least recently used are removed first
+static constexpr int kMaxCachedDirs { 8 };
+
+bool FolderCompletionCache::DirStamp::operator==(const DirStamp &other) const
+{
+    return dev == other.dev && inode == other.inode
+            && mtimeSec == other.mtimeSec && mtimeNsec == other.mtimeNsec;
+}
+
+FolderCompletionCache *FolderCompletionCache::instance()
+{
+    static FolderCompletionCache ins;
+    return &ins;
+}
+
+bool FolderCompletionCache::find(const QString &dirPath, const DirStamp &stamp, QStringList *names)
+{
+    QMutexLocker lk(&mutex);
+    auto it = entries.find(dirPath);
+    if (it == entries.end())
+        return false;
+
+    if (!(it.value().stamp == stamp)) {
+        entries.erase(it);
+        order.removeOne(dirPath);
+        return false;
+    }
+
+    *names = it.value().names;
+    order.removeOne(dirPath);
+    order.append(dirPath);
+    return true;
+}
+
+/*!
+ * \brief insert the names of the sub dirs of dirPath, stamp must be taken before they
+ * are read, so the entry is invalid if the dir is changed meanwhile. names must be sorted.
+ */
+void FolderCompletionCache::insert(const QString &dirPath, const DirStamp &stamp, const QStringList &names)
+{
+    QMutexLocker lk(&mutex);
+    entries.insert(dirPath, Entry { stamp, names });
+    order.removeOne(dirPath);
+    order.append(dirPath);
+    while (order.size() > kMaxCachedDirs)
+        entries.remove(order.takeFirst());
+}
+
+bool FolderCompletionCache::dirStamp(const QString &dirPath, DirStamp *stamp)
+{
+    struct stat st;
+    if (!stamp || ::stat(QFile::encodeName(dirPath).constData(), &st) != 0 || !S_ISDIR(st.st_mode))
+        return false;
+
+    stamp->dev = static_cast<quint64>(st.st_dev);
+    stamp->inode = static_cast<quint64>(st.st_ino);
+    stamp->mtimeSec = st.st_mtim.tv_sec;
+    stamp->mtimeNsec = st.st_mtim.tv_nsec;
+    return true;
+}
+
+/*!
+ * \brief read the names of the sub dirs in dirPath, hidden ones included. The type is
+ * taken from d_type, only links and unknown types are stat.
+ */
+bool FolderCompletionCache::readDirNames(const QString &dirPath, const std::function<void(const QString &)> &found,
+                                         const std::atomic_bool &stop)
+{
+    DIR *dir = ::opendir(QFile::encodeName(dirPath).constData());
+    if (!dir)
+        return false;
+
+    while (!stop) {
+        const struct dirent *entry = ::readdir(dir);
+        if (!entry)
+            break;
+
+        const char *name = entry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+            continue;
+
+        bool isDir = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            isDir = ::fstatat(::dirfd(dir), name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        if (isDir)
+            found(QFile::decodeName(name));
+    }
+
+    ::closedir(dir);
+    return !stop;
+}
+
+// the range [first, second) of the sorted names that start with prefix
+QPair<int, int> FolderCompletionCache::prefixRange(const QStringList &names, const QString &prefix)
+{
+    auto begin = std::lower_bound(names.cbegin(), names.cend(), prefix);
+    auto end = begin;
+    while (end != names.cend() && end->startsWith(prefix))
+        ++end;
+    return qMakePair(static_cast<int>(begin - names.cbegin()), static_cast<int>(end - names.cbegin()));
+}
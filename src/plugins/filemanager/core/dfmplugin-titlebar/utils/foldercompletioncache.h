@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FOLDERCOMPLETIONCACHE_H
+#define FOLDERCOMPLETIONCACHE_H
+
+#include "dfmplugin_titlebar_global.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QStringList>
+
+#include <atomic>
+#include <functional>
+
+namespace dfmplugin_titlebar {
+
+/*!
+ * \brief The FolderCompletionCache class keeps the sorted names of the sub dirs of the
+ * recently completed local dirs, so that typing in the same dir is answered from memory.
+ * The names are sorted as the completer compares them, a prefix is found by binary search.
+ * An entry is used only if the dev, inode and mtime of the dir are unchanged.
+ */
+class FolderCompletionCache
+{
+    Q_DISABLE_COPY(FolderCompletionCache)
+
+public:
+    struct DirStamp
+    {
+        quint64 dev { 0 };
+        quint64 inode { 0 };
+        qint64 mtimeSec { 0 };
+        qint64 mtimeNsec { 0 };
+
+        bool operator==(const DirStamp &other) const;
+    };
+
+    static FolderCompletionCache *instance();
+
+    bool find(const QString &dirPath, const DirStamp &stamp, QStringList *names);
+    void insert(const QString &dirPath, const DirStamp &stamp, const QStringList &names);
+
+    static bool dirStamp(const QString &dirPath, DirStamp *stamp);
+    static bool readDirNames(const QString &dirPath, const std::function<void(const QString &)> &found,
+                             const std::atomic_bool &stop);
+    static QPair<int, int> prefixRange(const QStringList &names, const QString &prefix);
+
+private:
+    struct Entry
+    {
+        DirStamp stamp;
+        QStringList names;
+    };
+
+    FolderCompletionCache() = default;
+
+private:
+    QMutex mutex;
+    QHash<QString, Entry> entries;
+    QStringList order;   // the most recently used is the last
+};
+
+}
+
+#endif   // FOLDERCOMPLETIONCACHE_H
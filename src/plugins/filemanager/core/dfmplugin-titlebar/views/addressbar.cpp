@@ -268,7 +268,7 @@ void AddressBarPrivate::onIndicatorTriggerd()
     onReturnPressed();
 }
 
-void AddressBarPrivate::requestCompleteByUrl(const QUrl &url)
+void AddressBarPrivate::requestCompleteByUrl(const QUrl &url, const QString &prefix)
 {
     if (!crumbController || !crumbController->isSupportedScheme(url.scheme())) {
         if (crumbController) {
@@ -288,7 +288,7 @@ void AddressBarPrivate::requestCompleteByUrl(const QUrl &url)
         connect(crumbController, &CrumbInterface::completionFound, this, &AddressBarPrivate::appendToCompleterModel);
         connect(crumbController, &CrumbInterface::completionListTransmissionCompleted, this, &AddressBarPrivate::onTravelCompletionListFinished);
     }
-    crumbController->requestCompletionList(url);
+    crumbController->requestCompletionList(url, prefix);
 }
 
 void AddressBarPrivate::completeSearchHistory(const QString &text)
@@ -375,7 +375,7 @@ void AddressBarPrivate::completeLocalPath(const QString &text, const QUrl &url,
     urlCompleter->setCompletionPrefix(text.mid(slashIndex + 1));
 
     // URL completion.
-    requestCompleteByUrl(url);
+    requestCompleteByUrl(url, text.mid(slashIndex + 1));
 }
 
 void AddressBarPrivate::startSpinner()
@@ -79,7 +79,7 @@ public:
     void clearCompleterModel();
     void updateCompletionState(const QString &text);
     void doComplete();
-    void requestCompleteByUrl(const QUrl &url);
+    void requestCompleteByUrl(const QUrl &url, const QString &prefix = QString());
 
     void completeSearchHistory(const QString &text);
     void completeIpAddress(const QString &text);
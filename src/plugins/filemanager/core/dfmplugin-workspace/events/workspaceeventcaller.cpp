@@ -77,7 +77,9 @@ void WorkspaceEventCaller::sendPaintEmblems(QPainter *painter, const QRectF &pai
 
 void WorkspaceEventCaller::sendViewSelectionChanged(const quint64 windowID, const QItemSelection &selected, const QItemSelection &deselected)
 {
-    dpfSignalDispatcher->publish(kEventNS, "signal_View_SelectionChanged", windowID, selected, deselected);
+    // published on every change of the selection, so the event type is resolved only once
+    static const DPF_NAMESPACE::TypedSignal<quint64, QItemSelection, QItemSelection> signal(kEventNS, "signal_View_SelectionChanged");
+    signal.publish(windowID, selected, deselected);
 }
 
 bool WorkspaceEventCaller::sendRenameStartEdit(const quint64 &winId, const QUrl &url)
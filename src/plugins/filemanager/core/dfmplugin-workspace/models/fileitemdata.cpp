@@ -40,6 +40,11 @@ AbstractFileInfoPointer FileItemData::fileInfo() const
     return info;
 }
 
+void FileItemData::setFileInfo(const AbstractFileInfoPointer &info)
+{
+    this->info = info;
+}
+
 FileItemData *FileItemData::parentData() const
 {
     return parent;
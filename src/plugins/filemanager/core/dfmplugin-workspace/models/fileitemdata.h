@@ -23,6 +23,7 @@ public:
 
     void refreshInfo();
     AbstractFileInfoPointer fileInfo() const;
+    void setFileInfo(const AbstractFileInfoPointer &info);
     FileItemData *parentData() const;
 
     QVariant data(int role) const;
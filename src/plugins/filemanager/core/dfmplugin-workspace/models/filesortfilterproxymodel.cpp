@@ -33,6 +33,19 @@ FileSortFilterProxyModel::~FileSortFilterProxyModel()
 {
 }
 
+void FileSortFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    // connected before QSortFilterProxyModel, so the keys are dropped before it sorts again
+    if (sourceModel) {
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &FileSortFilterProxyModel::clearSortKeys);
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &FileSortFilterProxyModel::clearSortKeys);
+        connect(sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, &FileSortFilterProxyModel::clearSortKeys);
+        connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &FileSortFilterProxyModel::clearSortKeys);
+    }
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
 QVariant FileSortFilterProxyModel::headerData(int column, Qt::Orientation, int role) const
 {
     if (role == Qt::DisplayRole) {
@@ -99,6 +112,7 @@ int FileSortFilterProxyModel::columnCount(const QModelIndex &parent) const
 QModelIndex FileSortFilterProxyModel::setRootUrl(const QUrl &url)
 {
     rootUrl = url;
+    clearSortKeys();
 
     workStoped = false;
 
@@ -292,8 +306,10 @@ void FileSortFilterProxyModel::initMixDirAndFile()
 
 void FileSortFilterProxyModel::onChildrenUpdate(const QUrl &url)
 {
-    if (UniversalUtils::urlEquals(url, rootUrl))
+    if (UniversalUtils::urlEquals(url, rootUrl)) {
+        clearSortKeys();
         Q_EMIT modelChildrenUpdated();
+    }
 }
 
 void FileSortFilterProxyModel::onTraverPrehandle(const QUrl &url, const QModelIndex &index, const FileView *view)
@@ -352,67 +368,49 @@ bool FileSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelInd
     if (!right.isValid())
         return false;
 
-    const QModelIndex &leftParent = left.parent();
-    if (!leftParent.isValid() || !UniversalUtils::urlEquals(viewModel()->fileInfo(QModelIndex(), leftParent)->urlOf(UrlInfoType::kUrl), rootUrl))
-        return false;
-    const QModelIndex &rightParent = right.parent();
-    if (!rightParent.isValid() || !UniversalUtils::urlEquals(viewModel()->fileInfo(QModelIndex(), rightParent)->urlOf(UrlInfoType::kUrl), rootUrl))
-        return false;
-
-    const AbstractFileInfoPointer &leftInfo = viewModel()->fileInfo(leftParent, left);
-    const AbstractFileInfoPointer &rightInfo = viewModel()->fileInfo(rightParent, right);
+    // the info and the role data of a row are taken once, not on every comparison
+    if (sortKeysRole != sortRole()) {
+        sortKeys.clear();
+        sortKeysRole = sortRole();
+    }
+    ensureSortKey(left);
+    ensureSortKey(right);
+    const SortInfoKey &leftKey = sortKeys.constFind(left.internalPointer()).value();
+    const SortInfoKey &rightKey = sortKeys.constFind(right.internalPointer()).value();
 
-    if (!leftInfo)
+    if (!leftKey.valid)
         return false;
-    if (!rightInfo)
+    if (!rightKey.valid)
         return false;
 
     // The folder is fixed in the front position
     if (isNotMixDirAndFile) {
-        if (leftInfo->isAttributes(OptInfoType::kIsDir)) {
-            if (!rightInfo->isAttributes(OptInfoType::kIsDir))
+        if (leftKey.isDir) {
+            if (!rightKey.isDir)
                 return sortOrder() == Qt::AscendingOrder;
         } else {
-            if (rightInfo->isAttributes(OptInfoType::kIsDir))
+            if (rightKey.isDir)
                 return sortOrder() == Qt::DescendingOrder;
         }
     }
 
-    QVariant leftData = viewModel()->data(left, sortRole());
-    QVariant rightData = viewModel()->data(right, sortRole());
-
     // When the selected sort attribute value is the same, sort by file name
-    if (leftData == rightData) {
-        QString leftName = viewModel()->data(left, kItemFileDisplayNameRole).toString();
-        QString rightName = viewModel()->data(right, kItemFileDisplayNameRole).toString();
-        return FileUtils::compareString(leftName, rightName, sortOrder());
-    }
+    if (leftKey.data == rightKey.data)
+        return FileUtils::compareString(leftKey.nameKey, rightKey.nameKey, sortOrder());
 
     switch (sortRole()) {
-    case kItemFileDisplayNameRole:
-    case kItemFileLastModifiedRole:
-    case kItemFileMimeTypeRole:
-        return FileUtils::compareString(leftData.toString(), rightData.toString(), sortOrder()) == (sortOrder() == Qt::AscendingOrder);
     case kItemFileSizeRole:
         if (isNotMixDirAndFile) {
-            if (leftInfo->isAttributes(OptInfoType::kIsDir)) {
-                int leftCount = qSharedPointerDynamicCast<AbstractFileInfo>(leftInfo)->countChildFile();
-                int rightCount = qSharedPointerDynamicCast<AbstractFileInfo>(rightInfo)->countChildFile();
-                return leftCount < rightCount;
-            } else {
-                return leftInfo->size() < rightInfo->size();
-            }
+            // both are dirs or both are files here
+            return leftKey.size < rightKey.size;
         } else {
-            qint64 sizel = leftInfo->isAttributes(OptInfoType::kIsDir) && rightInfo->isAttributes(OptInfoType::kIsDir)
-                    ? qSharedPointerDynamicCast<AbstractFileInfo>(leftInfo)->countChildFile()
-                    : (leftInfo->isAttributes(OptInfoType::kIsDir) ? 0 : leftInfo->size());
-            qint64 sizer = leftInfo->isAttributes(OptInfoType::kIsDir) && rightInfo->isAttributes(OptInfoType::kIsDir)
-                    ? qSharedPointerDynamicCast<AbstractFileInfo>(rightInfo)->countChildFile()
-                    : (rightInfo->isAttributes(OptInfoType::kIsDir) ? 0 : rightInfo->size());
+            const bool bothDir = leftKey.isDir && rightKey.isDir;
+            qint64 sizel = bothDir ? leftKey.size : (leftKey.isDir ? 0 : leftKey.size);
+            qint64 sizer = bothDir ? rightKey.size : (rightKey.isDir ? 0 : rightKey.size);
             return sizel < sizer;
         }
     default:
-        return FileUtils::compareString(leftData.toString(), rightData.toString(), sortOrder()) == (sortOrder() == Qt::AscendingOrder);
+        return FileUtils::compareString(leftKey.dataKey, rightKey.dataKey, sortOrder()) == (sortOrder() == Qt::AscendingOrder);
     }
 }
 
@@ -436,6 +434,43 @@ bool FileSortFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex
     return passFileFilters(fileInfo);
 }
 
+FileSortFilterProxyModel::SortInfoKey FileSortFilterProxyModel::makeSortKey(const QModelIndex &index) const
+{
+    SortInfoKey key;
+    const QModelIndex &parent = index.parent();
+    if (!parent.isValid() || !UniversalUtils::urlEquals(viewModel()->fileInfo(QModelIndex(), parent)->urlOf(UrlInfoType::kUrl), rootUrl))
+        return key;
+
+    const AbstractFileInfoPointer &info = viewModel()->fileInfo(parent, index);
+    if (!info)
+        return key;
+
+    key.valid = true;
+    key.isDir = info->isAttributes(OptInfoType::kIsDir);
+    key.data = viewModel()->data(index, sortRole());
+    if (sortRole() == kItemFileSizeRole) {
+        key.size = key.isDir ? info->countChildFile() : info->size();
+        key.nameKey = SortKey(viewModel()->data(index, kItemFileDisplayNameRole).toString());
+    } else {
+        key.dataKey = SortKey(key.data.toString());
+        key.nameKey = sortRole() == kItemFileDisplayNameRole
+                ? key.dataKey
+                : SortKey(viewModel()->data(index, kItemFileDisplayNameRole).toString());
+    }
+    return key;
+}
+
+void FileSortFilterProxyModel::ensureSortKey(const QModelIndex &index) const
+{
+    if (!sortKeys.contains(index.internalPointer()))
+        sortKeys.insert(index.internalPointer(), makeSortKey(index));
+}
+
+void FileSortFilterProxyModel::clearSortKeys()
+{
+    sortKeys.clear();
+}
+
 bool FileSortFilterProxyModel::passFileFilters(const AbstractFileInfoPointer &fileInfo) const
 {
     if (!fileInfo)
@@ -10,8 +10,10 @@
 
 #include "dfm-base/interfaces/abstractfileinfo.h"
 #include "dfm-base/dfm_global_defines.h"
+#include "dfm-base/utils/sortkey.h"
 
 #include <QSortFilterProxyModel>
+#include <QHash>
 #include <QDir>
 
 namespace dfmplugin_workspace {
@@ -25,6 +27,8 @@ public:
     explicit FileSortFilterProxyModel(QObject *parent = nullptr);
     virtual ~FileSortFilterProxyModel() override;
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
     QVariant headerData(int column, Qt::Orientation, int role) const override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
     Qt::DropActions supportedDragActions() const override;
@@ -87,6 +91,21 @@ protected:
     virtual bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
 
 private:
+    // the values lessThan compares, taken once for a row
+    struct SortInfoKey
+    {
+        bool valid { false };   // the row is a child of the root
+        bool isDir { false };
+        qint64 size { 0 };   // the child count of a dir, the size of a file
+        QVariant data;
+        DFMBASE_NAMESPACE::SortKey dataKey;
+        DFMBASE_NAMESPACE::SortKey nameKey;
+    };
+
+    SortInfoKey makeSortKey(const QModelIndex &index) const;
+    void ensureSortKey(const QModelIndex &index) const;
+    void clearSortKeys();
+
     bool passFileFilters(const AbstractFileInfoPointer &info) const;
     bool passNameFilters(const AbstractFileInfoPointer &info) const;
     bool isDefaultHiddenFile(const AbstractFileInfoPointer &info) const;
@@ -103,6 +122,10 @@ private:
     QStringList nameFilters;
     mutable QMap<QUrl, bool> nameFiltersMatchResultMap;
 
+    // keyed by the item data of the source index, valid for sortKeysRole
+    mutable QHash<const void *, SortInfoKey> sortKeys;
+    mutable int sortKeysRole { -1 };
+
     bool readOnly = false;
     bool isPrehandling = false;
 
@@ -49,6 +49,8 @@ void RootInfo::startWatcher()
                 this, &RootInfo::doFileDeleted);
         connect(watcher.data(), &AbstractFileWatcher::subfileCreated,
                 this, &RootInfo::dofileCreated);
+        connect(watcher.data(), &AbstractFileWatcher::subfilesCreated,
+                this, &RootInfo::dofilesCreated);
         connect(watcher.data(), &AbstractFileWatcher::fileAttributeChanged,
                 this, &RootInfo::doFileUpdated);
         connect(watcher.data(), &AbstractFileWatcher::fileRename,
@@ -131,6 +133,13 @@ void RootInfo::dofileCreated(const QUrl &url)
     metaObject()->invokeMethod(this, QT_STRINGIFY(doWatcherEvent), Qt::QueuedConnection);
 }
 
+void RootInfo::dofilesCreated(const QList<QUrl> &urls)
+{
+    for (const auto &url : urls)
+        enqueueEvent(QPair<QUrl, EventType>(url, kAddFile));
+    metaObject()->invokeMethod(this, QT_STRINGIFY(doWatcherEvent), Qt::QueuedConnection);
+}
+
 void RootInfo::doFileUpdated(const QUrl &url)
 {
     AbstractFileInfoPointer info = InfoCacheController::instance().getCacheInfo(url);
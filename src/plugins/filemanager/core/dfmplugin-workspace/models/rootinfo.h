@@ -50,6 +50,7 @@ public Q_SLOTS:
     void doFileDeleted(const QUrl &url);
     void dofileMoved(const QUrl &fromUrl, const QUrl &toUrl);
     void dofileCreated(const QUrl &url);
+    void dofilesCreated(const QList<QUrl> &urls);
     void doFileUpdated(const QUrl &url);
     void doWatcherEvent();
 
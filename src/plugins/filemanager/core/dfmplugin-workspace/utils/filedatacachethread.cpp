@@ -14,6 +14,7 @@ using namespace dfmplugin_workspace;
 FileDataCacheThread::FileDataCacheThread(RootInfo *r)
     : root(r)
 {
+    loadTimer.start();
 }
 
 FileDataCacheThread::~FileDataCacheThread()
@@ -26,9 +27,12 @@ void FileDataCacheThread::stop()
     {
         QMutexLocker lk(&fileQueueMutex);
         fileQueue.clear();
+        snapshotQueue.clear();
+        removeQueue.clear();
+        stoped = true;
+        fileQueueCondition.wakeAll();
     }
 
-    stoped = true;
     wait();
     isTraversalFinished = false;
     stoped = false;
@@ -50,6 +54,14 @@ AbstractFileInfoPointer FileDataCacheThread::dequeueFileQueue()
     return fileQueue.dequeue();
 }
 
+QList<AbstractFileInfoPointer> FileDataCacheThread::dequeueAllFileQueue()
+{
+    QMutexLocker lk(&fileQueueMutex);
+    QList<AbstractFileInfoPointer> children = fileQueue;
+    fileQueue.clear();
+    return children;
+}
+
 int FileDataCacheThread::childrenCount()
 {
     QReadLocker lk(&childrenLock);
@@ -63,55 +75,104 @@ bool FileDataCacheThread::containsChild(const QUrl &url)
 }
 
 void FileDataCacheThread::onHandleAddFile(const AbstractFileInfoPointer child)
+{
+    onHandleAddFiles({ child });
+}
+
+void FileDataCacheThread::onHandleAddFiles(const QList<AbstractFileInfoPointer> children)
 {
     {
         QMutexLocker lk(&fileQueueMutex);
-        fileQueue.enqueue(child);
+        fileQueue.append(children);
+        fileQueueCondition.wakeAll();
     }
 
-    if (!isRunning()) {
-        stoped = false;
-        start();
+    startRunning();
+}
+
+void FileDataCacheThread::onHandleAddSnapshot(const QList<AbstractFileInfoPointer> children)
+{
+    {
+        QMutexLocker lk(&fileQueueMutex);
+        snapshotQueue.append(children);
+        fileQueueCondition.wakeAll();
     }
+
+    startRunning();
+}
+
+void FileDataCacheThread::onHandleRemoveSnapshot(const QList<QUrl> urls)
+{
+    {
+        QMutexLocker lk(&fileQueueMutex);
+        removeQueue.append(urls);
+        fileQueueCondition.wakeAll();
+    }
+
+    startRunning();
 }
 
 void FileDataCacheThread::onHandleTraversalFinished()
 {
-    isTraversalFinished = true;
+    {
+        QMutexLocker lk(&fileQueueMutex);
+        isTraversalFinished = true;
+        fileQueueCondition.wakeAll();
+    }
     QApplication::restoreOverrideCursor();
 }
 
 void FileDataCacheThread::run()
 {
-    AbstractFileInfoPointer child;
-    QList<AbstractFileInfoPointer> needInsertList;
-
-    while (!fileQueueEmpty() || !isTraversalFinished) {
-        if (stoped)
-            return;
-
-        child = dequeueFileQueue();
-        if (!child)
-            continue;
-
-        if (!isTraversalFinished) {
-            addChildren({ child });
-        } else if (isTraversalFinished && !fileQueueEmpty()) {
-            needInsertList.append(child);
-        } else {
-            needInsertList.append(child);
+    forever {
+        QList<AbstractFileInfoPointer> snapshot;
+        QList<AbstractFileInfoPointer> children;
+        QList<QUrl> removed;
+        {
+            // sleep until the traversal delivers a batch or finishes
+            QMutexLocker lk(&fileQueueMutex);
+            while (fileQueue.isEmpty() && snapshotQueue.isEmpty() && removeQueue.isEmpty()
+                   && !isTraversalFinished && !stoped)
+                fileQueueCondition.wait(&fileQueueMutex);
+
+            if (stoped)
+                return;
+
+            if (fileQueue.isEmpty() && snapshotQueue.isEmpty() && removeQueue.isEmpty() && isTraversalFinished)
+                break;
+
+            // the snapshot is always delivered before the enumerated children
+            snapshot.swap(snapshotQueue);
+            children = fileQueue;
+            fileQueue.clear();
+            removed.swap(removeQueue);
         }
+
+        addChildren(snapshot, true);
+        addChildren(children);
+        removeChildren(removed);
     }
 
-    if (needInsertList.count() > 0)
-        addChildren(needInsertList);
+    qInfo() << "file data load finished, count: " << childrenCount() << " url: " << root->url
+            << " elapsed: " << loadTimer.elapsed();
 
     Q_EMIT requestSetIdle();
 }
 
-void FileDataCacheThread::addChildren(const QList<AbstractFileInfoPointer> &children)
+void FileDataCacheThread::startRunning()
 {
-    int count = childrenCount();
+    if (!isRunning()) {
+        stoped = false;
+        start();
+    }
+}
+
+void FileDataCacheThread::addChildren(const QList<AbstractFileInfoPointer> &children, bool fromSnapshot)
+{
+    QList<QUrl> urls;
+    QList<FileItemData *> datas;
+    QSet<QUrl> batchUrls;
+    QList<AbstractFileInfoPointer> updatedInfos;
 
     for (const auto &child : children) {
         if (stoped)
@@ -123,28 +184,38 @@ void FileDataCacheThread::addChildren(const QList<AbstractFileInfoPointer> &chil
         auto url = child->urlOf(dfmbase::UrlInfoType::kUrl);
         url.setPath(url.path());
 
-        if (containsChild(url))
+        if (batchUrls.contains(url))
+            continue;
+
+        if (containsChild(url)) {
+            // the row shown from the snapshot gets the enumerated info
+            if (!fromSnapshot && snapshotChildren.remove(url))
+                updatedInfos.append(child);
             continue;
+        }
 
         FileItemData *data = new FileItemData(url, child);
         data->setParentData(root->data);
+        batchUrls.insert(url);
+        urls.append(url);
+        datas.append(data);
+    }
 
-        root->insert(root->rowIndex, count, 1);
-
-        QWriteLocker lk(&childrenLock);
-        childrenUrlList.append(url);
-        chilrenDataMap.insert(url, data);
-        lk.unlock();
+    insertChildren(urls, datas);
 
-        root->insertFinish();
+    if (fromSnapshot)
+        snapshotChildren.unite(batchUrls);
 
-        ++count;
-    }
+    if (!updatedInfos.isEmpty())
+        QMetaObject::invokeMethod(
+                this, [this, updatedInfos]() { updateChildrenInfo(updatedInfos); }, Qt::QueuedConnection);
 }
 
 void FileDataCacheThread::addChildrenByUrl(const QList<QUrl> &children)
 {
-    int count = childrenCount();
+    QList<QUrl> urls;
+    QList<FileItemData *> datas;
+    QSet<QUrl> batchUrls;
 
     for (auto url : children) {
         if (stoped)
@@ -155,44 +226,103 @@ void FileDataCacheThread::addChildrenByUrl(const QList<QUrl> &children)
 
         url.setPath(url.path());
 
-        if (containsChild(url))
+        if (batchUrls.contains(url) || containsChild(url))
             continue;
 
         FileItemData *data = new FileItemData(url);
         data->setParentData(root->data);
+        batchUrls.insert(url);
+        urls.append(url);
+        datas.append(data);
+    }
+
+    insertChildren(urls, datas);
+}
+
+void FileDataCacheThread::insertChildren(const QList<QUrl> &urls, const QList<FileItemData *> &datas)
+{
+    if (urls.isEmpty())
+        return;
 
-        root->insert(root->rowIndex, count, 1);
+    // the whole batch is inserted to the model as one range
+    int count = childrenCount();
+    root->insert(root->rowIndex, count, urls.count());
 
-        QWriteLocker lk(&childrenLock);
-        childrenUrlList.append(url);
-        chilrenDataMap.insert(url, data);
-        lk.unlock();
+    QWriteLocker lk(&childrenLock);
+    childrenUrlList.append(urls);
+    for (int i = 0; i < urls.count(); ++i)
+        chilrenDataMap.insert(urls.at(i), datas.at(i));
+    lk.unlock();
 
-        root->insertFinish();
+    root->insertFinish();
 
-        ++count;
+    if (!firstBatchInserted) {
+        firstBatchInserted = true;
+        qInfo() << "file data first batch inserted, count: " << urls.count() << " url: " << root->url
+                << " elapsed: " << loadTimer.elapsed();
     }
 }
 
+// the infos are set on the main thread, where the rows are read
+void FileDataCacheThread::updateChildrenInfo(const QList<AbstractFileInfoPointer> &infos)
+{
+    {
+        QReadLocker lk(&childrenLock);
+        for (const auto &info : infos) {
+            auto url = info->urlOf(dfmbase::UrlInfoType::kUrl);
+            url.setPath(url.path());
+            FileItemData *data = chilrenDataMap.value(url);
+            if (data)
+                data->setFileInfo(info);
+        }
+    }
+
+    Q_EMIT root->childrenUpdate(root->url);
+}
+
 void FileDataCacheThread::removeChildren(const QList<QUrl> &urls)
 {
+    if (urls.isEmpty())
+        return;
+
+    QSet<QUrl> removedUrls;
+    removedUrls.reserve(urls.count());
     for (QUrl url : urls) {
         url.setPath(url.path());
-        int childIndex = -1;
-        {
-            QReadLocker lk(&childrenLock);
-            childIndex = childrenUrlList.indexOf(url);
-        }
+        removedUrls.insert(url);
+    }
 
-        if (childIndex == -1)
+    // the removed rows are dropped in one pass, the model is told of each range of them
+    QList<QPair<int, int>> ranges;
+    QWriteLocker lk(&childrenLock);
+    QList<QUrl> keptUrls;
+    keptUrls.reserve(childrenUrlList.count());
+    for (int i = 0; i < childrenUrlList.count(); ++i) {
+        const QUrl &url = childrenUrlList.at(i);
+        if (!removedUrls.contains(url)) {
+            keptUrls.append(url);
             continue;
+        }
+
+        FileItemData *data = chilrenDataMap.take(url);
+        if (data)
+            data->deleteLater();
+
+        if (!ranges.isEmpty() && ranges.last().first + ranges.last().second == i)
+            ++ranges.last().second;
+        else
+            ranges.append(qMakePair(i, 1));
+    }
+
+    if (ranges.isEmpty())
+        return;
+
+    childrenUrlList.swap(keptUrls);
+    lk.unlock();
 
-        root->remove(root->rowIndex, childIndex, 1);
-        QWriteLocker lk(&childrenLock);
-        childrenUrlList.removeOne(url);
-        chilrenDataMap[url]->deleteLater();
-        chilrenDataMap.remove(url);
-        lk.unlock();
+    // the last range first, so that the indexes of the earlier ones are kept
+    for (int i = ranges.count() - 1; i >= 0; --i) {
+        root->remove(root->rowIndex, ranges.at(i).first, ranges.at(i).second);
         root->removeFinish();
     }
 }
@@ -218,6 +348,7 @@ void FileDataCacheThread::clearChildren()
     childrenUrlList.clear();
     qDeleteAll(chilrenDataMap.values());
     chilrenDataMap.clear();
+    snapshotChildren.clear();
     lk.unlock();
     root->removeFinish();
 }
@@ -9,9 +9,12 @@
 #include "dfm-base/interfaces/abstractfileinfo.h"
 
 #include <QQueue>
+#include <QSet>
 #include <QThread>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QWaitCondition>
+#include <QElapsedTimer>
 
 namespace dfmplugin_workspace {
 class RootInfo;
@@ -29,11 +32,12 @@ public:
 
     bool fileQueueEmpty();
     AbstractFileInfoPointer dequeueFileQueue();
+    QList<AbstractFileInfoPointer> dequeueAllFileQueue();
 
     int childrenCount();
     bool containsChild(const QUrl &url);
 
-    void addChildren(const QList<AbstractFileInfoPointer> &children);
+    void addChildren(const QList<AbstractFileInfoPointer> &children, bool fromSnapshot = false);
     void addChildrenByUrl(const QList<QUrl> &children);
     void removeChildren(const QList<QUrl> &urls);
 
@@ -44,6 +48,9 @@ public:
 
 public Q_SLOTS:
     void onHandleAddFile(const AbstractFileInfoPointer child);
+    void onHandleAddFiles(const QList<AbstractFileInfoPointer> children);
+    void onHandleAddSnapshot(const QList<AbstractFileInfoPointer> children);
+    void onHandleRemoveSnapshot(const QList<QUrl> urls);
     void onHandleTraversalFinished();
 
 Q_SIGNALS:
@@ -51,14 +58,27 @@ Q_SIGNALS:
 
 private:
     void run() override;
+    void startRunning();
+    void insertChildren(const QList<QUrl> &urls, const QList<FileItemData *> &datas);
+    void updateChildrenInfo(const QList<AbstractFileInfoPointer> &infos);
 
 private:
     QAtomicInteger<bool> isTraversalFinished { false };
-    bool stoped { false };
+    QAtomicInteger<bool> stoped { false };
 
     QQueue<AbstractFileInfoPointer> fileQueue;
+    // the snapshot children and the stale ones of them, handled by run() with fileQueue
+    QList<AbstractFileInfoPointer> snapshotQueue;
+    QList<QUrl> removeQueue;
+    // the rows inserted from the snapshot, which the enumeration has not found yet
+    QSet<QUrl> snapshotChildren;
 
     QMutex fileQueueMutex;
+    QWaitCondition fileQueueCondition;
+
+    // time from the start of loading to the first and the last insertion
+    QElapsedTimer loadTimer;
+    bool firstBatchInserted { false };
 
     QReadWriteLock childrenLock;
     QList<QUrl> childrenUrlList;
@@ -114,8 +114,14 @@ void FileDataHelper::doTravers(const int rootIndex)
         }
         info->fileCache.reset(new FileDataCacheThread(info));
 
-        connect(info->traversal.data(), &TraversalDirThread::updateChild,
-                info->fileCache.data(), &FileDataCacheThread::onHandleAddFile,
+        connect(info->traversal.data(), &TraversalDirThread::updateChildrenSnapshot,
+                info->fileCache.data(), &FileDataCacheThread::onHandleAddSnapshot,
+                Qt::QueuedConnection);
+        connect(info->traversal.data(), &TraversalDirThread::updateChildrenBatch,
+                info->fileCache.data(), &FileDataCacheThread::onHandleAddFiles,
+                Qt::QueuedConnection);
+        connect(info->traversal.data(), &TraversalDirThread::removeChildrenSnapshot,
+                info->fileCache.data(), &FileDataCacheThread::onHandleRemoveSnapshot,
                 Qt::QueuedConnection);
         connect(info->traversal.data(), &TraversalDirThread::updateChildren,
                 this, [this, info](QList<AbstractFileInfoPointer> children) {
@@ -252,6 +258,8 @@ TraversalThreadPointer FileDataHelper::setTraversalThread(RootInfo *info)
             info->url, QStringList(),
             QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System | QDir::Hidden,
             QDirIterator::FollowSymlinks));
+    // the view shows the snapshot of last visit while the dir is enumerated
+    traversal->setSnapshotEnabled(true);
 
     info->traversal = traversal;
     return traversal;
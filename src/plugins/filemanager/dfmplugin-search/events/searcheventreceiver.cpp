@@ -59,6 +59,51 @@ void SearchEventReceiver::handleAddressInputStr(quint64 windId, QString *str)
     }
 }
 
+void SearchEventReceiver::handleCopyFilesResult(const QList<QUrl> &srcUrls, const QList<QUrl> &destUrls, bool ok, const QString &errMsg)
+{
+    Q_UNUSED(srcUrls)
+    Q_UNUSED(ok)
+    Q_UNUSED(errMsg)
+
+    SearchManager::instance()->updateFullTextIndex(destUrls);
+}
+
+void SearchEventReceiver::handleCutFilesResult(const QList<QUrl> &srcUrls, const QList<QUrl> &destUrls, bool ok, const QString &errMsg)
+{
+    Q_UNUSED(ok)
+    Q_UNUSED(errMsg)
+
+    SearchManager::instance()->updateFullTextIndex(srcUrls + destUrls);
+}
+
+void SearchEventReceiver::handleDeleteFilesResult(const QList<QUrl> &srcUrls, bool ok, const QString &errMsg)
+{
+    Q_UNUSED(ok)
+    Q_UNUSED(errMsg)
+
+    SearchManager::instance()->updateFullTextIndex(srcUrls);
+}
+
+void SearchEventReceiver::handleRenameFileResult(quint64 winId, const QMap<QUrl, QUrl> &renamedUrls, bool ok, const QString &errMsg)
+{
+    Q_UNUSED(winId)
+    Q_UNUSED(ok)
+    Q_UNUSED(errMsg)
+
+    SearchManager::instance()->updateFullTextIndex(renamedUrls.keys() + renamedUrls.values());
+}
+
+void SearchEventReceiver::handleRestoreFromTrashResult(const QList<QUrl> &srcUrls, const QList<QUrl> &destUrls,
+                                                       const QVariantList &customInfos, bool ok, const QString &errMsg)
+{
+    Q_UNUSED(srcUrls)
+    Q_UNUSED(customInfos)
+    Q_UNUSED(ok)
+    Q_UNUSED(errMsg)
+
+    SearchManager::instance()->updateFullTextIndex(destUrls);
+}
+
 SearchEventReceiver::SearchEventReceiver(QObject *parent)
     : QObject(parent)
 {
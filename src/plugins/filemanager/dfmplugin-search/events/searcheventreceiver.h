@@ -8,6 +8,8 @@
 #include "dfmplugin_search_global.h"
 
 #include <QObject>
+#include <QUrl>
+#include <QVariant>
 
 #define SearchEventReceiverIns DPSEARCH_NAMESPACE::SearchEventReceiver::instance()
 
@@ -27,6 +29,14 @@ public slots:
     void handleUrlChanged(quint64 winId, const QUrl &u);
     void handleAddressInputStr(quint64 windId, QString *str);
 
+    // keep the full-text index up to date with the file operations
+    void handleCopyFilesResult(const QList<QUrl> &srcUrls, const QList<QUrl> &destUrls, bool ok, const QString &errMsg);
+    void handleCutFilesResult(const QList<QUrl> &srcUrls, const QList<QUrl> &destUrls, bool ok, const QString &errMsg);
+    void handleDeleteFilesResult(const QList<QUrl> &srcUrls, bool ok, const QString &errMsg);
+    void handleRenameFileResult(quint64 winId, const QMap<QUrl, QUrl> &renamedUrls, bool ok, const QString &errMsg);
+    void handleRestoreFromTrashResult(const QList<QUrl> &srcUrls, const QList<QUrl> &destUrls,
+                                      const QVariantList &customInfos, bool ok, const QString &errMsg);
+
 private:
     explicit SearchEventReceiver(QObject *parent = nullptr);
 };
@@ -122,6 +122,18 @@ void Search::bindEvents()
                                    SearchEventReceiverIns, &SearchEventReceiver::handleUrlChanged);
     dpfSignalDispatcher->subscribe("dfmplugin_titlebar", "signal_InputAdddressStr_Check",
                                    SearchEventReceiverIns, &SearchEventReceiver::handleAddressInputStr);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kCopyResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleCopyFilesResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kCutFileResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleCutFilesResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kDeleteFilesResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleDeleteFilesResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kMoveToTrashResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleDeleteFilesResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kRenameFileResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleRenameFileResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kRestoreFromTrashResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleRestoreFromTrashResult);
 
     // connect self slot events
     static constexpr auto selfSpace { DPF_MACRO_TO_STR(DPSEARCH_NAMESPACE) };
@@ -6,8 +6,11 @@
 #include "searchmanager/searcher/fulltext/fulltextsearcher.h"
 
 #include "dfm-base/base/application/settings.h"
+#include "dfm-base/base/application/application.h"
+#include "dfm-base/base/schemefactory.h"
 
 #include <QFileSystemWatcher>
+#include <QTimer>
 #include <QApplication>
 #include <QtConcurrent>
 #include <QUrl>
@@ -17,6 +20,9 @@
 DFMBASE_USE_NAMESPACE
 DPSEARCH_USE_NAMESPACE
 
+// so many searched dirs are watched for the full-text index
+static constexpr int kMaxIndexWatchers { 16 };
+
 MainController::MainController(QObject *parent)
     : QObject(parent)
 {
@@ -39,6 +45,12 @@ void MainController::init()
     auto configPath = QDir::home().absoluteFilePath(".config/deepin/dde-file-manager.json");
     fileWatcher->addPath(configPath);
     connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, &MainController::onFileChanged);
+
+    // changed files are collected and indexed in one batch
+    indexTimer = new QTimer(this);
+    indexTimer->setSingleShot(true);
+    indexTimer->setInterval(1000);
+    connect(indexTimer, &QTimer::timeout, this, &MainController::onIndexTimeout);
 }
 
 void MainController::stop(QString taskId)
@@ -66,8 +78,11 @@ bool MainController::doSearchTask(QString taskId, const QUrl &url, const QString
     connect(task, &TaskCommander::matched, this, &MainController::matched, Qt::DirectConnection);
     connect(task, &TaskCommander::finished, this, &MainController::onFinished, Qt::DirectConnection);
 
-    if (task->start())
+    if (task->start()) {
+        if (FullTextSearcher::isSupport(url))
+            watchIndexDir(url);
         return true;
+    }
 
     qWarning() << "fail to start task " << task << task->taskID();
     task->deleteSelf();
@@ -82,6 +97,62 @@ QList<QUrl> MainController::getResults(QString taskId)
     return {};
 }
 
+void MainController::updateIndex(const QList<QUrl> &urls)
+{
+    if (!Application::genericAttribute(Application::kIndexFullTextSearch).toBool())
+        return;
+
+    for (const auto &url : urls) {
+        if (url.isLocalFile())
+            pendingIndexPaths << url.toLocalFile();
+    }
+
+    if (!pendingIndexPaths.isEmpty())
+        indexTimer->start();
+}
+
+/*!
+ * \brief watchIndexDir watches the searched dir, the files created, modified or removed in it
+ * by other applications are queued for the full-text index as the ones changed in file manager,
+ * so the index is updated in background. The changes deeper in the tree are found by the
+ * manifest check of the next search.
+ */
+void MainController::watchIndexDir(const QUrl &url)
+{
+    if (!url.isLocalFile())
+        return;
+
+    indexWatcherOrder.removeOne(url);
+    indexWatcherOrder.append(url);
+    if (!indexWatchers.contains(url)) {
+        // a watcher of its own, the shared ones of the views can not be stopped here
+        const AbstractFileWatcherPointer &watcher = WatcherFactory::create<AbstractFileWatcher>(url, false);
+        if (watcher.isNull()) {
+            qWarning() << "Create watcher failed! url = " << url;
+            indexWatcherOrder.removeOne(url);
+            return;
+        }
+
+        auto update = [this](const QUrl &changed) { updateIndex({ changed }); };
+        connect(watcher.data(), &AbstractFileWatcher::subfileCreated, this, update);
+        connect(watcher.data(), &AbstractFileWatcher::fileDeleted, this, update);
+        connect(watcher.data(), &AbstractFileWatcher::fileAttributeChanged, this, update);
+        connect(watcher.data(), &AbstractFileWatcher::fileRename, this, [this](const QUrl &oldUrl, const QUrl &newUrl) {
+            updateIndex({ oldUrl, newUrl });
+        });
+        watcher->startWatcher();
+        indexWatchers.insert(url, watcher);
+    }
+
+    while (indexWatcherOrder.size() > kMaxIndexWatchers) {
+        const AbstractFileWatcherPointer &watcher = indexWatchers.take(indexWatcherOrder.takeFirst());
+        if (watcher) {
+            watcher->disconnect(this);
+            watcher->stopWatcher();
+        }
+    }
+}
+
 void MainController::onFinished(QString taskId)
 {
     if (taskManager.contains(taskId))
@@ -103,3 +174,19 @@ void MainController::onFileChanged(const QString &path)
         });
     }
 }
+
+void MainController::onIndexTimeout()
+{
+    // the index is being created or updated, try again later
+    if (indexFuture.isRunning()) {
+        indexTimer->start();
+        return;
+    }
+
+    const QStringList paths = pendingIndexPaths.values();
+    pendingIndexPaths.clear();
+    indexFuture = QtConcurrent::run([paths]() {
+        FullTextSearcher searcher(QUrl(), "");
+        searcher.updateIndex(paths);
+    });
+}
@@ -7,11 +7,15 @@
 
 #include "task/taskcommander.h"
 
+#include "dfm-base/interfaces/abstractfilewatcher.h"
+
 #include <QHash>
+#include <QSet>
 #include <QFuture>
 
 QT_BEGIN_NAMESPACE
 class QFileSystemWatcher;
+class QTimer;
 QT_END_NAMESPACE
 
 DPSEARCH_BEGIN_NAMESPACE
@@ -28,10 +32,13 @@ private:
     void stop(QString taskId);
     bool doSearchTask(QString taskId, const QUrl &url, const QString &keyword);
     QList<QUrl> getResults(QString taskId);
+    void updateIndex(const QList<QUrl> &urls);
+    void watchIndexDir(const QUrl &url);
 
 private slots:
     void onFinished(QString taskId);
     void onFileChanged(const QString &path);
+    void onIndexTimeout();
 
 signals:
     void matched(QString taskId);
@@ -41,6 +48,11 @@ private:
     QHash<QString, TaskCommander *> taskManager;
     QFileSystemWatcher *fileWatcher = nullptr;
     QFuture<void> indexFuture;
+    QTimer *indexTimer = nullptr;
+    QSet<QString> pendingIndexPaths;
+    // the recently searched dirs are watched, so files changed by others are indexed too
+    QHash<QUrl, AbstractFileWatcherPointer> indexWatchers;
+    QList<QUrl> indexWatcherOrder;   // the most recently searched is the last
 };
 
 DPSEARCH_END_NAMESPACE
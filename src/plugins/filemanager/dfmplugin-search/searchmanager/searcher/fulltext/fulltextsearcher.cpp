@@ -5,6 +5,8 @@
 #include "fulltextsearcher.h"
 #include "fulltextsearcher_p.h"
 #include "chineseanalyzer.h"
+#include "indexmanifest.h"
+#include "indexpipeline.h"
 #include "utils/searchhelper.h"
 
 #include "dfm-base/base/urlroute.h"
@@ -16,6 +18,7 @@
 #include <FileUtils.h>
 #include <FilterIndexReader.h>
 #include <FuzzyQuery.h>
+#include <MapFieldSelector.h>
 #include <QueryWrapperFilter.h>
 
 #include <QRegExp>
@@ -26,10 +29,11 @@
 #include <QDir>
 #include <QTime>
 #include <QUrl>
+#include <QScopedValueRollback>
 
 #include <dirent.h>
+#include <sys/stat.h>
 #include <exception>
-#include <docparser.h>
 
 static constexpr char kFilterFolders[] = "^/(boot|dev|proc|sys|run|lib|usr).*$";
 static constexpr char kSupportFiles[] = "(rtf)|(odt)|(ods)|(odp)|(odg)|(docx)|(xlsx)|(pptx)|(ppsx)|(md)|"
@@ -41,7 +45,24 @@ using namespace Lucene;
 DFMBASE_USE_NAMESPACE
 DPSEARCH_USE_NAMESPACE
 
-bool FullTextSearcherPrivate::isIndexCreating = false;
+namespace {
+bool isSupportFile(const QString &file)
+{
+    static QRegExp suffixRegExp(kSupportFiles);
+    return suffixRegExp.exactMatch(QFileInfo(file).suffix());
+}
+
+IndexManifest::Record manifestRecord(const struct stat &st)
+{
+    IndexManifest::Record record;
+    record.mtime = st.st_mtim.tv_sec;
+    record.size = st.st_size;
+    return record;
+}
+}
+
+std::atomic_bool FullTextSearcherPrivate::isIndexCreating { false };
+QMutex FullTextSearcherPrivate::indexWriterMutex;
 FullTextSearcherPrivate::FullTextSearcherPrivate(FullTextSearcher *parent)
     : QObject(parent),
       q(parent)
@@ -66,7 +87,7 @@ IndexReaderPtr FullTextSearcherPrivate::newIndexReader()
     return IndexReader::open(FSDirectory::open(indexStorePath().toStdWString()), true);
 }
 
-void FullTextSearcherPrivate::doIndexTask(const IndexReaderPtr &reader, const IndexWriterPtr &writer, const QString &path, TaskType type)
+void FullTextSearcherPrivate::doIndexTask(const IndexWriterPtr &writer, const QString &path, TaskType type)
 {
     if (status.loadAcquire() != AbstractSearcher::kRuning)
         return;
@@ -110,25 +131,9 @@ void FullTextSearcherPrivate::doIndexTask(const IndexReaderPtr &reader, const In
 
         const bool is_dir = S_ISDIR(st.st_mode);
         if (is_dir) {
-            doIndexTask(reader, writer, fn, type);
+            doIndexTask(writer, fn, type);
         } else {
-            QFileInfo info(fn);
-            QString suffix = info.suffix();
-            static QRegExp suffixRegExp(kSupportFiles);
-            if (suffixRegExp.exactMatch(suffix)) {
-                switch (type) {
-                case kCreate:
-                    indexDocs(writer, fn, kAddIndex);
-                    break;
-                case kUpdate:
-                    IndexType type;
-                    if (checkUpdate(reader, fn, type)) {
-                        indexDocs(writer, fn, type);
-                        isUpdated = true;
-                    }
-                    break;
-                }
-            }
+            indexFile(writer, fn, st, type);
         }
     }
 
@@ -136,7 +141,34 @@ void FullTextSearcherPrivate::doIndexTask(const IndexReaderPtr &reader, const In
         closedir(dir);
 }
 
-void FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QString &file, IndexType type)
+void FullTextSearcherPrivate::indexFile(const IndexWriterPtr &writer, const QString &file, const struct stat &st, TaskType type)
+{
+    if (!isSupportFile(file))
+        return;
+
+    if (type == kCheck) {
+        if (IndexManifest::instance()->isChanged(file, manifestRecord(st)))
+            changedFiles << file;
+        return;
+    }
+
+    IndexType indexType = kAddIndex;
+    if (type == kUpdate) {
+        if (!checkUpdate(file, st, indexType))
+            return;
+        isUpdated = true;
+    }
+
+    if (pipeline) {
+        pipeline->addFile(file, indexType == kUpdateIndex, manifestRecord(st));
+        return;
+    }
+
+    if (indexDocs(writer, file, indexType))
+        IndexManifest::instance()->insert(file, manifestRecord(st));
+}
+
+bool FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QString &file, IndexType type)
 {
     Q_ASSERT(writer);
 
@@ -165,6 +197,7 @@ void FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QStr
             break;
         }
         }
+        return true;
     } catch (const LuceneException &e) {
         QMetaEnum enumType = QMetaEnum::fromType<FullTextSearcherPrivate::IndexType>();
         qWarning() << QString::fromStdWString(e.getError()) << " type: " << enumType.valueToKey(type);
@@ -174,42 +207,63 @@ void FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QStr
     } catch (...) {
         qWarning() << "Error: " << __FUNCTION__ << file;
     }
+
+    return false;
 }
 
-bool FullTextSearcherPrivate::checkUpdate(const IndexReaderPtr &reader, const QString &file, IndexType &type)
+bool FullTextSearcherPrivate::checkUpdate(const QString &file, const struct stat &st, IndexType &type)
 {
-    Q_ASSERT(reader);
+    if (!IndexManifest::instance()->isChanged(file, manifestRecord(st)))
+        return false;
+
+    // a file missing in the manifest may have been indexed already, so the document is
+    // always replaced by path instead of being added
+    type = kUpdateIndex;
+    return true;
+}
+
+void FullTextSearcherPrivate::ensureManifest()
+{
+    IndexManifest *manifest = IndexManifest::instance();
+    if (manifest->isLoaded() || manifest->load())
+        return;
 
+    // the manifest is missing or corrupted, seed it from the stored fields of the index,
+    // the files which can not be seeded will be indexed again
     try {
-        SearcherPtr searcher = newLucene<IndexSearcher>(reader);
-        TermQueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"path", file.toStdWString()));
-
-        // 文件路径为唯一值，所以搜索一个结果就行了
-        TopDocsPtr topDocs = searcher->search(query, 1);
-        int32_t numTotalHits = topDocs->totalHits;
-        if (numTotalHits == 0) {
-            type = kAddIndex;
-            return true;
-        } else {
-            DocumentPtr doc = searcher->doc(topDocs->scoreDocs[0]->doc);
-            QFileInfo info(file);
-            QString modifyTime = info.lastModified().toString("yyyyMMddHHmmss");
-            String storeTime = doc->get(L"modified");
-
-            if (modifyTime.toStdWString() != storeTime) {
-                type = kUpdateIndex;
-                return true;
-            }
+        QTime timer;
+        timer.start();
+        IndexReaderPtr reader = newIndexReader();
+        Collection<String> fields = Collection<String>::newInstance();
+        fields.add(L"path");
+        fields.add(L"modified");
+        FieldSelectorPtr selector = newLucene<MapFieldSelector>(fields);
+
+        const int32_t maxDoc = reader->maxDoc();
+        for (int32_t i = 0; i < maxDoc; ++i) {
+            if (reader->isDeleted(i))
+                continue;
+
+            DocumentPtr doc = reader->document(i, selector);
+            const QString &path = QString::fromStdWString(doc->get(L"path"));
+            const QDateTime &modified = QDateTime::fromString(QString::fromStdWString(doc->get(L"modified")), "yyyyMMddHHmmss");
+            if (path.isEmpty() || !modified.isValid())
+                continue;
+
+            IndexManifest::Record record;
+            record.mtime = modified.toMSecsSinceEpoch() / 1000;
+            manifest->insert(path, record);
         }
+        reader->close();
+        manifest->save();
+        qInfo() << "seed index manifest spending: " << timer.elapsed();
     } catch (const LuceneException &e) {
-        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError()) << " file: " << file;
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
     } catch (const std::exception &e) {
-        qWarning() << "Error: " << __FUNCTION__ << QString(e.what()) << " file: " << file;
+        qWarning() << "Error: " << __FUNCTION__ << QString(e.what());
     } catch (...) {
-        qWarning() << "Error: " << __FUNCTION__ << " file: " << file;
+        qWarning() << "Error: " << __FUNCTION__;
     }
-
-    return false;
 }
 
 void FullTextSearcherPrivate::tryNotify()
@@ -224,20 +278,7 @@ void FullTextSearcherPrivate::tryNotify()
 
 DocumentPtr FullTextSearcherPrivate::fileDocument(const QString &file)
 {
-    DocumentPtr doc = newLucene<Document>();
-    // file path
-    doc->add(newLucene<Field>(L"path", file.toStdWString(), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
-
-    // file last modified time
-    QFileInfo info(file);
-    QString modifyTime = info.lastModified().toString("yyyyMMddHHmmss");
-    doc->add(newLucene<Field>(L"modified", modifyTime.toStdWString(), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
-
-    // file contents
-    QString contents = DocParser::convertFile(file.toStdString()).c_str();
-    doc->add(newLucene<Field>(L"contents", contents.toStdWString(), Field::STORE_YES, Field::INDEX_ANALYZED));
-
-    return doc;
+    return IndexPipeline::createDocument(file, IndexPipeline::parseFile(file));
 }
 
 bool FullTextSearcherPrivate::createIndex(const QString &path)
@@ -261,6 +302,7 @@ bool FullTextSearcherPrivate::createIndex(const QString &path)
         }
     }
 
+    QMutexLocker lk(&indexWriterMutex);
     try {
         // record spending
         QTime timer;
@@ -268,9 +310,16 @@ bool FullTextSearcherPrivate::createIndex(const QString &path)
         IndexWriterPtr writer = newIndexWriter(true);
         qDebug() << "Indexing to directory: " << indexStorePath();
         writer->deleteAll();
-        doIndexTask(nullptr, writer, path, kCreate);
+        IndexManifest::instance()->clear();
+        {
+            IndexPipeline indexPipeline(writer, status);
+            QScopedValueRollback<IndexPipeline *> rollback(pipeline, &indexPipeline);
+            doIndexTask(writer, path, kCreate);
+            indexPipeline.finish();
+        }
         writer->optimize();
         writer->close();
+        IndexManifest::instance()->save();
 
         qInfo() << "create index spending: " << timer.elapsed();
         status.storeRelease(AbstractSearcher::kCompleted);
@@ -287,19 +336,77 @@ bool FullTextSearcherPrivate::createIndex(const QString &path)
     return false;
 }
 
-bool FullTextSearcherPrivate::updateIndex(const QString &path)
+/*!
+ * \brief updateIndex updates the documents of the changed files only, paths are
+ * the files or directories which are created, modified or removed.
+ */
+bool FullTextSearcherPrivate::updateIndex(const QStringList &paths)
 {
-    QString bindPath = FileUtils::bindPathTransform(path, false);
+    //准备状态切运行中，否则直接返回
+    if (!status.testAndSetRelease(AbstractSearcher::kReady, AbstractSearcher::kRuning))
+        return false;
+
+    QMutexLocker lk(&indexWriterMutex);
+    ensureManifest();
+    bool ret = indexPaths(paths);
+    status.storeRelease(AbstractSearcher::kCompleted);
+    return ret;
+}
+
+/*!
+ * \brief updateChanged updates the documents of the files under path which differ from the
+ * manifest before searching. The walk only stats the files, the index is opened for
+ * writing only if some of them are changed.
+ */
+void FullTextSearcherPrivate::updateChanged(const QString &path)
+{
+    if (!IndexManifest::instance()->isLoaded()) {
+        QMutexLocker lk(&indexWriterMutex);
+        ensureManifest();
+    }
+
+    changedFiles.clear();
+    doIndexTask(nullptr, FileUtils::bindPathTransform(path, false), kCheck);
+    if (changedFiles.isEmpty() || status.loadAcquire() != AbstractSearcher::kRuning)
+        return;
+
+    QMutexLocker lk(&indexWriterMutex);
+    indexPaths(changedFiles);
+    changedFiles.clear();
+}
+
+/*!
+ * \brief indexPaths indexes the changed ones of paths, the index writer mutex must be locked
+ */
+bool FullTextSearcherPrivate::indexPaths(const QStringList &paths)
+{
+    bool ret = false;
     try {
-        IndexReaderPtr reader = newIndexReader();
+        QTime timer;
+        timer.start();
         IndexWriterPtr writer = newIndexWriter();
+        IndexPipeline indexPipeline(writer, status);
+        QScopedValueRollback<IndexPipeline *> rollback(pipeline, &indexPipeline);
+        for (const auto &path : paths) {
+            const QString &file = FileUtils::bindPathTransform(path, false);
+            struct stat st;
+            if (lstat(file.toStdString().c_str(), &st) == -1) {
+                // removed, delete the documents of it and the files under it
+                const QStringList &removedFiles = IndexManifest::instance()->removeUnder(file);
+                for (const auto &removedFile : removedFiles)
+                    indexDocs(writer, removedFile, kDeleteIndex);
+                continue;
+            }
 
-        doIndexTask(reader, writer, bindPath, kUpdate);
-
+            if (S_ISDIR(st.st_mode))
+                doIndexTask(writer, file, kUpdate);
+            else
+                indexFile(writer, file, st, kUpdate);
+        }
+        indexPipeline.finish();
         writer->close();
-        reader->close();
-
-        return true;
+        ret = true;
+        qInfo() << "update index of " << paths.size() << " paths spending: " << timer.elapsed();
     } catch (const LuceneException &e) {
         qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
     } catch (const std::exception &e) {
@@ -308,7 +415,8 @@ bool FullTextSearcherPrivate::updateIndex(const QString &path)
         qWarning() << "Error: " << __FUNCTION__;
     }
 
-    return false;
+    IndexManifest::instance()->save();
+    return ret;
 }
 
 bool FullTextSearcherPrivate::doSearch(const QString &path, const QString &keyword)
@@ -322,7 +430,6 @@ bool FullTextSearcherPrivate::doSearch(const QString &path, const QString &keywo
         hasTransform = true;
 
     try {
-        IndexWriterPtr writer = newIndexWriter();
         IndexReaderPtr reader = newIndexReader();
         SearcherPtr searcher = newLucene<IndexSearcher>(reader);
         AnalyzerPtr analyzer = newLucene<ChineseAnalyzer>();
@@ -340,6 +447,7 @@ bool FullTextSearcherPrivate::doSearch(const QString &path, const QString &keywo
         Collection<ScoreDocPtr> scoreDocs = topDocs->scoreDocs;
 
         QHash<QString, QSet<QString>> hiddenFileHash;
+        QStringList invalidFiles;
         for (auto scoreDoc : scoreDocs) {
             //中断
             if (status.loadAcquire() != AbstractSearcher::kRuning)
@@ -352,7 +460,7 @@ bool FullTextSearcherPrivate::doSearch(const QString &path, const QString &keywo
                 QFileInfo info(QString::fromStdWString(resultPath));
                 // delete invalid index
                 if (!info.exists()) {
-                    indexDocs(writer, info.absoluteFilePath(), kDeleteIndex);
+                    invalidFiles << QString::fromStdWString(resultPath);
                     continue;
                 }
 
@@ -375,7 +483,7 @@ bool FullTextSearcherPrivate::doSearch(const QString &path, const QString &keywo
         }
 
         reader->close();
-        writer->close();
+        removeIndex(invalidFiles);
     } catch (const LuceneException &e) {
         qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
     } catch (const std::exception &e) {
@@ -387,6 +495,31 @@ bool FullTextSearcherPrivate::doSearch(const QString &path, const QString &keywo
     return true;
 }
 
+void FullTextSearcherPrivate::removeIndex(const QStringList &files)
+{
+    // the index is being updated by others, the invalid documents will be removed next time
+    if (files.isEmpty() || !indexWriterMutex.tryLock())
+        return;
+
+    try {
+        IndexWriterPtr writer = newIndexWriter();
+        for (const auto &file : files) {
+            if (indexDocs(writer, file, kDeleteIndex))
+                IndexManifest::instance()->remove(file);
+        }
+        writer->close();
+    } catch (const LuceneException &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
+    } catch (const std::exception &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString(e.what());
+    } catch (...) {
+        qWarning() << "Error: " << __FUNCTION__;
+    }
+
+    indexWriterMutex.unlock();
+    IndexManifest::instance()->save();
+}
+
 QString FullTextSearcherPrivate::dealKeyword(const QString &keyword)
 {
     static QRegExp cnReg("^[\u4e00-\u9fa5]");
@@ -445,6 +578,18 @@ bool FullTextSearcher::createIndex(const QString &path)
     return res;
 }
 
+bool FullTextSearcher::updateIndex(const QStringList &paths)
+{
+    if (d->isIndexCreating || paths.isEmpty())
+        return false;
+
+    bool indexExists = IndexReader::indexExists(FSDirectory::open(d->indexStorePath().toStdWString()));
+    if (!indexExists)
+        return false;
+
+    return d->updateIndex(paths);
+}
+
 bool FullTextSearcher::isSupport(const QUrl &url)
 {
     if (!url.isValid() || UrlRoute::isVirtual(url))
@@ -469,8 +614,8 @@ bool FullTextSearcher::search()
         return false;
     }
 
-    // 先更新索引再搜索
-    d->updateIndex(path);
+    // 先按清单检查变化的文件并更新索引再搜索
+    d->updateChanged(path);
     d->doSearch(path, key);
     //检查是否还有数据
     if (d->status.testAndSetRelease(kRuning, kCompleted)) {
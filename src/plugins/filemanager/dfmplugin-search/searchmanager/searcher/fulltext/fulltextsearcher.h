@@ -22,6 +22,7 @@ class FullTextSearcher : public AbstractSearcher
 private:
     explicit FullTextSearcher(const QUrl &url, const QString &key, QObject *parent = nullptr);
     bool createIndex(const QString &path);
+    bool updateIndex(const QStringList &paths);
     bool search() override;
     void stop() override;
     bool hasItem() const override;
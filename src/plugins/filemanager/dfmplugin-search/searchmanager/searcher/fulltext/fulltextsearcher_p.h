@@ -14,8 +14,13 @@
 #include <QMutex>
 #include <QTime>
 
+#include <atomic>
+
+struct stat;
+
 DPSEARCH_BEGIN_NAMESPACE
 
+class IndexPipeline;
 class FullTextSearcher;
 class FullTextSearcherPrivate : public QObject
 {
@@ -32,7 +37,8 @@ public:
 
     enum TaskType {
         kCreate,
-        kUpdate
+        kUpdate,
+        kCheck   // only collect the files changed since they were indexed
     };
 
     enum IndexType {
@@ -50,8 +56,11 @@ private:
     Lucene::IndexReaderPtr newIndexReader();
 
     bool createIndex(const QString &path);
-    bool updateIndex(const QString &path);
+    bool updateIndex(const QStringList &paths);
+    void updateChanged(const QString &path);
+    bool indexPaths(const QStringList &paths);
     bool doSearch(const QString &path, const QString &keyword);
+    void removeIndex(const QStringList &files);
     inline static QString indexStorePath()
     {
         static QString path = QStandardPaths::standardLocations(QStandardPaths::ConfigLocation).first()
@@ -61,17 +70,23 @@ private:
 
     Lucene::DocumentPtr fileDocument(const QString &file);
     QString dealKeyword(const QString &keyword);
-    void doIndexTask(const Lucene::IndexReaderPtr &reader, const Lucene::IndexWriterPtr &writer, const QString &path, TaskType type);
-    void indexDocs(const Lucene::IndexWriterPtr &writer, const QString &file, IndexType type);
-    bool checkUpdate(const Lucene::IndexReaderPtr &reader, const QString &file, IndexType &type);
+    void doIndexTask(const Lucene::IndexWriterPtr &writer, const QString &path, TaskType type);
+    void indexFile(const Lucene::IndexWriterPtr &writer, const QString &file, const struct stat &st, TaskType type);
+    bool indexDocs(const Lucene::IndexWriterPtr &writer, const QString &file, IndexType type);
+    bool checkUpdate(const QString &file, const struct stat &st, IndexType &type);
+    void ensureManifest();
     void tryNotify();
 
     bool isUpdated = false;
     QAtomicInt status = AbstractSearcher::kReady;
     QList<QUrl> allResults;
+    QStringList changedFiles;
     mutable QMutex mutex;
-    static bool isIndexCreating;
+    static std::atomic_bool isIndexCreating;
+    static QMutex indexWriterMutex;
     QMap<QString, QString> bindPathTable;
+    // documents are built and written by the pipeline while the index is created or updated
+    IndexPipeline *pipeline = nullptr;
 
     //计时
     QTime notifyTimer;
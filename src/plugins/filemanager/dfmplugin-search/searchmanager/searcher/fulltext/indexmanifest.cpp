@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "indexmanifest.h"
+
+#include <QStandardPaths>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFile>
+#include <QDebug>
+
+static constexpr quint32 kManifestMagic { 0x4446494d };   // "DFIM"
+static constexpr quint32 kManifestVersion { 1 };
+
+DPSEARCH_USE_NAMESPACE
+
+IndexManifest *IndexManifest::instance()
+{
+    static IndexManifest ins;
+    return &ins;
+}
+
+QString IndexManifest::manifestPath()
+{
+    static QString path = QStandardPaths::standardLocations(QStandardPaths::ConfigLocation).first()
+            + "/deepin/dde-file-manager/index.manifest";
+    return path;
+}
+
+bool IndexManifest::isLoaded() const
+{
+    QMutexLocker lk(&mutex);
+    return loaded;
+}
+
+/*!
+ * \brief load returns false if the manifest does not exist or is corrupted,
+ * the manifest is empty then and has to be seeded again.
+ */
+bool IndexManifest::load()
+{
+    QMutexLocker lk(&mutex);
+    loaded = true;
+    changed = false;
+    records.clear();
+
+    QFile file(manifestPath());
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != kManifestMagic || version != kManifestVersion) {
+        qWarning() << "invalid full-text index manifest: " << manifestPath();
+        return false;
+    }
+
+    for (quint32 i = 0; i < count; ++i) {
+        QString path;
+        Record record;
+        stream >> path >> record.mtime >> record.size;
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "full-text index manifest is corrupted: " << manifestPath();
+            records.clear();
+            return false;
+        }
+        records.insert(path, record);
+    }
+
+    return true;
+}
+
+bool IndexManifest::save()
+{
+    QMutexLocker lk(&mutex);
+    if (!changed)
+        return true;
+
+    QSaveFile file(manifestPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "can not save full-text index manifest: " << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << kManifestMagic << kManifestVersion << static_cast<quint32>(records.size());
+    for (auto it = records.cbegin(); it != records.cend(); ++it)
+        stream << it.key() << it.value().mtime << it.value().size;
+
+    if (!file.commit()) {
+        qWarning() << "can not save full-text index manifest: " << file.errorString();
+        return false;
+    }
+
+    changed = false;
+    return true;
+}
+
+void IndexManifest::clear()
+{
+    QMutexLocker lk(&mutex);
+    loaded = true;
+    changed = true;
+    records.clear();
+}
+
+bool IndexManifest::isChanged(const QString &file, const Record &record) const
+{
+    QMutexLocker lk(&mutex);
+    auto it = records.constFind(file);
+    if (it == records.cend())
+        return true;
+
+    if (it->mtime != record.mtime)
+        return true;
+
+    return it->size >= 0 && it->size != record.size;
+}
+
+void IndexManifest::insert(const QString &file, const Record &record)
+{
+    QMutexLocker lk(&mutex);
+    records.insert(file, record);
+    changed = true;
+}
+
+void IndexManifest::remove(const QString &file)
+{
+    QMutexLocker lk(&mutex);
+    if (records.remove(file) > 0)
+        changed = true;
+}
+
+/*!
+ * \brief removeUnder removes path and all the files under it, returns the removed files
+ */
+QStringList IndexManifest::removeUnder(const QString &path)
+{
+    QMutexLocker lk(&mutex);
+    const QString &prefix = path.endsWith('/') ? path : path + '/';
+    QStringList removed;
+    if (records.remove(path) > 0)
+        removed << path;
+
+    for (auto it = records.lowerBound(prefix); it != records.end() && it.key().startsWith(prefix);) {
+        removed << it.key();
+        it = records.erase(it);
+    }
+
+    if (!removed.isEmpty())
+        changed = true;
+    return removed;
+}
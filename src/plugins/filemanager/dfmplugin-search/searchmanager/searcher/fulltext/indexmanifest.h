@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef INDEXMANIFEST_H
+#define INDEXMANIFEST_H
+
+#include "dfmplugin_search_global.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QStringList>
+
+DPSEARCH_BEGIN_NAMESPACE
+
+/*!
+ * \brief The IndexManifest class records the mtime and size of every file in the
+ * full-text index, so that updating the index only needs a stat of each file
+ * instead of a lucene query. It is saved beside the index directory. The records are
+ * sorted by path, so the files under a directory are a contiguous range.
+ */
+class IndexManifest
+{
+    Q_DISABLE_COPY(IndexManifest)
+
+public:
+    struct Record
+    {
+        qint64 mtime { 0 };   // seconds since epoch
+        qint64 size { -1 };   // -1 if unknown, the record is seeded from the index
+    };
+
+    static IndexManifest *instance();
+    static QString manifestPath();
+
+    bool isLoaded() const;
+    bool load();
+    bool save();
+    void clear();
+
+    bool isChanged(const QString &file, const Record &record) const;
+    void insert(const QString &file, const Record &record);
+    void remove(const QString &file);
+    QStringList removeUnder(const QString &path);
+
+private:
+    IndexManifest() = default;
+
+    mutable QMutex mutex;
+    QMap<QString, Record> records;
+    bool loaded { false };
+    bool changed { false };
+};
+
+DPSEARCH_END_NAMESPACE
+
+#endif   // INDEXMANIFEST_H
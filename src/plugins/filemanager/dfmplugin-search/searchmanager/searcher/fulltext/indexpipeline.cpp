@@ -0,0 +1,288 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "indexpipeline.h"
+#include "searchmanager/searcher/abstractsearcher.h"
+
+#include "dfm-base/base/configs/dconfig/dconfigmanager.h"
+
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QProcess>
+#include <QThread>
+#include <QDebug>
+
+#include <docparser.h>
+
+#include <cstring>
+#include <mutex>
+
+static constexpr char kCommitBatchKey[] { "dfm.fulltext.commit.batch" };
+static constexpr char kMaxFileSizeKey[] { "dfm.fulltext.file.maxsize" };
+static constexpr char kParseTimeoutKey[] { "dfm.fulltext.file.timeout" };
+static constexpr int kMaxParserCount { 4 };
+static constexpr char kDocParserTool[] { "dde-file-manager-docparser" };
+static constexpr int kDocParserStartTime { 5000 };
+
+using namespace Lucene;
+DFMBASE_USE_NAMESPACE
+DPSEARCH_USE_NAMESPACE
+
+IndexPipeline::IndexPipeline(const IndexWriterPtr &writer, const QAtomicInt &status)
+    : writer(writer),
+      status(status),
+      parserCount(qBound(1, QThread::idealThreadCount() - 1, kMaxParserCount)),
+      batchSize(qMax(1, DConfigManager::instance()->value(kDefaultCfgPath, kCommitBatchKey, 500).toInt())),
+      maxFileSize(DConfigManager::instance()->value(kDefaultCfgPath, kMaxFileSizeKey, 50).toLongLong() * 1024 * 1024),
+      parseTimeout(DConfigManager::instance()->value(kDefaultCfgPath, kParseTimeoutKey, 30).toInt() * 1000),
+      taskQueue(parserCount * 16),
+      docQueue(parserCount * 4)
+{
+    pool.setMaxThreadCount(parserCount + 1);
+    for (int i = 0; i < parserCount; ++i)
+        parsers << QtConcurrent::run(&pool, [this] { parse(); });
+    writerFuture = QtConcurrent::run(&pool, [this] { write(); });
+}
+
+IndexPipeline::~IndexPipeline()
+{
+    if (!finished) {
+        taskQueue.abort();
+        docQueue.abort();
+        pool.waitForDone();
+    }
+}
+
+/*!
+ * \brief addFile queues a file to be indexed, it blocks while the parsers are
+ * busy, and returns false if the pipeline is cancelled.
+ */
+bool IndexPipeline::addFile(const QString &file, bool update, const IndexManifest::Record &record)
+{
+    if (!isRunning())
+        return false;
+
+    Task task;
+    task.file = file;
+    task.update = update;
+    task.record = record;
+    return taskQueue.push(task);
+}
+
+void IndexPipeline::finish()
+{
+    if (finished)
+        return;
+    finished = true;
+
+    taskQueue.close();
+    for (auto &parser : parsers)
+        parser.waitForFinished();
+    docQueue.close();
+    writerFuture.waitForFinished();
+}
+
+DocumentPtr IndexPipeline::createDocument(const QString &file, const QString &contents)
+{
+    DocumentPtr doc = newLucene<Document>();
+    // file path
+    doc->add(newLucene<Field>(L"path", file.toStdWString(), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+
+    // file last modified time
+    QFileInfo info(file);
+    QString modifyTime = info.lastModified().toString("yyyyMMddHHmmss");
+    doc->add(newLucene<Field>(L"modified", modifyTime.toStdWString(), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+
+    // file contents
+    doc->add(newLucene<Field>(L"contents", contents.toStdWString(), Field::STORE_YES, Field::INDEX_ANALYZED));
+
+    return doc;
+}
+
+QString IndexPipeline::parseFile(const QString &file)
+{
+    return DocParser::convertFile(file.toStdString()).c_str();
+}
+
+DocParserProcess::DocParserProcess()
+{
+}
+
+DocParserProcess::~DocParserProcess()
+{
+    if (!process)
+        return;
+
+    // the helper exits when its input is closed
+    process->closeWriteChannel();
+    if (!process->waitForFinished(1000))
+        kill();
+}
+
+/*!
+ * \brief parse returns the contents of file, or an empty string if the parsing fails
+ * or takes longer than timeout ms. It parses in the current process if there is no helper.
+ */
+QString DocParserProcess::parse(const QString &file, int timeout)
+{
+    if (!ensureStarted())
+        return IndexPipeline::parseFile(file);
+
+    const QByteArray &path = file.toUtf8();
+    const quint32 pathSize = static_cast<quint32>(path.size());
+    process->write(reinterpret_cast<const char *>(&pathSize), sizeof(pathSize));
+    process->write(path);
+
+    QElapsedTimer timer;
+    timer.start();
+    QByteArray reply;
+    qint64 replySize = -1;
+    forever {
+        reply.append(process->readAllStandardOutput());
+        if (replySize < 0 && reply.size() >= static_cast<int>(sizeof(quint32))) {
+            quint32 size = 0;
+            memcpy(&size, reply.constData(), sizeof(size));
+            replySize = size;
+            reply.remove(0, sizeof(size));
+        }
+        if (replySize >= 0 && reply.size() >= replySize)
+            break;
+
+        const qint64 left = timeout - timer.elapsed();
+        if (left <= 0 || process->state() != QProcess::Running) {
+            if (left <= 0)
+                qWarning() << "parse timeout, index without contents: " << file;
+            else
+                qWarning() << "parse failed: " << file;
+            kill();
+            return QString();
+        }
+        process->waitForReadyRead(static_cast<int>(left));
+    }
+
+    return QString::fromUtf8(reply.constData(), static_cast<int>(replySize));
+}
+
+bool DocParserProcess::ensureStarted()
+{
+    if (process && process->state() == QProcess::Running)
+        return true;
+
+    static const QString program = QString(DOCPARSER_TOOL_DIR) + "/" + kDocParserTool;
+    if (!QFileInfo::exists(program)) {
+        static std::once_flag flag;
+        std::call_once(flag, [] { qWarning() << "no document parser, parse without timeout: " << program; });
+        return false;
+    }
+
+    process.reset(new QProcess);
+    process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    process->start(program, {});
+    if (!process->waitForStarted(kDocParserStartTime)) {
+        qWarning() << "can not start document parser: " << process->errorString();
+        process.reset();
+        return false;
+    }
+
+    return true;
+}
+
+void DocParserProcess::kill()
+{
+    if (!process)
+        return;
+
+    process->kill();
+    process->waitForFinished(kDocParserStartTime);
+    process.reset();
+}
+
+bool IndexPipeline::isRunning() const
+{
+    return status.loadAcquire() == AbstractSearcher::kRuning;
+}
+
+void IndexPipeline::parse()
+{
+    DocParserProcess parser;
+    Task task;
+    while (taskQueue.pop(&task)) {
+        // cancelled, the producer may be blocked by a full queue
+        if (!isRunning()) {
+            taskQueue.abort();
+            break;
+        }
+
+        QString contents;
+        if (maxFileSize > 0 && task.record.size > maxFileSize)
+            qInfo() << "file is too large, index without contents: " << task.file << task.record.size;
+        else
+            contents = parseTimeout > 0 ? parser.parse(task.file, parseTimeout) : parseFile(task.file);
+
+        Result result;
+        result.task = task;
+        try {
+            result.doc = createDocument(task.file, contents);
+        } catch (const LuceneException &e) {
+            qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError()) << task.file;
+            continue;
+        }
+
+        if (!docQueue.push(result))
+            break;
+    }
+}
+
+void IndexPipeline::write()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    int pending = 0;
+    Result result;
+    while (docQueue.pop(&result)) {
+        // cancelled, let the producer and parsers return at once
+        if (!isRunning()) {
+            taskQueue.abort();
+            docQueue.abort();
+            break;
+        }
+
+        try {
+            if (result.task.update)
+                writer->updateDocument(newLucene<Term>(L"path", result.task.file.toStdWString()), result.doc);
+            else
+                writer->addDocument(result.doc);
+        } catch (const LuceneException &e) {
+            qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError()) << result.task.file;
+            continue;
+        } catch (const std::exception &e) {
+            qWarning() << "Error: " << __FUNCTION__ << QString(e.what()) << result.task.file;
+            continue;
+        }
+
+        IndexManifest::instance()->insert(result.task.file, result.task.record);
+        docCount.ref();
+        byteCount.fetchAndAddRelaxed(qMax<qint64>(0, result.task.record.size));
+
+        if (++pending >= batchSize) {
+            pending = 0;
+            try {
+                writer->commit();
+            } catch (const LuceneException &e) {
+                qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
+            }
+        }
+    }
+
+    const qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+    const int docs = docCount.load();
+    const qint64 bytes = byteCount.load();
+    qInfo() << "index pipeline finished, parsers: " << parserCount
+            << " docs: " << docs << " bytes: " << bytes << " spending: " << elapsed
+            << " docs/s: " << docs * 1000.0 / elapsed
+            << " bytes/s: " << bytes * 1000.0 / elapsed;
+}
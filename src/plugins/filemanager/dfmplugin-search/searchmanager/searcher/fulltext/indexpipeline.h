@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef INDEXPIPELINE_H
+#define INDEXPIPELINE_H
+
+#include "indexmanifest.h"
+
+#include <lucene++/LuceneHeaders.h>
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QMutex>
+#include <QQueue>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+QT_BEGIN_NAMESPACE
+class QProcess;
+QT_END_NAMESPACE
+
+DPSEARCH_BEGIN_NAMESPACE
+
+/*!
+ * \brief The BoundedQueue class blocks the producer when it is full and the
+ * consumer when it is empty, until it is closed or aborted.
+ */
+template<typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(int capacity)
+        : capacity(capacity) {}
+
+    bool push(const T &item)
+    {
+        QMutexLocker lk(&mutex);
+        while (items.size() >= capacity && !closed && !aborted)
+            notFull.wait(&mutex);
+
+        if (closed || aborted)
+            return false;
+
+        items.enqueue(item);
+        notEmpty.wakeOne();
+        return true;
+    }
+
+    bool pop(T *item)
+    {
+        QMutexLocker lk(&mutex);
+        while (items.isEmpty() && !closed && !aborted)
+            notEmpty.wait(&mutex);
+
+        if (aborted || items.isEmpty())
+            return false;
+
+        *item = items.dequeue();
+        notFull.wakeOne();
+        return true;
+    }
+
+    // no more items, the remaining ones are still consumed
+    void close()
+    {
+        QMutexLocker lk(&mutex);
+        closed = true;
+        notEmpty.wakeAll();
+        notFull.wakeAll();
+    }
+
+    // the remaining items are dropped
+    void abort()
+    {
+        QMutexLocker lk(&mutex);
+        aborted = true;
+        items.clear();
+        notEmpty.wakeAll();
+        notFull.wakeAll();
+    }
+
+private:
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    QQueue<T> items;
+    int capacity { 0 };
+    bool closed { false };
+    bool aborted { false };
+};
+
+/*!
+ * \brief The DocParserProcess class parses documents in a long-lived helper process, one
+ * file at a time. The parser can not be interrupted, so the helper is killed when a parse
+ * takes too long, and started again for the next file. It is used by a single thread.
+ */
+class DocParserProcess
+{
+    Q_DISABLE_COPY(DocParserProcess)
+
+public:
+    DocParserProcess();
+    ~DocParserProcess();
+
+    QString parse(const QString &file, int timeout);
+
+private:
+    bool ensureStarted();
+    void kill();
+
+private:
+    QScopedPointer<QProcess> process;
+};
+
+/*!
+ * \brief The IndexPipeline class builds the documents of the full-text index with
+ * several parser threads while the directory is walked, and a single writer thread
+ * adds them to the index and commits in batches.
+ */
+class IndexPipeline
+{
+    Q_DISABLE_COPY(IndexPipeline)
+
+public:
+    IndexPipeline(const Lucene::IndexWriterPtr &writer, const QAtomicInt &status);
+    ~IndexPipeline();
+
+    bool addFile(const QString &file, bool update, const IndexManifest::Record &record);
+    void finish();
+
+    static Lucene::DocumentPtr createDocument(const QString &file, const QString &contents);
+    static QString parseFile(const QString &file);
+
+private:
+    struct Task
+    {
+        QString file;
+        bool update { false };
+        IndexManifest::Record record;
+    };
+
+    struct Result
+    {
+        Task task;
+        Lucene::DocumentPtr doc;
+    };
+
+    bool isRunning() const;
+    void parse();
+    void write();
+
+private:
+    Lucene::IndexWriterPtr writer;
+    const QAtomicInt &status;
+
+    int parserCount { 0 };
+    int batchSize { 0 };
+    qint64 maxFileSize { 0 };
+    int parseTimeout { 0 };
+
+    BoundedQueue<Task> taskQueue;
+    BoundedQueue<Result> docQueue;
+    QThreadPool pool;
+    QList<QFuture<void>> parsers;
+    QFuture<void> writerFuture;
+    bool finished { false };
+
+    QAtomicInt docCount { 0 };
+    QAtomicInteger<qint64> byteCount { 0 };
+};
+
+DPSEARCH_END_NAMESPACE
+
+#endif   // INDEXPIPELINE_H
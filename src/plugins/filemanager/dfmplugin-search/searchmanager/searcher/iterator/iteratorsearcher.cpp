@@ -8,18 +8,262 @@
 #include "dfm-base/utils/fileutils.h"
 #include "dfm-base/base/schemefactory.h"
 
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrent>
 #include <QDebug>
 
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 static int kEmitInterval = 50;   // 推送时间间隔（ms
 static constexpr char kFilterFolders[] = "^/(dev|proc|sys|run|tmpfs).*$";
+static constexpr int kMaxWalkerCount = 8;
+static constexpr int kVisitedShardCount = 16;
+static constexpr unsigned long kIdleWaitTime = 50;   // an idle worker checks the status at least this often (ms
+static constexpr char kDesktopSuffix[] = ".desktop";
 
 DFMBASE_USE_NAMESPACE
 DPSEARCH_USE_NAMESPACE
 
+namespace {
+
+/*!
+ * \brief The ParallelWalker class searches a local directory tree by file name
+ * with several threads. Every worker owns a queue of directories, it takes the
+ * newest one of its own queue and steals the oldest one from the others when its
+ * queue is empty, and sleeps until a directory is pushed or all are read if there
+ * is none. Entries are read by readdir, only the matched ones become urls.
+ */
+class ParallelWalker
+{
+public:
+    using Deliver = std::function<void(const QList<QUrl> &)>;
+
+    ParallelWalker(const QString &rootPath, const QRegularExpression &regex,
+                   const QAtomicInt &status, Deliver deliver)
+        : rootPath(rootPath.toLocal8Bit()),
+          regex(regex),
+          filterRegex(kFilterFolders),
+          status(status),
+          deliver(deliver),
+          workerCount(qBound(2, QThread::idealThreadCount(), kMaxWalkerCount)),
+          queues(static_cast<size_t>(workerCount))
+    {
+        // 仅在过滤目录下进行搜索时，过滤目录下的内容才能被检索
+        filterSystemDirs = !filterRegex.match(rootPath).hasMatch();
+        pool.setMaxThreadCount(workerCount);
+    }
+
+    void start()
+    {
+        struct stat st;
+        if (::stat(rootPath.constData(), &st) != 0 || !S_ISDIR(st.st_mode))
+            return;
+
+        markVisited(st.st_dev, st.st_ino);
+        push(0, rootPath);
+        for (int i = 0; i < workerCount; ++i)
+            QtConcurrent::run(&pool, [this, i] { work(i); });
+    }
+
+    bool waitForDone(int msecs)
+    {
+        return pool.waitForDone(msecs);
+    }
+
+private:
+    struct WorkQueue
+    {
+        QMutex mutex;
+        std::deque<QByteArray> dirs;
+    };
+
+    struct VisitedShard
+    {
+        QMutex mutex;
+        QSet<QPair<quint64, quint64>> inodes;
+    };
+
+    bool isRunning() const
+    {
+        return status.loadAcquire() == AbstractSearcher::kRuning;
+    }
+
+    void push(int id, const QByteArray &dir)
+    {
+        pending.ref();
+        {
+            WorkQueue &queue = queues[static_cast<size_t>(id)];
+            QMutexLocker lk(&queue.mutex);
+            queue.dirs.push_back(dir);
+        }
+
+        // an idle worker counts itself before it checks queued, so either it sees the
+        // directory or it is seen here and woken up
+        ++queued;
+        if (idleCount > 0) {
+            QMutexLocker lk(&idleMutex);
+            idleCondition.wakeOne();
+        }
+    }
+
+    bool pop(int id, QByteArray *dir)
+    {
+        for (int i = 0; i < workerCount; ++i) {
+            const int index = (id + i) % workerCount;
+            WorkQueue &queue = queues[static_cast<size_t>(index)];
+            QMutexLocker lk(&queue.mutex);
+            if (queue.dirs.empty())
+                continue;
+
+            if (index == id) {
+                *dir = std::move(queue.dirs.back());
+                queue.dirs.pop_back();
+            } else {
+                *dir = std::move(queue.dirs.front());
+                queue.dirs.pop_front();
+            }
+            --queued;
+            return true;
+        }
+        return false;
+    }
+
+    bool markVisited(dev_t dev, ino_t ino)
+    {
+        const auto key = qMakePair(static_cast<quint64>(dev), static_cast<quint64>(ino));
+        VisitedShard &shard = visited[qHash(key) % kVisitedShardCount];
+        QMutexLocker lk(&shard.mutex);
+        if (shard.inodes.contains(key))
+            return false;
+        shard.inodes.insert(key);
+        return true;
+    }
+
+    void work(int id)
+    {
+        const QRegularExpression nameRegex = regex;
+        QByteArray dir;
+        while (isRunning()) {
+            if (!pop(id, &dir)) {
+                QMutexLocker lk(&idleMutex);
+                ++idleCount;
+                while (isRunning() && queued <= 0 && pending.loadAcquire() != 0)
+                    idleCondition.wait(&idleMutex, kIdleWaitTime);
+                --idleCount;
+
+                // all queues are empty and no directory is being read
+                if (pending.loadAcquire() == 0)
+                    return;
+                continue;
+            }
+
+            scan(id, dir, nameRegex);
+            if (!pending.deref()) {
+                QMutexLocker lk(&idleMutex);
+                idleCondition.wakeAll();
+            }
+        }
+    }
+
+    void scan(int id, const QByteArray &dir, const QRegularExpression &nameRegex)
+    {
+        const int fd = ::open(dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        DIR *dirp = ::fdopendir(fd);
+        if (!dirp) {
+            ::close(fd);
+            return;
+        }
+
+        const QByteArray prefix = dir.endsWith('/') ? dir : dir + '/';
+        QList<QUrl> results;
+        while (struct dirent *entry = ::readdir(dirp)) {
+            if (!isRunning())
+                break;
+
+            // 隐藏文件和 . .. 不参与搜索
+            const char *name = entry->d_name;
+            if (name[0] == '.')
+                continue;
+
+            const QByteArray path = prefix + name;
+            unsigned char type = entry->d_type;
+            struct stat st;
+            bool hasStat = false;
+            if (type == DT_UNKNOWN) {
+                if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+                    continue;
+                type = IFTODT(st.st_mode);
+                hasStat = true;
+            }
+
+            // 将目录添加到待搜索目录中, 不进入链接目录
+            if (type == DT_DIR) {
+                if ((hasStat || ::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+                    && (!filterSystemDirs || !filterRegex.match(QString::fromLocal8Bit(path)).hasMatch())
+                    && markVisited(st.st_dev, st.st_ino))
+                    push(id, path);
+            }
+
+            if (isMatched(path, QString::fromLocal8Bit(name), nameRegex))
+                results << QUrl::fromLocalFile(QString::fromLocal8Bit(path));
+        }
+        ::closedir(dirp);
+
+        if (!results.isEmpty())
+            deliver(results);
+    }
+
+    bool isMatched(const QByteArray &path, const QString &fileName, const QRegularExpression &nameRegex) const
+    {
+        // the display name of desktop file is not its file name
+        if (fileName.endsWith(kDesktopSuffix)) {
+            auto info = InfoFactory::create<AbstractFileInfo>(QUrl::fromLocalFile(QString::fromLocal8Bit(path)));
+            if (info)
+                return nameRegex.match(info->displayOf(DisPlayInfoType::kFileDisplayName)).hasMatch();
+        }
+
+        return nameRegex.match(fileName).hasMatch();
+    }
+
+private:
+    QByteArray rootPath;
+    QRegularExpression regex;
+    QRegularExpression filterRegex;
+    bool filterSystemDirs { true };
+    const QAtomicInt &status;
+    Deliver deliver;
+
+    int workerCount { 0 };
+    std::vector<WorkQueue> queues;
+    QAtomicInt pending { 0 };
+    std::atomic_int queued { 0 };
+    std::atomic_int idleCount { 0 };
+    QMutex idleMutex;
+    QWaitCondition idleCondition;
+    std::array<VisitedShard, kVisitedShardCount> visited;
+    QThreadPool pool;
+};
+
+}
+
 IteratorSearcher::IteratorSearcher(const QUrl &url, const QString &key, QObject *parent)
     : AbstractSearcher(url, SearchHelper::instance()->checkWildcardAndToRegularExpression(key), parent)
 {
     searchPathList << url;
+    visitedPaths << url;
     regex = QRegularExpression(keyword, QRegularExpression::CaseInsensitiveOption);
 }
 
@@ -31,7 +275,10 @@ bool IteratorSearcher::search()
 
     notifyTimer.start();
     // 遍历搜索
-    doSearch();
+    if (searchUrl.isLocalFile())
+        doLocalSearch();
+    else
+        doSearch();
 
     //检查是否还有数据
     if (status.testAndSetRelease(kRuning, kCompleted)) {
@@ -70,6 +317,24 @@ void IteratorSearcher::tryNotify()
     }
 }
 
+void IteratorSearcher::appendResults(const QList<QUrl> &results)
+{
+    QMutexLocker lk(&mutex);
+    allResults << results;
+}
+
+void IteratorSearcher::doLocalSearch()
+{
+    ParallelWalker walker(searchUrl.toLocalFile(), regex, status,
+                          [this](const QList<QUrl> &results) { appendResults(results); });
+    walker.start();
+
+    // 工作线程只收集结果, 由当前线程按间隔推送
+    while (!walker.waitForDone(kEmitInterval))
+        tryNotify();
+    tryNotify();
+}
+
 void IteratorSearcher::doSearch()
 {
     forever {
@@ -103,8 +368,10 @@ void IteratorSearcher::doSearch()
             // 将目录添加到待搜索目录中
             if (info->isAttributes(OptInfoType::kIsDir) && !info->isAttributes(OptInfoType::kIsSymLink)) {
                 const auto &fileUrl = info->urlOf(UrlInfoType::kUrl);
-                if (!searchPathList.contains(fileUrl) || !fileUrl.path().startsWith("/sys/"))
+                if (!visitedPaths.contains(fileUrl)) {
+                    visitedPaths.insert(fileUrl);
                     searchPathList << fileUrl;
+                }
             }
 
             QRegularExpressionMatch match = regex.match(info->displayOf(DisPlayInfoType::kFileDisplayName));
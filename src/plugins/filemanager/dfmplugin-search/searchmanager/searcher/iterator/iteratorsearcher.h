@@ -9,6 +9,7 @@
 
 #include <QTime>
 #include <QMutex>
+#include <QSet>
 #include <QRegularExpression>
 
 DPSEARCH_BEGIN_NAMESPACE
@@ -28,12 +29,15 @@ private:
     QList<QUrl> takeAll() override;
     void tryNotify();
     void doSearch();
+    void doLocalSearch();
+    void appendResults(const QList<QUrl> &results);
 
 private:
     QAtomicInt status = kReady;
     QList<QUrl> allResults;
     mutable QMutex mutex;
     QList<QUrl> searchPathList;
+    QSet<QUrl> visitedPaths;
     QRegularExpression regex;
 
     //计时
@@ -53,6 +53,12 @@ void SearchManager::stop(quint64 winId)
         stop(taskIdMap[winId]);
 }
 
+void SearchManager::updateFullTextIndex(const QList<QUrl> &urls)
+{
+    if (mainController)
+        mainController->updateIndex(urls);
+}
+
 void SearchManager::onIndexFullTextConfigChanged(bool enabled)
 {
     using namespace dfmplugin_utils;
@@ -26,6 +26,7 @@ public:
     QList<QUrl> matchedResults(const QString &taskId);
     void stop(const QString &taskId);
     void stop(quint64 winId);
+    void updateFullTextIndex(const QList<QUrl> &urls);
 
 public Q_SLOTS:
     void onIndexFullTextConfigChanged(bool enabled);
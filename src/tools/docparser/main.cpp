@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// The document parser of the full-text index. It runs as a long-lived helper process,
+// so a parse that hangs or crashes is ended by killing the helper, not the file manager.
+// A request is the 32-bit length of a file path and the path, the reply is the 32-bit
+// length of the contents and the contents, both on the standard streams.
+
+#include <docparser.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+
+#include <unistd.h>
+
+static bool readAll(int fd, void *data, size_t size)
+{
+    char *buf = static_cast<char *>(data);
+    while (size > 0) {
+        const ssize_t ret = ::read(fd, buf, size);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        buf += ret;
+        size -= static_cast<size_t>(ret);
+    }
+    return true;
+}
+
+static bool writeAll(int fd, const void *data, size_t size)
+{
+    const char *buf = static_cast<const char *>(data);
+    while (size > 0) {
+        const ssize_t ret = ::write(fd, buf, size);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        buf += ret;
+        size -= static_cast<size_t>(ret);
+    }
+    return true;
+}
+
+int main()
+{
+    // the parser libraries may print to stdout, keep it for the replies only
+    const int out = ::dup(STDOUT_FILENO);
+    if (out < 0 || ::dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+        return 1;
+
+    std::string path;
+    uint32_t size = 0;
+    while (readAll(STDIN_FILENO, &size, sizeof(size))) {
+        path.resize(size);
+        if (!readAll(STDIN_FILENO, &path[0], size))
+            break;
+
+        std::string contents;
+        try {
+            contents = DocParser::convertFile(path);
+        } catch (...) {
+            contents.clear();
+        }
+
+        const uint32_t length = static_cast<uint32_t>(contents.size());
+        if (!writeAll(out, &length, sizeof(length)) || !writeAll(out, contents.data(), length))
+            break;
+    }
+
+    return 0;
+}
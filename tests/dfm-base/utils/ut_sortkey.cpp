@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_SORTKEY
+#define UT_SORTKEY
+#include "dfm-base/utils/sortkey.h"
+#include "dfm-base/utils/fileutils.h"
+
+#include <QStringList>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_SortKey : public testing::Test
+{
+public:
+    virtual void SetUp() override
+    {
+        names << "file10.txt"
+              << "file2.txt"
+              << "File1.txt"
+              << "中文文件"
+              << "文档2"
+              << "文档10"
+              << "_hidden"
+              << ".config"
+              << "123"
+              << "abc"
+              << "ABC"
+              << "";
+    }
+
+    virtual void TearDown() override
+    {
+    }
+
+    QStringList names;
+};
+
+TEST_F(UT_SortKey, testRank)
+{
+    EXPECT_EQ(SortKey::rank(""), SortKey::rank("abc"));
+    EXPECT_EQ(SortKey::rank("abc"), SortKey::rank("123"));
+    EXPECT_LT(SortKey::rank("abc"), SortKey::rank("中文"));
+    EXPECT_LT(SortKey::rank("中文"), SortKey::rank("_abc"));
+}
+
+TEST_F(UT_SortKey, testSameOrderAsCompareString)
+{
+    for (const auto &left : names) {
+        for (const auto &right : names) {
+            SortKey leftKey(left);
+            SortKey rightKey(right);
+            EXPECT_EQ(FileUtils::compareString(left, right, Qt::AscendingOrder),
+                      leftKey.lessThan(rightKey, Qt::AscendingOrder));
+            EXPECT_EQ(FileUtils::compareString(left, right, Qt::DescendingOrder),
+                      leftKey.lessThan(rightKey, Qt::DescendingOrder));
+        }
+    }
+}
+
+TEST_F(UT_SortKey, testNumericMode)
+{
+    EXPECT_TRUE(SortKey("file2.txt").lessThan(SortKey("file10.txt"), Qt::AscendingOrder));
+    EXPECT_TRUE(SortKey("abc").lessThan(SortKey("_abc"), Qt::AscendingOrder));
+    EXPECT_FALSE(SortKey().isValid());
+    EXPECT_TRUE(SortKey("abc").isValid());
+}
+
+#endif
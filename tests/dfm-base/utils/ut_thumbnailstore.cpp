@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/thumbnailstore.h"
+
+#include <QCryptographicHash>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_ThumbnailStore : public testing::Test
+{
+public:
+    virtual void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        storeDir = dir.filePath("store");
+        image = QImage(16, 16, QImage::Format_ARGB32);
+        image.fill(Qt::red);
+        md5 = QCryptographicHash::hash("file:///tmp/a.png", QCryptographicHash::Md5);
+    }
+
+    virtual void TearDown() override
+    {
+    }
+
+    QTemporaryDir dir;
+    QString storeDir;
+    QImage image;
+    QByteArray md5;
+};
+
+TEST_F(UT_ThumbnailStore, test_index_only)
+{
+    const QString &thumbnail = dir.filePath("a.png");
+    image.save(thumbnail, "png");
+    {
+        ThumbnailStore store(storeDir);
+        store.insert("/tmp", md5, ThumbnailProvider::kLarge, 100, image);
+    }
+
+    ThumbnailStore store(storeDir);
+    QImage result;
+    EXPECT_EQ(store.find("/tmp", md5, ThumbnailProvider::kLarge, 100, thumbnail, &result), ThumbnailStore::kFresh);
+    EXPECT_EQ(result.size(), image.size());
+    EXPECT_EQ(store.find("/tmp", md5, ThumbnailProvider::kNormal, 100, thumbnail, &result), ThumbnailStore::kUnknown);
+
+    // the PNG is removed by others
+    store.images.clear();
+    QFile::remove(thumbnail);
+    EXPECT_EQ(store.find("/tmp", md5, ThumbnailProvider::kLarge, 100, thumbnail, &result), ThumbnailStore::kUnknown);
+    EXPECT_TRUE(store.dirIndex("/tmp")->records.isEmpty());
+}
+
+TEST_F(UT_ThumbnailStore, test_changed)
+{
+    const QString &thumbnail = dir.filePath("a.png");
+    image.save(thumbnail, "png");
+
+    ThumbnailStore store(storeDir);
+    store.insert("/tmp", md5, ThumbnailProvider::kLarge, 100, image);
+
+    // the caller checks the PNG, the store never removes it
+    QImage result;
+    EXPECT_EQ(store.find("/tmp", md5, ThumbnailProvider::kLarge, 200, thumbnail, &result), ThumbnailStore::kUnknown);
+    EXPECT_TRUE(QFile::exists(thumbnail));
+    EXPECT_FALSE(store.dirIndex("/tmp")->records.contains(ThumbnailStore::recordKey(md5, ThumbnailProvider::kLarge)));
+}
+
+TEST_F(UT_ThumbnailStore, test_shared)
+{
+    const QString &thumbnail = dir.filePath("a.png");
+    image.save(thumbnail, "png");
+    const QByteArray &other = QCryptographicHash::hash("file:///tmp/b.png", QCryptographicHash::Md5);
+
+    // two processes share the index of a dir
+    ThumbnailStore first(storeDir);
+    ThumbnailStore second(storeDir);
+    first.insert("/tmp", md5, ThumbnailProvider::kLarge, 100, QImage());
+    second.insert("/tmp", other, ThumbnailProvider::kLarge, 100, QImage());
+
+    // the rewrite keeps the records appended by the other
+    ThumbnailStore::DirIndex *index = first.dirIndex("/tmp");
+    ASSERT_TRUE(first.rewriteIndex(index));
+    EXPECT_EQ(index->records.size(), 2);
+
+    ThumbnailStore third(storeDir);
+    QImage result;
+    EXPECT_EQ(third.find("/tmp", md5, ThumbnailProvider::kLarge, 100, thumbnail, &result), ThumbnailStore::kFresh);
+    EXPECT_EQ(third.find("/tmp", other, ThumbnailProvider::kLarge, 100, thumbnail, &result), ThumbnailStore::kFresh);
+}
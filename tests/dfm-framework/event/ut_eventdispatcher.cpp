@@ -58,6 +58,7 @@ TEST_F(UT_EventDispatcher, test_unsub)
     EXPECT_EQ(v, 2);
 
     EXPECT_TRUE(dpfSignalDispatcher->unsubscribe(eType1, &b, &TestQObject::add1));
+    EXPECT_FALSE(dpfSignalDispatcher->unsubscribe(eType1, &b, &TestQObject::add1));
     EXPECT_TRUE(dpfSignalDispatcher->publish(eType1, &v));
     EXPECT_EQ(v, 2);
 
@@ -67,3 +68,53 @@ TEST_F(UT_EventDispatcher, test_unsub)
 
     EXPECT_TRUE(dpfSignalDispatcher->unsubscribe(eType1));
 }
+
+TEST_F(UT_EventDispatcher, test_typed_filter)
+{
+    TestQObject b;
+    EventType eType1 = 3;
+    int called = 0;
+    EXPECT_TRUE(dpfSignalDispatcher->subscribe(eType1, &b, &TestQObject::bigger10));
+    EXPECT_TRUE(dpfSignalDispatcher->installEventFilter(eType1, &b, &TestQObject::bigger15));
+
+    // the arguments match the parameters, the handlers take them without QVariant
+    EXPECT_FALSE(dpfSignalDispatcher->publish(eType1, 20, &called));
+    EXPECT_EQ(called, 15);
+    EXPECT_TRUE(dpfSignalDispatcher->publish(eType1, 12, &called));
+    EXPECT_EQ(called, 10);
+
+    // the arguments differ from the parameters, they are converted through QVariant
+    called = 0;
+    EXPECT_FALSE(dpfSignalDispatcher->publish(eType1, qint64(20), &called));
+    EXPECT_EQ(called, 15);
+    EXPECT_TRUE(dpfSignalDispatcher->publish(eType1, qint64(12), &called));
+    EXPECT_EQ(called, 10);
+
+    EXPECT_TRUE(dpfSignalDispatcher->removeEventFilter(eType1, &b, &TestQObject::bigger15));
+    EXPECT_FALSE(dpfSignalDispatcher->removeEventFilter(eType1, &b, &TestQObject::bigger15));
+    EXPECT_TRUE(dpfSignalDispatcher->publish(eType1, 20, &called));
+    EXPECT_TRUE(dpfSignalDispatcher->unsubscribe(eType1));
+    EXPECT_FALSE(dpfSignalDispatcher->unsubscribe(eType1));
+    EXPECT_FALSE(dpfSignalDispatcher->publish(eType1, 20, &called));
+}
+
+TEST_F(UT_EventDispatcher, test_typed_signal)
+{
+    TestQObject b;
+    int v = 0;
+    const TypedSignal<int *> signal("ut_eventdispatcher", "signal_Test_Typed");
+    EXPECT_FALSE(signal.publish(&v));
+
+    // registered after the signal is created
+    dpfEvent->registerEventType(EventStratege::kSignal, "ut_eventdispatcher", "signal_Test_Typed");
+    EventType eType1 = DPF_EVENT_TYPE("ut_eventdispatcher", "signal_Test_Typed");
+    EXPECT_NE(eType1, EventTypeScope::kInValid);
+    EXPECT_EQ(DPF_EVENT_TYPE("ut_eventdispatcher", "SIGNAL_Test_Typed"), EventTypeScope::kInValid);
+    EXPECT_EQ(DPF_EVENT_TYPE("ut_eventdispatcher", "slot_Test_Typed"), EventTypeScope::kInValid);
+
+    EXPECT_TRUE(dpfSignalDispatcher->subscribe(eType1, &b, &TestQObject::add1));
+    EXPECT_TRUE(signal.publish(&v));
+    EXPECT_EQ(signal.type(), eType1);
+    EXPECT_EQ(v, 1);
+    EXPECT_TRUE(dpfSignalDispatcher->unsubscribe(eType1));
+}
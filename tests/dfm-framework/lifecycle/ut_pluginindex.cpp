@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "dfm-framework/lifecycle/private/pluginindex.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+DPF_USE_NAMESPACE
+
+class UT_PluginIndex : public testing::Test
+{
+public:
+    virtual void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        pluginDir = dir.filePath("plugins");
+        indexFile = dir.filePath("cache/index.json");
+        QDir().mkpath(pluginDir);
+        writeFile("a.so", "a");
+        writeFile("b.so", "b");
+        writeFile("c.txt", "c");
+    }
+
+    virtual void TearDown() override
+    {
+    }
+
+    void writeFile(const QString &name, const QByteArray &content)
+    {
+        QFile file(pluginDir + "/" + name);
+        file.open(QIODevice::WriteOnly);
+        file.write(content);
+    }
+
+    QTemporaryDir dir;
+    QString pluginDir;
+    QString indexFile;
+};
+
+TEST_F(UT_PluginIndex, test_warm_index)
+{
+    {
+        PluginIndex index(indexFile);
+        EXPECT_EQ(index.entries(pluginDir).size(), 2);
+        EXPECT_EQ(index.readCount, 2);
+        EXPECT_TRUE(index.save());
+    }
+
+    // nothing changed, no file is read
+    PluginIndex index(indexFile);
+    const QList<PluginIndex::Entry> &entries = index.entries(pluginDir);
+    EXPECT_EQ(entries.size(), 2);
+    EXPECT_EQ(index.readCount, 0);
+    EXPECT_FALSE(index.changed);
+    for (const PluginIndex::Entry &entry : entries)
+        EXPECT_TRUE(entry.metaData.isEmpty());
+}
+
+TEST_F(UT_PluginIndex, test_changed_files)
+{
+    {
+        PluginIndex index(indexFile);
+        index.entries(pluginDir);
+        index.save();
+    }
+
+    // a file is rewritten in place, the dir is unchanged
+    writeFile("a.so", "changed");
+    {
+        PluginIndex index(indexFile);
+        EXPECT_EQ(index.entries(pluginDir).size(), 2);
+        EXPECT_EQ(index.readCount, 1);
+        index.save();
+    }
+
+    // a file is added and the dir is scanned again
+    writeFile("d.so", "d");
+    QFile::remove(pluginDir + "/b.so");
+    PluginIndex index(indexFile);
+    index.dirs[pluginDir].modified = 0;
+    const QList<PluginIndex::Entry> &entries = index.entries(pluginDir);
+    EXPECT_EQ(entries.size(), 2);
+    EXPECT_EQ(index.readCount, 1);
+
+    QStringList names;
+    for (const PluginIndex::Entry &entry : entries)
+        names.append(QFileInfo(entry.fileName).fileName());
+    names.sort();
+    EXPECT_EQ(names, QStringList({ "a.so", "d.so" }));
+}
+
+TEST_F(UT_PluginIndex, test_replaced_file)
+{
+    const QString &fileName = pluginDir + "/a.so";
+    const QDateTime &modified = QFileInfo(fileName).lastModified();
+    {
+        PluginIndex index(indexFile);
+        index.entries(pluginDir);
+        index.save();
+    }
+
+    // replaced by a file of the same size and mtime, only its inode and ctime differ
+    writeFile("a.tmp", "x");
+    QFile tmp(pluginDir + "/a.tmp");
+    ASSERT_TRUE(tmp.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(tmp.setFileTime(modified, QFileDevice::FileModificationTime));
+    tmp.close();
+    ASSERT_TRUE(QFile::remove(fileName));
+    ASSERT_TRUE(QFile::rename(pluginDir + "/a.tmp", fileName));
+
+    PluginIndex index(indexFile);
+    EXPECT_EQ(index.entries(pluginDir).size(), 2);
+    EXPECT_EQ(index.readCount, 1);
+}
+
+TEST_F(UT_PluginIndex, test_missing_dir)
+{
+    PluginIndex index(indexFile);
+    EXPECT_TRUE(index.entries(dir.filePath("none")).isEmpty());
+}
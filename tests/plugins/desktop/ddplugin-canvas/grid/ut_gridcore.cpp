@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "grid/gridcore.h"
+
+#include <gtest/gtest.h>
+
+using namespace ddplugin_canvas;
+
+namespace {
+class TestGridCore : public GridCore
+{
+public:
+    TestGridCore() : GridCore() {}
+};
+}
+
+class UT_GridCore : public testing::Test
+{
+public:
+    virtual void SetUp() override
+    {
+        baseCount = GridItemTable::instance()->count();
+        core.resizeSurface(1, QSize(2, 3));
+        core.resizeSurface(2, QSize(2, 2));
+    }
+
+    virtual void TearDown() override
+    {
+    }
+
+    TestGridCore core;
+    int baseCount = 0;
+};
+
+TEST_F(UT_GridCore, insert)
+{
+    core.insert(1, QPoint(1, 2), "file:///a");
+    EXPECT_EQ(core.item(GridPos(1, QPoint(1, 2))), QString("file:///a"));
+    EXPECT_EQ(core.itemCount(1), 1);
+
+    GridPos pos;
+    ASSERT_TRUE(core.position("file:///a", pos));
+    EXPECT_EQ(pos, GridPos(1, QPoint(1, 2)));
+
+    // the grids are ordered by column
+    core.insert(1, QPoint(0, 1), "file:///b");
+    EXPECT_EQ(core.items(1), QStringList({ "file:///b", "file:///a" }));
+
+    // an invalid pos is overloaded
+    core.insert(1, QPoint(2, 0), "file:///c");
+    EXPECT_TRUE(core.overload.contains("file:///c"));
+    EXPECT_EQ(core.itemCount(1), 2);
+}
+
+TEST_F(UT_GridCore, move)
+{
+    core.insert(1, QPoint(0, 0), "file:///a");
+
+    // an item is only on one grid
+    core.insert(2, QPoint(1, 1), "file:///a");
+    EXPECT_TRUE(core.item(GridPos(1, QPoint(0, 0))).isEmpty());
+    EXPECT_EQ(core.itemCount(1), 0);
+    EXPECT_EQ(core.item(GridPos(2, QPoint(1, 1))), QString("file:///a"));
+
+    core.insert(2, QPoint(0, 0), "file:///b");
+    MoveGridOper oper(&core);
+    EXPECT_TRUE(oper.move(GridPos(2, QPoint(0, 1)), GridPos(2, QPoint(0, 0)), { "file:///b" }));
+    core.applay(&oper);
+    EXPECT_EQ(core.item(GridPos(2, QPoint(0, 1))), QString("file:///b"));
+    EXPECT_TRUE(core.item(GridPos(2, QPoint(0, 0))).isEmpty());
+}
+
+TEST_F(UT_GridCore, remove)
+{
+    core.insert(1, QPoint(0, 0), "file:///a");
+    core.insert(1, QPoint(0, 1), "file:///b");
+    EXPECT_EQ(GridItemTable::instance()->count(), baseCount + 2);
+
+    // not on this surface
+    core.remove(2, "file:///a");
+    EXPECT_EQ(core.itemCount(1), 2);
+
+    core.remove(1, "file:///a");
+    core.remove(1, QPoint(0, 1));
+    EXPECT_EQ(core.itemCount(1), 0);
+    EXPECT_TRUE(core.itemGrid.isEmpty());
+    EXPECT_TRUE(core.voidPos(1).contains(QPoint(0, 0)));
+
+    // the ids are freed and reused
+    EXPECT_EQ(GridItemTable::instance()->count(), baseCount);
+    EXPECT_EQ(GridItemTable::instance()->id("file:///a"), 0);
+    core.insert(1, QPoint(0, 0), "file:///c");
+    EXPECT_EQ(GridItemTable::instance()->count(), baseCount + 1);
+}
+
+TEST_F(UT_GridCore, overlap)
+{
+    core.insert(1, QPoint(0, 0), "file:///a");
+
+    // the item on the pos is replaced
+    core.insert(1, QPoint(0, 0), "file:///b");
+    EXPECT_EQ(core.item(GridPos(1, QPoint(0, 0))), QString("file:///b"));
+    EXPECT_EQ(core.itemCount(1), 1);
+    GridPos pos;
+    EXPECT_FALSE(core.position("file:///a", pos));
+
+    // the items outside the smaller surface are overloaded
+    core.insert(1, QPoint(1, 2), "file:///c");
+    core.resizeSurface(1, QSize(1, 1));
+    EXPECT_EQ(core.itemCount(1), 1);
+    EXPECT_TRUE(core.overload.contains("file:///c"));
+    EXPECT_FALSE(core.position("file:///c", pos));
+}
+
+TEST_F(UT_GridCore, copy)
+{
+    core.insert(1, QPoint(0, 0), "file:///a");
+    {
+        // a copy holds the ids on its grids
+        AppendOper oper(&core);
+        core.clearItems();
+        EXPECT_EQ(oper.item(GridPos(1, QPoint(0, 0))), QString("file:///a"));
+        EXPECT_EQ(GridItemTable::instance()->count(), baseCount + 1);
+    }
+
+    EXPECT_EQ(GridItemTable::instance()->count(), baseCount);
+}
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mode/custom/customdatahandler.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace ddplugin_organizer;
+
+namespace {
+
+QUrl fileUrl(int i)
+{
+    return QUrl::fromLocalFile(QString("/home/test/Desktop/file_%0").arg(i));
+}
+
+CollectionBaseDataPtr createBase(const QString &key, int from, int count)
+{
+    CollectionBaseDataPtr base(new CollectionBaseData);
+    base->key = key;
+    base->name = key;
+    for (int i = from; i < from + count; ++i)
+        base->items.append(fileUrl(i));
+    return base;
+}
+
+// the key found by scanning the items, as it was done before the index
+QString scanKey(const CustomDataHandler &handler, const QUrl &url)
+{
+    for (const CollectionBaseDataPtr &base : handler.baseDatas()) {
+        if (base->items.contains(url))
+            return base->key;
+    }
+    return QString();
+}
+
+}   // namespace
+
+TEST(CustomDataHandler, index_reset)
+{
+    CustomDataHandler handler;
+    handler.reset({ createBase("a", 0, 10), createBase("b", 10, 10) });
+
+    EXPECT_EQ(handler.key(fileUrl(3)), QString("a"));
+    EXPECT_EQ(handler.key(fileUrl(13)), QString("b"));
+    EXPECT_TRUE(handler.key(fileUrl(30)).isEmpty());
+    EXPECT_TRUE(handler.contains("b", fileUrl(19)));
+    EXPECT_FALSE(handler.contains("a", fileUrl(19)));
+    EXPECT_TRUE(handler.acceptInsert(fileUrl(0)));
+    EXPECT_EQ(handler.acceptReset({ fileUrl(1), fileUrl(40) }), QList<QUrl> { fileUrl(1) });
+
+    handler.removeBaseData("a");
+    EXPECT_TRUE(handler.key(fileUrl(3)).isEmpty());
+    EXPECT_EQ(handler.key(fileUrl(13)), QString("b"));
+}
+
+TEST(CustomDataHandler, index_mutators)
+{
+    CustomDataHandler handler;
+    handler.reset({ createBase("a", 0, 5), createBase("b", 5, 5) });
+
+    EXPECT_EQ(handler.replace(fileUrl(2), fileUrl(100)), QString("a"));
+    EXPECT_EQ(handler.items("a").at(2), fileUrl(100));
+    EXPECT_TRUE(handler.key(fileUrl(2)).isEmpty());
+    EXPECT_TRUE(handler.replace(fileUrl(100), fileUrl(6)).isEmpty());
+
+    handler.insert(fileUrl(101), "b", 0);
+    EXPECT_EQ(handler.items("b").first(), fileUrl(101));
+    EXPECT_EQ(handler.key(fileUrl(101)), QString("b"));
+
+    EXPECT_EQ(handler.remove(fileUrl(5)), QString("b"));
+    EXPECT_FALSE(handler.items("b").contains(fileUrl(5)));
+    EXPECT_TRUE(handler.remove(fileUrl(5)).isEmpty());
+
+    handler.moveUrls({ fileUrl(0), fileUrl(1) }, "b", 1);
+    EXPECT_EQ(handler.key(fileUrl(0)), QString("b"));
+    EXPECT_EQ(handler.items("b").mid(1, 2), QList<QUrl>({ fileUrl(0), fileUrl(1) }));
+
+    handler.moveUrls({ fileUrl(9) }, "b", 0);
+    EXPECT_EQ(handler.items("b").first(), fileUrl(9));
+
+    handler.check({ fileUrl(9), fileUrl(3) });
+    EXPECT_EQ(handler.key(fileUrl(3)), QString("a"));
+    EXPECT_TRUE(handler.key(fileUrl(0)).isEmpty());
+    EXPECT_EQ(handler.items("b"), QList<QUrl> { fileUrl(9) });
+}
+
+TEST(CustomDataHandler, index_replay)
+{
+    const int fileCount = 500;
+    CustomDataHandler handler;
+    handler.reset({ createBase("a", 0, fileCount / 2), createBase("b", fileCount / 2, fileCount / 2) });
+
+    // replay create, rename, move and delete, the index must agree with the items
+    int next = fileCount;
+    quint32 seed = 1;
+    auto random = [&seed](int bound) {
+        seed = seed * 1103515245 + 12345;
+        return static_cast<int>((seed >> 16) % static_cast<quint32>(bound));
+    };
+
+    for (int i = 0; i < 2000; ++i) {
+        const QString key = random(2) ? "a" : "b";
+        const QList<QUrl> &items = handler.items(key);
+        switch (random(4)) {
+        case 0:
+            handler.insert(fileUrl(next++), key, random(items.size() + 1));
+            break;
+        case 1:
+            if (!items.isEmpty())
+                handler.replace(items.at(random(items.size())), fileUrl(next++));
+            break;
+        case 2:
+            if (!items.isEmpty())
+                handler.moveUrls({ items.at(random(items.size())) }, random(2) ? "a" : "b", random(items.size()));
+            break;
+        default:
+            if (!items.isEmpty())
+                handler.remove(items.at(random(items.size())));
+            break;
+        }
+    }
+
+    for (int i = 0; i < next; ++i)
+        ASSERT_EQ(handler.key(fileUrl(i)), scanKey(handler, fileUrl(i))) << i;
+}
+
+TEST(CustomDataHandler, pre_items)
+{
+    CustomDataHandler handler;
+    handler.addPreItems("a", { fileUrl(0), fileUrl(1) }, 3);
+    handler.addPreItems("b", { fileUrl(1) }, 0);
+
+    QString key;
+    int index = -1;
+    EXPECT_TRUE(handler.checkPreItem(fileUrl(1), key, index));
+    EXPECT_EQ(key, QString("b"));
+    EXPECT_EQ(index, 0);
+
+    EXPECT_TRUE(handler.takePreItem(fileUrl(0), key, index));
+    EXPECT_EQ(key, QString("a"));
+    EXPECT_EQ(index, 3);
+    EXPECT_FALSE(handler.checkPreItem(fileUrl(0), key, index));
+
+    EXPECT_TRUE(handler.takePreItem(fileUrl(1), key, index));
+    EXPECT_FALSE(handler.takePreItem(fileUrl(1), key, index));
+}
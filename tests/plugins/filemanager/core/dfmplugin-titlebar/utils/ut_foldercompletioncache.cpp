@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "utils/foldercompletioncache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+DPTITLEBAR_USE_NAMESPACE
+
+TEST(FolderCompletionCacheTest, ut_readDirNames)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QDir(dir.path()).mkpath("abc");
+    QDir(dir.path()).mkpath(".hidden");
+    QFile file(dir.filePath("file"));
+    file.open(QIODevice::WriteOnly);
+    QFile::link(dir.filePath("abc"), dir.filePath("link"));
+
+    QStringList names;
+    std::atomic_bool stop { false };
+    EXPECT_TRUE(FolderCompletionCache::readDirNames(dir.path(), [&](const QString &name) { names.append(name); }, stop));
+    names.sort();
+    EXPECT_EQ(names, QStringList({ ".hidden", "abc", "link" }));
+
+    EXPECT_FALSE(FolderCompletionCache::readDirNames(dir.filePath("none"), [](const QString &) {}, stop));
+}
+
+TEST(FolderCompletionCacheTest, ut_prefixRange)
+{
+    const QStringList names { "Abc", "ab", "abc", "abd", "b" };
+    EXPECT_EQ(FolderCompletionCache::prefixRange(names, "ab"), qMakePair(1, 4));
+    EXPECT_EQ(FolderCompletionCache::prefixRange(names, "abc"), qMakePair(2, 3));
+    EXPECT_EQ(FolderCompletionCache::prefixRange(names, ""), qMakePair(0, 5));
+    EXPECT_EQ(FolderCompletionCache::prefixRange(names, "c"), qMakePair(5, 5));
+}
+
+TEST(FolderCompletionCacheTest, ut_stamp)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    FolderCompletionCache::DirStamp stamp;
+    ASSERT_TRUE(FolderCompletionCache::dirStamp(dir.path(), &stamp));
+    FolderCompletionCache::instance()->insert(dir.path(), stamp, { "a" });
+
+    QStringList names;
+    EXPECT_TRUE(FolderCompletionCache::instance()->find(dir.path(), stamp, &names));
+    EXPECT_EQ(names, QStringList({ "a" }));
+
+    // the dir is changed
+    FolderCompletionCache::DirStamp newStamp = stamp;
+    ++newStamp.mtimeNsec;
+    EXPECT_FALSE(FolderCompletionCache::instance()->find(dir.path(), newStamp, &names));
+    EXPECT_FALSE(FolderCompletionCache::instance()->find(dir.path(), stamp, &names));
+}